@@ -0,0 +1,268 @@
+import os
+import re
+import subprocess
+import sys
+import time
+
+from tester import Tester
+
+
+class Bench:
+
+    def __init__(self, dir, sizes):
+        self.sizes = sizes
+        self.src_dir = os.path.abspath(os.path.join(dir, 'src'))
+        self.tmp_dir = os.path.abspath(os.path.join(dir, 'tmp'))
+        self.test_dir = os.path.abspath(os.path.join(dir, 'test'))
+        self.tm_src = os.path.abspath(os.path.join(dir, '..', 'materials', 'tm', 'tm.c'))
+
+        if not os.path.exists(self.tmp_dir):
+            os.mkdir(self.tmp_dir)
+
+    def run_all(self, names, memory=False, scan=False, optimize=False, symtable=False):
+        if symtable:
+            return self.symtable()
+
+        compiler = os.path.join(self.src_dir, 'c-')
+        if not os.path.exists(compiler):
+            Tester.execute(self.src_dir, 'make')
+
+        if not os.path.exists(compiler):
+            raise Exception('Compilation failed')
+
+        if optimize:
+            return self.optimize(compiler)
+
+        passed = True
+        for name in names:
+            if name not in GENERATORS:
+                raise Exception(f'Unknown benchmark \'{name}\'')
+            if memory:
+                self.footprint(name, compiler)
+            elif scan:
+                self.scan(name, compiler)
+            else:
+                passed = self.run(name, compiler) and passed
+        return passed
+
+    def run(self, name, compiler):
+        Tester.bold_msg(f'Benchmark {name}')
+        per_unit = []
+        for size in self.sizes_for(name):
+            src = os.path.join(self.tmp_dir, f'bench_{name}_{size}.c-')
+            with open(src, 'w') as file:
+                file.write(GENERATORS[name](size))
+
+            elapsed = self.time_compile(compiler, src)
+            per_unit.append(elapsed / size)
+            print(f'  {size:>8} units  {elapsed:8.3f}s  {1e6 * elapsed / size:8.2f}us/unit')
+            os.remove(src)
+
+        # Linear passes keep the per-unit cost flat as the input grows
+        growth = per_unit[-1] / per_unit[0]
+        if growth < LINEAR_TOLERANCE:
+            Tester.success_msg(f'  Linear ({growth:.2f}x per-unit cost from smallest to largest)')
+            return True
+        Tester.error_msg(f'  Superlinear ({growth:.2f}x per-unit cost from smallest to largest)')
+        return False
+
+    def footprint(self, name, compiler):
+        Tester.bold_msg(f'Footprint {name}')
+        for size in self.sizes_for(name):
+            src = os.path.join(self.tmp_dir, f'bench_{name}_{size}.c-')
+            with open(src, 'w') as file:
+                file.write(GENERATORS[name](size))
+
+            # -A reports the arena holding the tree, its types and the tokens, and the pool holding each node's columns
+            # -I keeps the whole tree, streaming would release each function's body once it is compiled
+            stats = subprocess.run([compiler, '-I', '-A', src], cwd=self.tmp_dir, stdout=subprocess.PIPE, text=True).stdout
+            arena = int(re.search(r'Arena allocations: .*\((\d+) bytes\)', stats).group(1))
+            nodes = int(re.search(r'Tree nodes: (\d+)', stats).group(1))
+            pool = int(re.search(r'\((\d+) bytes in the pool\)', stats).group(1))
+            tree = arena + pool
+            source = os.path.getsize(src)
+            print(f'  {size:>8} units  {nodes:>8} nodes  {tree / 2**20:8.1f}MiB  {pool / nodes:6.1f}B/node pooled  {tree / nodes:6.1f}B/node  {tree / source:6.1f}x source')
+            os.remove(src)
+
+    def scan(self, name, compiler):
+        Tester.bold_msg(f'Scanner {name}')
+        for size in self.sizes_for(name):
+            src = os.path.join(self.tmp_dir, f'bench_{name}_{size}.c-')
+            with open(src, 'w') as file:
+                file.write(GENERATORS[name](size))
+
+            # -T scans without parsing and reports the scanner's own throughput
+            speeds = []
+            for flags in (['-T'], ['-T', '-s']):
+                stats = subprocess.run([compiler] + flags + [src], cwd=self.tmp_dir, stdout=subprocess.PIPE, text=True).stdout
+                speeds.append(float(re.search(r'([\d.]+) MB/s', stats).group(1)))
+            source = os.path.getsize(src)
+            print(f'  {size:>8} units  {source / 2**20:8.1f}MiB  flex {speeds[0]:8.1f}MB/s  hand-written {speeds[1]:8.1f}MB/s  {speeds[1] / speeds[0]:5.2f}x')
+            os.remove(src)
+
+    def optimize(self, compiler):
+        Tester.bold_msg('Optimizer')
+        tm = os.path.join(self.tmp_dir, 'tm')
+        if not os.path.exists(tm):
+            subprocess.run(['gcc', '-O2', '-o', tm, self.tm_src, '-lm'], check=True)
+
+        passed = True
+        total = [0, 0, 0, 0]
+        for test_dir in sorted(os.listdir(self.test_dir)):
+            test_dir = os.path.join(self.test_dir, test_dir)
+            for src in sorted(os.listdir(test_dir)):
+                if not src.endswith('.c-'):
+                    continue
+                name = src[:-3]
+                inputs = os.path.join(test_dir, name + '.in')
+                if not os.path.exists(inputs):
+                    inputs = os.path.join(test_dir, 'runExamples.in')
+
+                # The same program with and without -O must print the same, only the count of instructions may drop
+                runs = []
+                for flags in ([], ['-O', '-R']):
+                    stats = subprocess.run([compiler] + flags + [os.path.join(test_dir, src)], cwd=self.tmp_dir, stdout=subprocess.PIPE, text=True, errors='replace').stdout
+                    program = os.path.join(self.tmp_dir, name + '.tm')
+                    if not os.path.exists(program):
+                        break
+                    runs.append((stats, self.run_tm(tm, program, inputs)))
+                    os.remove(program)
+                if len(runs) != 2:
+                    continue
+
+                (_, (before, output)), (stats, (after, optimized_output)) = runs
+                folded, propagated = (int(count) for count in re.search(r'Folded (\d+) expressions, propagated (\d+) constants', stats).groups())
+                # A run cut off by TM's limit reads the rest of its input as commands, only what it printed before has to match
+                cut = [i for i, line in enumerate(output) if 'Abort limit reached' in line]
+                limited = len(cut) > 0
+                if limited:
+                    output = output[:cut[0]]
+                    optimized_output = optimized_output[:cut[0]]
+                if output != optimized_output:
+                    Tester.error_msg(f'  {name:<16} output differs with -O')
+                    passed = False
+                    continue
+                if limited:
+                    Tester.warn_msg(f'  {name:<16} stopped at the instruction limit without -O, not counted')
+                    continue
+                total = [total[0] + folded, total[1] + propagated, total[2] + before, total[3] + after]
+                if folded or propagated or after != before:
+                    print(f'  {name:<16} {folded:>5} folded  {propagated:>5} propagated  {before:>10} -> {after:>10} instructions  {self.saving(before, after):6.2f}%')
+
+        print(f'  {"total":<16} {total[0]:>5} folded  {total[1]:>5} propagated  {total[2]:>10} -> {total[3]:>10} instructions  {self.saving(total[2], total[3]):6.2f}%')
+        return passed
+
+    def symtable(self):
+        # Built apart from the compiler, it times the symbol table against the std::map one it replaced
+        Tester.execute(self.src_dir, 'make symbench')
+        result = subprocess.run([os.path.join(self.src_dir, '..', 'bench', 'symbench')], stdout=subprocess.PIPE, text=True)
+        print(result.stdout, end='')
+        return result.returncode == 0
+
+    def run_tm(self, tm, program, inputs):
+        # e before the final x prints how many instructions ran
+        with open(inputs) as file:
+            commands = file.read().rstrip('\n').split('\n')
+        commands.insert(len(commands) - 1, 'e')
+        result = subprocess.run([tm, program], input='\n'.join(commands) + '\n', stdout=subprocess.PIPE, text=True, errors='replace', timeout=60).stdout
+        count = re.search(r'Number of instructions executed: (\d+)', result)
+        output = [line for line in result.split('\n') if not re.search(r'Loading file|EXEC STAT|Last executed|PC was', line)]
+        return (int(count.group(1)) if count else 0, output)
+
+    @staticmethod
+    def saving(before, after):
+        return 100 * (before - after) / before if before else 0
+
+    def sizes_for(self, name):
+        return self.sizes if self.sizes else SIZES.get(name, DEFAULT_SIZES)
+
+    def time_compile(self, compiler, src):
+        start = time.perf_counter()
+        result = subprocess.run([compiler, src], cwd=self.tmp_dir, stdout=subprocess.DEVNULL)
+        elapsed = time.perf_counter() - start
+        if result.returncode != 0:
+            raise Exception(f'Compiler exited with {result.returncode} on {src}')
+        return elapsed
+
+
+def gen_statements(size):
+    lines = ['main()', '{', '    int x;', '    x = 0;']
+    for i in range(size):
+        lines.append(f'    x = x + {i % 7};')
+    lines += ['    output(x);', '}']
+    return '\n'.join(lines) + '\n'
+
+
+def gen_functions(size):
+    lines = []
+    for i in range(size):
+        lines += [f'f{i}(int a)', '{', '    int x;', '    x = a;',
+                  '    while x > 0 do x = x - 1;', '    return x;', '}']
+    lines += ['main()', '{', '    output(f0(1));', '}']
+    return '\n'.join(lines) + '\n'
+
+
+def gen_expressions(size):
+    # Left-associative chains nest as deep as they are long
+    terms = size // 2
+    lines = ['main()', '{', '    int x: ' + ' + '.join(['1'] * terms) + ';',
+             '    x = ' + ' * '.join(['x'] * (size - terms)) + ';', '    output(x);', '}']
+    return '\n'.join(lines) + '\n'
+
+
+GENERATORS = {'statements': gen_statements, 'functions': gen_functions, 'expressions': gen_expressions}
+LINEAR_TOLERANCE = 2.0
+DEFAULT_SIZES = [12500, 25000, 50000, 100000]
+# Code generation still recurses once per level of an expression, deep ones are kept within the stack
+SIZES = {'expressions': [2500, 5000, 10000, 20000]}
+
+
+def help():
+    print('Usage: python3 bench.py hw_dir [benchmark ...] [--sizes n,n,...] [--memory | --scan | --optimize | --symtable]')
+
+    print('\nBenchmarks:')
+    print('statements    One function with n straight-line statements.')
+    print('functions     n small functions, each with a loop.')
+    print('expressions   Two expressions n operands long, so n deep.')
+
+    print('\nFor this project:')
+    print('$ python3 bench.py hw7/')
+    print('$ python3 bench.py hw7/ statements --sizes 25000,100000')
+    print('$ python3 bench.py hw7/ --memory    (memory footprint instead of time)')
+    print('$ python3 bench.py hw7/ --scan      (scanner throughput, flex against hand-written)')
+    print('$ python3 bench.py hw7/ --optimize  (instructions -O saves on the tests, run in TM)')
+    print('$ python3 bench.py hw7/ --symtable  (symbol table against the std::map one it replaced)')
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2 or sys.argv[1] == '--help':
+        help()
+        sys.exit()
+    if not os.path.isdir(sys.argv[1]):
+        raise Exception('Invalid directory provided')
+
+    args = sys.argv[2:]
+    sizes = None
+    if '--sizes' in args:
+        i = args.index('--sizes')
+        sizes = [int(size) for size in args[i + 1].split(',')]
+        del args[i:i + 2]
+
+    memory = '--memory' in args
+    if memory:
+        args.remove('--memory')
+    scan = '--scan' in args
+    if scan:
+        args.remove('--scan')
+
+    optimize = '--optimize' in args
+    if optimize:
+        args.remove('--optimize')
+
+    symtable = '--symtable' in args
+    if symtable:
+        args.remove('--symtable')
+
+    bench = Bench(sys.argv[1], sizes)
+    passed = bench.run_all(args if args else list(GENERATORS), memory, scan, optimize, symtable)
+    sys.exit(0 if passed else 1)
@@ -0,0 +1,302 @@
+// // // // // // // // // // // // // // // // // // // // 
+//
+// Introduction
+//
+// This symbol table library supplies basic insert and lookup for
+// symbols linked to void * pointers of data. The is expected to use
+// ONLY the MapSymTable class and NOT the Scope class. The Scope class
+// is used by MapSymTable in its implementation.
+//
+// Plenty of room for improvement inlcuding: better debugging setup,
+// passing of refs rather than values and purpose built char *
+// routines, and C support.
+//
+// WARNING: lookup will return NULL pointer if key is not in table.
+// This means the void * cannot have zero as a legal value! Attempting
+// to save a NULL pointer will get a error.
+//
+// This is the original stack of std::map scopes. SymTable replaced it
+// in the compiler and SymTableBench.cpp benchmarks the two against each
+// other.
+//
+// Robert Heckendorn   Apr 3, 2021
+//
+#include "MapSymTable.hpp"
+
+// // // // // // // // // // // // // // // // // // // //
+//
+// Class: Scope
+//
+// Helper class for MapSymTable
+//
+class MapSymTable::Scope
+{
+    public:
+        Scope(std::string newname);
+        ~Scope();
+        std::map<std::string, void *> getSyms() { return symbols; }  // Symbols getter
+        std::string scopeName();                                    // returns name of scope
+        void debug(bool state);                                     // sets the debug flag to state
+        void print(void (*printData)(void *));                      // prints the table using the supplied function to print the void *
+        void applyToAll(void (*action)(std::string, void *));       // applies func to all symbol/data pairs
+        bool insert(std::string sym, void *ptr);                    // inserts a new ptr associated with symbol sym, false if already defined
+        void *lookup(std::string sym);                              // returns the ptr associated with sym, NULL if symbol not found
+
+    private:
+        static bool debugFlg;                     // turn on tedious debugging
+        std::string name;                           // name of scope
+        std::map<std::string, void *> symbols;      // use an ordered map (not as fast as unordered)
+
+};
+
+MapSymTable::Scope::Scope(std::string newname)
+{
+    name = newname;
+    debugFlg = false;
+}
+
+MapSymTable::Scope::~Scope()
+{
+}
+
+// Returns char *name of scope
+std::string MapSymTable::Scope::scopeName()
+{
+    return name;
+}
+
+// Set scope debugging
+void MapSymTable::Scope::debug(bool state)
+{
+    debugFlg = state;
+}
+
+// Print the scope
+void MapSymTable::Scope::print(void (*printData)(void *))
+{
+    printf("Scope: %-15s -----------------\n", name.c_str());
+    for (std::map<std::string, void *>::iterator it=symbols.begin(); it!=symbols.end(); it++)
+    {
+        printf("%20s: ", (it->first).c_str());
+        printData(it->second);
+        printf("\n");
+    }
+}
+
+// Apply the function to each symbol in this scope
+void MapSymTable::Scope::applyToAll(void (*action)(std::string, void *))
+{
+    for (std::map<std::string, void *>::iterator it=symbols.begin(); it!=symbols.end(); it++)
+    {
+        action(it->first, it->second);
+    }
+}
+
+// Returns true if insert was successful and false if symbol already in this scope
+bool MapSymTable::Scope::insert(std::string sym, void *ptr)
+{
+    if (symbols.find(sym) == symbols.end())
+    {
+        if (debugFlg) printf("DEBUG(Scope): insert in \"%s\" the symbol \"%s\".\n", name.c_str(), sym.c_str());
+        if (ptr==NULL)
+        {
+            printf("ERROR(MapSymTable): Attempting to save a NULL pointer for the symbol '%s'.\n", sym.c_str());
+        }
+        symbols[sym] = ptr;
+        return true;
+    }
+    else
+    {
+        if (debugFlg)
+        {
+            printf("DEBUG(Scope): insert in \"%s\" the symbol \"%s\" but symbol already there!\n", name.c_str(), sym.c_str());
+        }
+        return false;
+    }
+}
+
+void *MapSymTable::Scope::lookup(std::string sym)
+{
+    if (symbols.find(sym) != symbols.end())
+    {
+        if (debugFlg)
+        {
+            printf("DEBUG(Scope): lookup in \"%s\" for the symbol \"%s\" and found it.\n", name.c_str(), sym.c_str());
+        }
+        return symbols[sym];
+    }
+    else
+    {
+        if (debugFlg)
+        {
+            printf("DEBUG(Scope): lookup in \"%s\" for the symbol \"%s\" and did NOT find it.\n", name.c_str(), sym.c_str());
+        }
+        return NULL;
+    }
+}
+
+bool MapSymTable::Scope::debugFlg;
+
+// // // // // // // // // // // // // // // // // // // // 
+//
+// Class: MapSymTable
+//
+//  This is a stack of scopes that represents a symbol table
+//
+MapSymTable::MapSymTable()
+{
+    debugFlg = false;
+    enter((std::string )"Global");
+}
+
+std::map<std::string, void*> MapSymTable::getSyms()
+{
+    return (stack.back())->getSyms();
+}
+
+void MapSymTable::debug(bool state)
+{
+    debugFlg = state;
+}
+
+// Returns the number of scopes in the symbol table
+int MapSymTable::depth()
+{
+    return stack.size();
+}
+
+// Print all scopes using data printing func
+void MapSymTable::print(void (*printData)(void *))
+{
+    printf("===========  Symbol Table  ===========\n");
+    for (std::vector<Scope *>::iterator it=stack.begin(); it!=stack.end(); it++)
+    {
+        (*it)->print(printData);
+    }
+    printf("===========  ============  ===========\n");
+}
+
+// Enter a scope
+void MapSymTable::enter(std::string name)
+{
+    if (debugFlg)
+    {
+        printf("DEBUG(MapSymTable): enter scope \"%s\".\n", name.c_str());
+    }
+    stack.push_back(new Scope(name));
+}
+
+// Leave a scope (not allowed to leave global)
+void MapSymTable::leave()
+{
+    if (debugFlg)
+    {
+        printf("DEBUG(MapSymTable): leave scope \"%s\".\n", (stack.back()->scopeName()).c_str());
+    }
+    if (stack.size() > 1)
+    {
+        delete stack.back();
+        stack.pop_back();
+    }
+    else
+    {
+        printf("ERROR(MapSymTable): You cannot leave global scope.  Number of scopes: %d.\n", (int)stack.size());
+    }
+}
+
+// Lookup a symbol anywhere in the stack of scopes, NULL if symbol not found, otherwise it returns the stored void * associated with the symbol
+void * MapSymTable::lookup(std::string sym)
+{
+    void *data;
+    std::string name;
+
+    data = NULL;    // Set even though the scope stack should never be empty
+
+    for (std::vector<Scope *>::reverse_iterator it=stack.rbegin(); it!=stack.rend(); it++)
+    {
+        data = (*it)->lookup(sym);
+        name = (*it)->scopeName();
+        if (data!=NULL) break;
+    }
+
+    if (debugFlg)
+    {
+        printf("DEBUG(MapSymTable): lookup the symbol \"%s\" and ", sym.c_str());
+        if (data)
+        {
+            printf("found it in the scope named \"%s\".\n", name.c_str());
+        }
+        else
+        {
+            printf("did NOT find it!\n");
+        }
+    }
+
+    return data;
+}
+
+
+// Lookup a symbol in the global scope, NULL if symbol not found, otherwise it returns the stored void * associated with the symbol
+void * MapSymTable::lookupGlobal(std::string sym)
+{
+    void *data;
+
+    data = stack[0]->lookup(sym);
+    if (debugFlg)
+    {
+        printf("DEBUG(MapSymTable): lookup the symbol \"%s\" in the Globals and %s.\n", sym.c_str(), (data ? "found it" : "did NOT find it"));
+    }
+    return data;
+}
+
+
+// Insert a symbol into the most recent scope, true if insert was successful and false if symbol already in the most recent scope
+bool MapSymTable::insert(std::string sym, void *ptr)
+{
+    if (debugFlg)
+    {
+        printf("DEBUG(symbolTable): insert in scope \"%s\" the symbol \"%s\"", (stack.back()->scopeName()).c_str(), sym.c_str());
+        if(ptr==NULL)
+        {
+            printf(" WARNING: The inserted pointer is NULL!!");
+        }
+        printf("\n");
+    }
+
+    return (stack.back())->insert(sym, ptr);
+}
+
+
+// Insert a symbol into the global scope
+// Returns true is insert was successful and false if symbol already in the global scope
+bool MapSymTable::insertGlobal(std::string sym, void *ptr)
+{
+    if (debugFlg)
+    {
+        printf("DEBUG(Scope): insert the global symbol \"%s\"", sym.c_str());
+        if(ptr == NULL)
+        {
+            printf(" WARNING: The inserted pointer is NULL!!");
+        }
+        printf("\n");
+    }
+
+    return stack[0]->insert(sym, ptr);
+}
+
+
+// Apply function to each simple in the local scope.   The function gets both the
+// string and the associated pointer.
+void MapSymTable::applyToAll(void (*action)(std::string, void *))
+{
+    stack[stack.size()-1]->applyToAll(action);
+}
+
+
+// Apply function to each simple in the global scope.   The function gets both the
+// string and the associated pointer.
+void MapSymTable::applyToAllGlobal(void (*action)(std::string, void *))
+{
+    stack[0]->applyToAll(action);
+}
+
@@ -0,0 +1,90 @@
+// Times SymTable against MapSymTable, the stack of std::map scopes it
+// replaced, on the scope traffic of programs nested deeper and deeper.
+// Built apart from the compiler by make symbench in hw7/src, and run by
+// python3 bench.py hw7/ --symtable.
+#include "MapSymTable.hpp"
+#include "../src/Semantics/SymTable.hpp"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Replays the scope traffic of a program: globals, then functions whose
+// nested blocks declare locals and look up names from every level
+template <class Table>
+long long int symTableWorkload(Table &table, const std::vector<std::string> &names, int funcs, int nesting)
+{
+    long long int found = 0;
+    for (int i = 0; i < 64; i++)
+    {
+        table.insert(names[i], (void *)(long long int)(i + 1));
+    }
+
+    for (int f = 0; f < funcs; f++)
+    {
+        table.enter("Function");
+        for (int p = 0; p < 4; p++)
+        {
+            table.insert(names[64 + (f * 4 + p) % (names.size() - 64)], (void *)(long long int)(p + 1));
+        }
+        for (int d = 0; d < nesting; d++)
+        {
+            table.enter("Compound");
+            for (int v = 0; v < 4; v++)
+            {
+                table.insert(names[64 + (f * 31 + d * 4 + v) % (names.size() - 64)], (void *)(long long int)(v + 1));
+            }
+            for (int l = 0; l < 16; l++)
+            {
+                found += (long long int)table.lookup(names[(f * 17 + d * 5 + l * 3) % names.size()]);
+            }
+        }
+        for (int d = 0; d < nesting; d++)
+        {
+            table.leave();
+        }
+        table.leave();
+    }
+    return found;
+}
+
+// Times the workload on both tables at increasing nesting depths, false if they ever disagree
+bool symTableBenchmark()
+{
+    std::vector<std::string> names;
+    for (int i = 0; i < 4096; i++)
+    {
+        names.push_back("name" + std::to_string(i));
+    }
+
+    bool agree = true;
+    printf("\nBenchmark: SymTable vs MapSymTable\n");
+    printf("%8s %8s %14s %14s %8s\n", "nesting", "funcs", "SymTable", "MapSymTable", "speedup");
+    for (int nesting : {1, 4, 16, 64})
+    {
+        int funcs = 65536 / nesting;
+
+        SymTable flat;
+        auto start = std::chrono::steady_clock::now();
+        long long int flatFound = symTableWorkload(flat, names, funcs, nesting);
+        std::chrono::duration<double> flatTime = std::chrono::steady_clock::now() - start;
+
+        MapSymTable map;
+        start = std::chrono::steady_clock::now();
+        long long int mapFound = symTableWorkload(map, names, funcs, nesting);
+        std::chrono::duration<double> mapTime = std::chrono::steady_clock::now() - start;
+
+        printf("%8d %8d %13.3fs %13.3fs %7.2fx\n", nesting, funcs, flatTime.count(), mapTime.count(), mapTime.count() / flatTime.count());
+        if (flatFound != mapFound)
+        {
+            printf("ERROR(SymTable): lookups disagree with MapSymTable at nesting %d.\n", nesting);
+            agree = false;
+        }
+    }
+    return agree;
+}
+
+int main()
+{
+    return symTableBenchmark() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,76 @@
+#include "Arena.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+Arena::Arena(const size_t blockSize) : m_blockSize(blockSize), m_next(nullptr), m_end(nullptr), m_allocCount(0), m_byteCount(0), m_heldByteCount(0), m_peakByteCount(0) {}
+
+Arena::~Arena()
+{
+    release();
+}
+
+Arena & Arena::unit()
+{
+    static thread_local Arena fallback;
+    return (s_unit != nullptr) ? *s_unit : fallback;
+}
+
+Arena * Arena::setUnit(Arena *arena)
+{
+    Arena *previous = s_unit;
+    s_unit = arena;
+    return previous;
+}
+
+void * Arena::allocate(const size_t size)
+{
+    // Keep every object aligned for any type
+    const size_t align = alignof(std::max_align_t);
+    size_t rounded = (size + align - 1) & ~(align - 1);
+
+    if (m_next == nullptr || rounded > (size_t)(m_end - m_next))
+    {
+        size_t blockSize = (rounded > m_blockSize) ? rounded : m_blockSize;
+        char *block = (char *)malloc(blockSize);
+        if (block == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        m_blocks.push_back(block);
+        m_next = block;
+        m_end = block + blockSize;
+    }
+
+    void *ptr = m_next;
+    m_next += rounded;
+    m_allocCount++;
+    m_byteCount += rounded;
+    m_heldByteCount += rounded;
+    if (m_heldByteCount > m_peakByteCount)
+    {
+        m_peakByteCount = m_heldByteCount;
+    }
+    return ptr;
+}
+
+const char * Arena::copy(const std::string_view str)
+{
+    char *ptr = (char *)allocate(str.size() + 1);
+    memcpy(ptr, str.data(), str.size());
+    ptr[str.size()] = '\0';
+    return ptr;
+}
+
+void Arena::release()
+{
+    for (char *block : m_blocks)
+    {
+        free(block);
+    }
+    m_blocks.clear();
+    m_next = nullptr;
+    m_end = nullptr;
+    m_heldByteCount = 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Bump pointer allocator that owns every tree object of a compilation unit.
+// Objects placed here are never destroyed one at a time; the whole arena is
+// released at once, so everything allocated in it must be trivially
+// destructible.
+class Arena
+{
+    public:
+        Arena(const size_t blockSize=64 * 1024);
+        Arena(const Arena &) = delete;
+        Arena & operator=(const Arena &) = delete;
+        ~Arena();
+
+        // Static
+        static Arena & unit();                          // The arena of the compilation unit being compiled on this thread
+        static Arena * setUnit(Arena *arena);           // Returns the unit it replaces, nullptr restores this thread's default
+
+        // Getters
+        size_t getAllocCount() const { return m_allocCount; }
+        size_t getBlockCount() const { return m_blocks.size(); }
+        size_t getByteCount() const { return m_byteCount; }        // Ever allocated, release() does not reset the counts
+        size_t getPeakByteCount() const { return m_peakByteCount; }    // The most held between two releases
+
+        // Helpers
+        void * allocate(const size_t size);
+        const char * copy(const std::string_view str);  // Null terminated copy of str
+        void release();
+
+    private:
+        const size_t m_blockSize;
+        std::vector<char *> m_blocks;
+        char *m_next;
+        char *m_end;
+        size_t m_allocCount;
+        size_t m_byteCount;
+        size_t m_heldByteCount;
+        size_t m_peakByteCount;
+
+        inline static thread_local Arena *s_unit = nullptr;
+};
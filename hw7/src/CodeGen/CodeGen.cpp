@@ -1,18 +1,35 @@
 #include "CodeGen.hpp"
+#include "../Optimizer/Peephole.hpp"
 
-FILE *code = NULL;
-
-CodeGen::CodeGen(Node *root, const std::string tmPath) : m_root(root), m_tmPath(tmPath), m_mainHasReturn(false), m_goffset(0), m_litOffset(1)
+CodeGen::CodeGen(Node *root, const std::string tmPath) : m_root(root), m_tmPath(tmPath), m_mainHasReturn(false), m_goffset(0), m_litOffset(1), m_allocateRegisters(false), m_peephole(nullptr), m_libraryEnd(0)
 {
     m_toffsets.push_back(0);
 }
 
-CodeGen::~CodeGen()
+CodeGen::~CodeGen() {}
+
+void CodeGen::updateForMem(Node *node, std::vector<Intern::Handle> iterators)
 {
-    fclose(code);
+    // Iterators a node adds are seen by its children and the siblings after it
+    std::vector<size_t> iteratorCounts;
+    traverse(node, [this, &iterators, &iteratorCounts](Node *node)
+    {
+        if (node->getMemIsUpdated())
+        {
+            return false;
+        }
+        updateForMemNode(node, iterators);
+        iteratorCounts.push_back(iterators.size());
+        return true;
+    },
+    [&iterators, &iteratorCounts](Node *)
+    {
+        iterators.resize(iteratorCounts.back());
+        iteratorCounts.pop_back();
+    });
 }
 
-void CodeGen::updateForMem(Node *node, std::vector<std::string> iterators)
+void CodeGen::updateForMemNode(Node *node, std::vector<Intern::Handle> &iterators)
 {
     /*
      * This function is the culmination of ~7 hours of attempting to match the changes in hw6 memory management that suddenly appeared in hw7.
@@ -22,22 +39,17 @@ void CodeGen::updateForMem(Node *node, std::vector<std::string> iterators)
      * k07.c-   Handle operations in Range node and the "by 2*c" portion
      * v07.c-   Also likely has issues due to changes in how For and Range node memory is managed (this was done in hw6 but changed in hw7)
     */
-    if (node == nullptr || node->getMemIsUpdated())
-    {
-        return;
-    }
-
     node->setMemIsUpdated(true);
 
     if (isRange(node))
     {
-        std::vector<Node *> children = node->getChildren();
-        for (int i = 0; i < children.size(); i++)
+        for (int i = 0; i < node->getChildCount(); i++)
         {
-            if (isId(children[i]))
+            Node *child = node->getChild(i);
+            if (isId(child))
             {
-                Id *id = (Id *)(children[i]);
-                iterators.push_back(id->getName());
+                Id *id = (Id *)child;
+                iterators.push_back(id->getNameHandle());
                 id->setMemIsUpdated(true);
             }
         }
@@ -48,7 +60,7 @@ void CodeGen::updateForMem(Node *node, std::vector<std::string> iterators)
     {
         node->setMemSize(node->getMemSize() - 2);
         Var *iterator = (Var *)(node->getChild());
-        iterators.push_back(iterator->getName());
+        iterators.push_back(iterator->getNameHandle());
         iterator->setMemIsUpdated(true);
     }
 
@@ -73,7 +85,7 @@ void CodeGen::updateForMem(Node *node, std::vector<std::string> iterators)
         if (isId(node))
         {
             Id *iteratorRef = (Id *)node;
-            if (std::find(iterators.begin(), iterators.end(), iteratorRef->getName()) != iterators.end())
+            if (std::find(iterators.begin(), iterators.end(), iteratorRef->getNameHandle()) != iterators.end())
             {
                 iteratorRef->setMemLoc(iteratorRef->getMemLoc() - 2);
             }
@@ -93,7 +105,7 @@ void CodeGen::updateForMem(Node *node, std::vector<std::string> iterators)
             if (isId(node))
             {
                 Id *iteratorRef = (Id *)node;
-                if (std::find(iterators.begin(), iterators.end(), iteratorRef->getName()) == iterators.end())
+                if (std::find(iterators.begin(), iterators.end(), iteratorRef->getNameHandle()) == iterators.end())
                 {
                     iteratorRef->setMemLoc(iteratorRef->getMemLoc() - 2);
                 }
@@ -104,49 +116,134 @@ void CodeGen::updateForMem(Node *node, std::vector<std::string> iterators)
             }
         }
     }
+}
 
-    std::vector<Node *> children = node->getChildren();
-    for (int i = 0; i < children.size(); i++)
+void CodeGen::generate()
+{
+    if (m_root == nullptr)
     {
-        updateForMem(children[i], iterators);
+        return;
     }
 
-    updateForMem(node->getSibling(), iterators);
+    std::ofstream code(m_tmPath);
+    if (!code)
+    {
+        throw std::runtime_error("CodeGen::generate() - Invalid tmPath provided to constructor");
+    }
+    generate(code);
 }
 
-void CodeGen::generate()
+void CodeGen::generate(std::ostream &code)
 {
     if (m_root == nullptr)
     {
         return;
     }
 
-    if (!(code = fopen(m_tmPath.c_str(), "w")))
+    begin();
+    generateDecl(m_root);
+    end();
+    write(code);
+}
+
+void CodeGen::begin()
+{
+    m_funcs[Intern::handle("input")] = 1;
+    m_funcs[Intern::handle("output")] = 6;
+    m_funcs[Intern::handle("inputb")] = 12;
+    m_funcs[Intern::handle("outputb")] = 17;
+    m_funcs[Intern::handle("inputc")] = 23;
+    m_funcs[Intern::handle("outputc")] = 28;
+    m_funcs[Intern::handle("outnl")] = 34;
+    m_code.emitSkip(1);
+    m_code.emitIO();
+    m_libraryEnd = m_code.emitWhereAmI();
+}
+
+void CodeGen::generateDecl(Node *decl, Block *block)
+{
+    int loc = m_code.emitWhereAmI();
+    size_t line = m_code.emitLineCount();
+    size_t call = m_calls.size();
+    if (block != nullptr)
     {
-        throw std::runtime_error("CodeGen::generate() - Invalid tmPath provided to constructor");
+        block->goffset = m_goffset;
+        block->litOffset = m_litOffset;
+        block->toffset = m_toffsets.back();
+    }
+
+    std::vector<Intern::Handle> iterators;
+    updateForMem(decl, iterators);
+    generateAndTraverse(decl);
+
+    if (block != nullptr)
+    {
+        block->code = m_code.copyBlock(loc, line);
+        block->calls.clear();
+        for (size_t i = call; i < m_calls.size(); i++)
+        {
+            block->calls.push_back({m_calls[i].first - loc, m_calls[i].second});
+        }
+        block->goffsetEnd = m_goffset;
+        block->litOffsetEnd = m_litOffset;
+        block->toffsetEnd = m_toffsets.back();
+    }
+}
+
+bool CodeGen::fits(const Block &block) const
+{
+    // String constants are placed by offset, everything else in a block is relative to where it starts
+    bool hasStrings = block.goffsetEnd != block.goffset || block.litOffsetEnd != block.litOffset;
+    return block.toffset == m_toffsets.back() && (!hasStrings || (block.goffset == m_goffset && block.litOffset == m_litOffset));
+}
+
+void CodeGen::emitBlock(const Block &block, const Intern::Handle func)
+{
+    if (!fits(block))
+    {
+        throw std::runtime_error("CodeGen::emitBlock() - Block was generated at other offsets");
+    }
+
+    // A function starts with storing its return address, see generateFunc()
+    int loc = m_code.emitWhereAmI();
+    m_code.emitBlock(block.code);
+    m_funcs[func] = loc;
+    for (const auto &[callLoc, name] : block.calls)
+    {
+        m_calls.push_back({callLoc + loc, name});
     }
+    m_goffset += block.goffsetEnd - block.goffset;
+    m_litOffset += block.litOffsetEnd - block.litOffset;
+    m_toffsets.back() = block.toffsetEnd;
+}
 
-    std::vector<std::string> iterators;
-    updateForMem(m_root, iterators);
-
-    m_funcs["input"] = 1;
-    m_funcs["output"] = 6;
-    m_funcs["inputb"] = 12;
-    m_funcs["outputb"] = 17;
-    m_funcs["inputc"] = 23;
-    m_funcs["outputc"] = 28;
-    m_funcs["outnl"] = 34;
-    emitIO();
-    emitNewLoc(39);
-    generateAndTraverse(m_root);
-    int prevInstLoc = emitWhereAmI();
-    emitNewLoc(0);
-    emitRM("JMP", 7, prevInstLoc - 1, 7, "Jump to init [backpatch]");
-    emitNewLoc(prevInstLoc);
+void CodeGen::end()
+{
+    int init = m_code.emitWhereAmI();
+    m_code.backPatchRM(0, "JMP", 7, m_code.emitWhereAmI() - 1, 7, "Jump to init [backpatch]");
     generateGlobals();
-    emitRM("LDA", 3, 1, 7, "Return address in ac");
-    emitRM("JMP", 7, -(emitWhereAmI() + 1 - m_funcs["main"]), 7, "Jump to main");
-    emitRO("HALT", 0, 0, 0, "DONE!");
+    m_code.emitRM("LDA", 3, 1, 7, "Return address in ac");
+    m_code.emitRM("JMP", 7, -(m_code.emitWhereAmI() + 1 - m_funcs[Intern::handle("main")]), 7, "Jump to main");
+    m_code.emitRO("HALT", 0, 0, 0, "DONE!");
+
+    for (const auto &[loc, name] : m_calls)
+    {
+        m_code.backPatchRM(loc, "JMP", 7, -(loc + 1 - m_funcs[name]), 7, "CALL", toChar(Intern::string(name)));
+    }
+
+    // The IO library and the code that starts the program are left as they are
+    if (m_peephole != nullptr)
+    {
+        std::vector<std::pair<int, std::string>> funcs;
+        for (const auto &[name, loc] : m_funcs)
+        {
+            if (loc >= m_libraryEnd)
+            {
+                funcs.push_back({loc, std::string(Intern::string(name))});
+            }
+        }
+        m_peephole->optimize(m_code, funcs, init);
+    }
 }
 
 void CodeGen::sortGlobals()
@@ -159,8 +256,8 @@ void CodeGen::sortGlobals()
 
 void CodeGen::generateGlobals()
 {
-    emitRM("LDA", 1, m_goffset, 0, "set first frame at end of globals");
-    emitRM("ST", 1, 0, 1, "store old fp (point to self)");
+    m_code.emitRM("LDA", 1, m_goffset, 0, "set first frame at end of globals");
+    m_code.emitRM("ST", 1, 0, 1, "store old fp (point to self)");
 
     sortGlobals();
     for (int i = 0; i < m_globals.size(); i++)
@@ -171,21 +268,22 @@ void CodeGen::generateGlobals()
 
 void CodeGen::generateAndTraverse(Node *node, const bool generateGlobals)
 {
-    if (node == nullptr)
+    // Only the node itself is generated as a global, not its children or siblings
+    Node *first = node;
+    traverse(node, [this, first, generateGlobals](Node *node)
     {
-        return;
-    }
-
-    generateNode(node, generateGlobals);
-
-    std::vector<Node *> children = node->getChildren();
-    for (int i = 0; i < children.size(); i++)
+        // Nothing is left to generate below an expression its parent generated, statements are walked again for their ends
+        if (node->getIsGenerated() && isExp(node))
+        {
+            return false;
+        }
+        generateNode(node, generateGlobals && node == first);
+        return true;
+    },
+    [this](Node *node)
     {
-        generateAndTraverse(children[i]);
-    }
-
-    generateEnd(node);
-    generateAndTraverse(node->getSibling());
+        generateEnd(node);
+    });
 }
 
 void CodeGen::generateNode(Node *node, const bool generateGlobals)
@@ -275,8 +373,8 @@ void CodeGen::generateNode(Node *node, const bool generateGlobals)
 
 void CodeGen::generateFunc(Func *func)
 {
-    emitRM("ST", 3, -1, 1, "Store return address");
-    m_funcs[func->getName()] = emitWhereAmI() - 1;
+    m_code.emitRM("ST", 3, -1, 1, "Store return address");
+    m_funcs[func->getNameHandle()] = m_code.emitWhereAmI() - 1;
     m_toffsets.back() -= 2;
 }
 
@@ -289,8 +387,8 @@ void CodeGen::generateVar(Var *var, const bool generateGlobals)
 {
     if (var->getData()->getIsArray())
     {
-        emitRM("LDC", 3, var->getMemSize() - 1, 6, "load size of array", toChar(var->getName()));
-        emitRM("ST", 3, var->getMemLoc() + 1, !var->getIsGlobal(), "save size of array", toChar(var->getName()));
+        m_code.emitRM("LDC", 3, var->getMemSize() - 1, 6, "load size of array", toChar(var->getName()));
+        m_code.emitRM("ST", 3, var->getMemLoc() + 1, !var->getIsGlobal(), "save size of array", toChar(var->getName()));
     }
 
     if (var->getData()->getIsArray() && var->getData()->getType() == Data::Type::Char)
@@ -303,7 +401,7 @@ void CodeGen::generateVar(Var *var, const bool generateGlobals)
     if (varValue != nullptr)
     {
         generateAndTraverse(varValue, generateGlobals);
-        emitRM("ST", 3, var->getMemLoc(), !var->getIsGlobal(), "Store variable", toChar(var->getName()));
+        m_code.emitRM("ST", 3, var->getMemLoc(), !var->getIsGlobal(), "Store variable", toChar(var->getName()));
     }
 }
 
@@ -318,24 +416,24 @@ void CodeGen::generateAsgn(Asgn *asgn)
         Id *id = (Id *)lhs;
         if (asgn->getType() != Asgn::Type::Asgn)
         {
-            emitRM("LD", 4, id->getMemLoc(), !id->getIsGlobal(), "load lhs variable", toChar(id->getName()));
-            emitRO(toChar(asgn->getTypeString()), 3, 4, 3, toChar("op " + asgn->getSym()));
+            m_code.emitRM("LD", 4, id->getMemLoc(), !id->getIsGlobal(), "load lhs variable", toChar(id->getName()));
+            m_code.emitRO(toChar(asgn->getTypeString()), 3, 4, 3, toChar("op " + asgn->getSym()));
         }
         else
         {
             if (id->getData()->getIsArray())
             {
-                emitRM("LDA", 4, id->getMemLoc(), 1, "address of lhs");
-                emitRM("LD", 5, 1, 3, "size of rhs");
-                emitRM("LD", 6, 1, 4, "size of lhs");
-                emitRO("SWP", 5, 6, 6, "pick smallest size");
-                emitRO("MOV", 4, 3, 5, "array op =");
+                m_code.emitRM("LDA", 4, id->getMemLoc(), 1, "address of lhs");
+                m_code.emitRM("LD", 5, 1, 3, "size of rhs");
+                m_code.emitRM("LD", 6, 1, 4, "size of lhs");
+                m_code.emitRO("SWP", 5, 6, 6, "pick smallest size");
+                m_code.emitRO("MOV", 4, 3, 5, "array op =");
             }
         }
 
         if (!(id->getData()->getIsArray() && id->getData()->getType() == Data::Type::Char))
         {
-            emitRM("ST", 3, id->getMemLoc(), !id->getIsGlobal(), "Store variable", toChar(id->getName()));
+            m_code.emitRM("ST", 3, id->getMemLoc(), !id->getIsGlobal(), "Store variable", toChar(id->getName()));
         }
     }
     else if (isBinary(lhs))
@@ -344,26 +442,46 @@ void CodeGen::generateAsgn(Asgn *asgn)
         Id *arrayId = (Id *)(lhs->getChild());
         if (asgn->getType() != Asgn::Type::Asgn)
         {
-            emitRM("LD", 4, 0, 5, "load lhs variable", toChar(arrayId->getName()));
-            emitRO(toChar(asgn->getTypeString()), 3, 4, 3, toChar("op " + asgn->getSym()));
+            m_code.emitRM("LD", 4, 0, 5, "load lhs variable", toChar(arrayId->getName()));
+            m_code.emitRO(toChar(asgn->getTypeString()), 3, 4, 3, toChar("op " + asgn->getSym()));
         }
-        emitRM("ST", 3, 0, 5, "Store variable", toChar(arrayId->getName()));
+        m_code.emitRM("ST", 3, 0, 5, "Store variable", toChar(arrayId->getName()));
     }
 }
 
 void CodeGen::generateBinary(Binary *binary)
 {
+    if (m_allocateRegisters && binary->getType() != Binary::Type::Index)
+    {
+        // An expression inside a call of another keeps the outer one's labels until that one is done
+        bool outermost = m_needs.empty();
+        labelRegisters(binary);
+        bool inRegisters = m_needs.count(binary) != 0;
+        if (inRegisters)
+        {
+            generateInRegisters(binary, s_firstAccumulator);
+        }
+        if (outermost)
+        {
+            m_needs.clear();
+        }
+        if (inRegisters)
+        {
+            return;
+        }
+    }
+
     if (binary->getType() != Binary::Type::Index)
     {
         Node *lhs = binary->getChild();
         generateAndTraverse(lhs);
 
-        emitRM("ST", 3, m_toffsets.back(), 1, "Push left side");
+        m_code.emitRM("ST", 3, m_toffsets.back(), 1, "Push left side");
         m_toffsets.back() -= 1;
         Node *rhs = binary->getChild(1);
         generateAndTraverse(rhs);
         m_toffsets.back() += 1;
-        emitRM("LD", 4, m_toffsets.back(), 1, "Pop left into ac1");
+        m_code.emitRM("LD", 4, m_toffsets.back(), 1, "Pop left into ac1");
 
         if (binary->getIsComparison())
         {
@@ -371,19 +489,19 @@ void CodeGen::generateBinary(Binary *binary)
             Id *rhsArrayId = (Id *)rhs;
             if (isId(lhsArrayId) && lhsArrayId->getData()->getIsArray() && isId(rhsArrayId) && rhsArrayId->getData()->getIsArray())
             {
-                emitRM("LD", 5, 1, 3, "AC2 <- |RHS|");
-                emitRM("LD", 6, 1, 4, "AC3 <- |LHS|");
-                emitRM("LDA", 2, 0, 5, "R2 <- |RHS|");
-                emitRO("SWP", 5, 6, 6, "pick smallest size");
-                emitRM("LD", 6, 1, 4, "AC3 <- |LHS|");
-                emitRO("CO", 4, 3, 5, "setup array compare  LHS vs RHS");
-                emitRO("TNE", 5, 4, 3, "if not equal then test (AC1, AC)");
-                emitRO("JNZ", 5, 2, 7, "jump not equal");
-                emitRM("LDA", 3, 0, 2, "AC1 <- |RHS|");
-                emitRM("LDA", 4, 0, 6, "AC <- |LHS|");
+                m_code.emitRM("LD", 5, 1, 3, "AC2 <- |RHS|");
+                m_code.emitRM("LD", 6, 1, 4, "AC3 <- |LHS|");
+                m_code.emitRM("LDA", 2, 0, 5, "R2 <- |RHS|");
+                m_code.emitRO("SWP", 5, 6, 6, "pick smallest size");
+                m_code.emitRM("LD", 6, 1, 4, "AC3 <- |LHS|");
+                m_code.emitRO("CO", 4, 3, 5, "setup array compare  LHS vs RHS");
+                m_code.emitRO("TNE", 5, 4, 3, "if not equal then test (AC1, AC)");
+                m_code.emitRO("JNZ", 5, 2, 7, "jump not equal");
+                m_code.emitRM("LDA", 3, 0, 2, "AC1 <- |RHS|");
+                m_code.emitRM("LDA", 4, 0, 6, "AC <- |LHS|");
             }
         }
-        emitRO(toChar(binary->getTypeString()), 3, 4, 3, toChar("Op " + toUpper(binary->getSym())));
+        m_code.emitRO(toChar(binary->getTypeString()), 3, 4, 3, toChar("Op " + toUpper(binary->getSym())));
     }
     else
     {
@@ -391,6 +509,163 @@ void CodeGen::generateBinary(Binary *binary)
     }
 }
 
+void CodeGen::labelRegisters(Node *node)
+{
+    // Sethi-Ullman numbers, bottom up: an operator whose operands need the same number of registers needs one more
+    traverse(node, [](Node *node, const TraversePosition &position)
+    {
+        if (position.depth == 0 && position.siblingIndex > 0)
+        {
+            return false;
+        }
+        switch (node->getNodeKind())
+        {
+            case Node::Kind::Binary:
+            {
+                const Binary *binary = (const Binary *)node;
+                const Data *lhs = ((const Exp *)binary->getChild())->getData();
+                const Data *rhs = ((const Exp *)binary->getChild(1))->getData();
+                return binary->getType() != Binary::Type::Index && !lhs->getIsArray() && !rhs->getIsArray() && lhs->getType() != Data::Type::String && rhs->getType() != Data::Type::String;
+            }
+            case Node::Kind::Unary:
+                return ((const Unary *)node)->getType() == Unary::Type::Chsign || ((const Unary *)node)->getType() == Unary::Type::Not;
+            case Node::Kind::Const:
+                return ((const Const *)node)->getType() != Const::Type::String;
+            case Node::Kind::Id:
+                return !((const Id *)node)->getData()->getIsArray();
+            default:
+                return false;
+        }
+    },
+    [this](Node *node)
+    {
+        unsigned need = 1;
+        if (isBinary(node))
+        {
+            unsigned lhs = getNeed(node->getChild());
+            unsigned rhs = getNeed(node->getChild(1));
+            need = (lhs == s_allRegisters || rhs == s_allRegisters) ? s_allRegisters : (lhs == rhs) ? lhs + 1 : std::max(lhs, rhs);
+        }
+        else if (isUnary(node))
+        {
+            // Not needs a second register for its 1
+            unsigned child = getNeed(node->getChild());
+            need = (child == s_allRegisters || ((Unary *)node)->getType() == Unary::Type::Chsign) ? child : std::max(child, 2u);
+        }
+        m_needs[node] = need;
+    });
+}
+
+unsigned CodeGen::getNeed(const Node *node) const
+{
+    auto need = m_needs.find(node);
+    return (need == m_needs.end()) ? s_allRegisters : need->second;
+}
+
+void CodeGen::generateInRegisters(Node *node, const int reg)
+{
+    // The value ends up in reg, the registers above it are free to use and the ones below are kept
+    if (!m_needs.count(node))
+    {
+        if (reg != s_firstAccumulator)
+        {
+            throw std::runtime_error("CodeGen::generateInRegisters() - Only the first accumulator can hold what uses every register");
+        }
+        generateAndTraverse(node);
+        return;
+    }
+
+    switch (node->getNodeKind())
+    {
+        case Node::Kind::Const:
+        {
+            Const *constN = (Const *)node;
+            switch (constN->getType())
+            {
+                case Const::Type::Int:
+                    m_code.emitRM("LDC", reg, constN->getIntValue(), 6, "Load integer constant");
+                    break;
+                case Const::Type::Bool:
+                    m_code.emitRM("LDC", reg, constN->getBoolValue(), 6, "Load Boolean constant");
+                    break;
+                default:
+                    m_code.emitRM("LDC", reg, (int)(constN->getCharValue()), 6, "Load char constant");
+                    break;
+            }
+            break;
+        }
+        case Node::Kind::Id:
+        {
+            Id *id = (Id *)node;
+            m_code.emitRM("LD", reg, id->getMemLoc(), !(id->getIsGlobal() || id->getData()->getIsStatic()), "Load variable", toChar(id->getName()));
+            break;
+        }
+        case Node::Kind::Unary:
+            generateInRegisters(node->getChild(), reg);
+            if (((Unary *)node)->getType() == Unary::Type::Chsign)
+            {
+                m_code.emitRO("NEG", reg, reg, reg, "Op unary -");
+            }
+            else
+            {
+                m_code.emitRM("LDC", reg + 1, 1, 6, "Load 1");
+                m_code.emitRO("XOR", reg, reg, reg + 1, "Op XOR to get logical not");
+            }
+            break;
+        default:
+            generateOpInRegisters(node, node->getChild(), node->getChild(1), reg);
+            break;
+    }
+    node->makeGenerated();
+}
+
+void CodeGen::generateOpInRegisters(Node *node, Node *lhs, Node *rhs, const int reg)
+{
+    // The operand needing more goes first unless either has side effects, one needing every register left is spilled around
+    Binary *binary = (Binary *)node;
+    std::string op = binary->getTypeString();
+    std::string comment = "Op " + toUpper(binary->getSym());
+    unsigned free = s_lastAccumulator - reg + 1;
+    unsigned lhsNeed = getNeed(lhs);
+    unsigned rhsNeed = getNeed(rhs);
+    bool rhsFirst = lhsNeed != s_allRegisters && rhsNeed != s_allRegisters && rhsNeed > lhsNeed;
+    Node *first = rhsFirst ? rhs : lhs;
+    Node *second = rhsFirst ? lhs : rhs;
+
+    generateInRegisters(first, reg);
+    if (getNeed(second) < free)
+    {
+        generateInRegisters(second, reg + 1);
+        if (rhsFirst)
+        {
+            m_code.emitRO(toChar(op), reg, reg + 1, reg, toChar(comment));
+        }
+        else
+        {
+            m_code.emitRO(toChar(op), reg, reg, reg + 1, toChar(comment));
+        }
+        return;
+    }
+
+    m_code.emitRM("ST", reg, m_toffsets.back(), 1, rhsFirst ? "Push right side" : "Push left side");
+    m_toffsets.back() -= 1;
+    generateInRegisters(second, reg);
+    m_toffsets.back() += 1;
+    if (reg == s_lastAccumulator)
+    {
+        throw std::runtime_error("CodeGen::generateOpInRegisters() - No register left to pop into");
+    }
+    m_code.emitRM("LD", reg + 1, m_toffsets.back(), 1, rhsFirst ? "Pop right into ac1" : "Pop left into ac1");
+    if (rhsFirst)
+    {
+        m_code.emitRO(toChar(op), reg, reg, reg + 1, toChar(comment));
+    }
+    else
+    {
+        m_code.emitRO(toChar(op), reg, reg + 1, reg, toChar(comment));
+    }
+}
+
 void CodeGen::generateBinaryIndex(Binary *binary)
 {
     if (binary->getType() != Binary::Type::Index)
@@ -399,24 +674,24 @@ void CodeGen::generateBinaryIndex(Binary *binary)
     }
 
     Id *id = (Id *)(binary->getChild());
-    if (id->getMemScope() == "Parameter")
+    if (id->getMemScope() == Node::MemScope::Parameter)
     {
-        emitRM("LD", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
+        m_code.emitRM("LD", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
     }
     else
     {
-        emitRM("LDA", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
+        m_code.emitRM("LDA", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
     }
 
     id->makeGenerated();
     binary->makeGenerated();
-    emitRM("ST", 3, m_toffsets.back(), 1, "Push left side");
+    m_code.emitRM("ST", 3, m_toffsets.back(), 1, "Push left side");
     m_toffsets.back() -= 1;
     generateAndTraverse(binary->getChild(1));
     m_toffsets.back() += 1;
-    emitRM("LD", 4, m_toffsets.back(), 1, "Pop left into ac1");
-    emitRO("SUB", 3, 4, 3, "compute location from index");
-    emitRM("LD", 3, 0, 3, "Load array element");
+    m_code.emitRM("LD", 4, m_toffsets.back(), 1, "Pop left into ac1");
+    m_code.emitRO("SUB", 3, 4, 3, "compute location from index");
+    m_code.emitRM("LD", 3, 0, 3, "Load array element");
 }
 
 void CodeGen::generateBinaryIndexValue(Binary *binary, Node *indexValue, int valueOffset3)
@@ -431,23 +706,23 @@ void CodeGen::generateBinaryIndexValue(Binary *binary, Node *indexValue, int val
 
     if (indexValue != nullptr)
     {
-        emitRM("ST", 3, m_toffsets.back(), 1, "Push index");
+        m_code.emitRM("ST", 3, m_toffsets.back(), 1, "Push index");
         m_toffsets.back() -= 1;
         generateAndTraverse(indexValue);
         m_toffsets.back() += 1;
-        emitRM("LD", 4, m_toffsets.back(), 1, "Pop index");
+        m_code.emitRM("LD", 4, m_toffsets.back(), 1, "Pop index");
     }
 
-    if (id->getMemScope() == "Parameter")
+    if (id->getMemScope() == Node::MemScope::Parameter)
     {
-        emitRM("LD", 5, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
+        m_code.emitRM("LD", 5, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
     }
     else
     {
-        emitRM("LDA", 5, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
+        m_code.emitRM("LDA", 5, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
     }
 
-    emitRO("SUB", 5, 5, valueOffset3, "Compute offset of value");
+    m_code.emitRO("SUB", 5, 5, valueOffset3, "Compute offset of value");
 
     id->makeGenerated();
     binary->makeGenerated();
@@ -456,21 +731,22 @@ void CodeGen::generateBinaryIndexValue(Binary *binary, Node *indexValue, int val
 void CodeGen::generateCall(Call *call)
 {
     int prevToffset = m_toffsets.back();
-    emitRM("ST", 1, m_toffsets.back(), 1, "Store fp in ghost frame for", toChar(call->getName()));
+    m_code.emitRM("ST", 1, m_toffsets.back(), 1, "Store fp in ghost frame for", toChar(call->getName()));
     m_toffsets.back() -= 2;
 
     std::vector<Node *> parms = call->getParms();
     for (int i = 0; i < parms.size(); i++)
     {
         generateNode(parms[i]);
-        emitRM("ST", 3, m_toffsets.back(), 1, "Push parameter");
+        m_code.emitRM("ST", 3, m_toffsets.back(), 1, "Push parameter");
         m_toffsets.back() -= 1;
     }
 
-    emitRM("LDA", 1, prevToffset, 1, "Ghost frame becomes new active frame");
-    emitRM("LDA", 3, 1, 7, "Return address in ac");
-    emitRM("JMP", 7, -(emitWhereAmI() + 1 - m_funcs[call->getName()]), 7, "CALL", toChar(call->getName()));
-    emitRM("LDA", 3, 0, 2, "Save the result in ac");
+    m_code.emitRM("LDA", 1, prevToffset, 1, "Ghost frame becomes new active frame");
+    m_code.emitRM("LDA", 3, 1, 7, "Return address in ac");
+    m_calls.push_back({m_code.emitWhereAmI(), call->getNameHandle()});
+    m_code.emitRM("JMP", 7, 0, 7, "CALL", toChar(call->getName()));
+    m_code.emitRM("LDA", 3, 0, 2, "Save the result in ac");
     m_toffsets.back() = prevToffset;
 }
 
@@ -479,25 +755,25 @@ void CodeGen::generateConst(Const *constN)
     switch (constN->getType())
     {
         case Const::Type::Int:
-            emitRM("LDC", 3, constN->getIntValue(), 6, "Load integer constant");
+            m_code.emitRM("LDC", 3, constN->getIntValue(), 6, "Load integer constant");
             break;
         case Const::Type::Bool:
-            emitRM("LDC", 3, constN->getBoolValue(), 6, "Load Boolean constant");
+            m_code.emitRM("LDC", 3, constN->getBoolValue(), 6, "Load Boolean constant");
             break;
         case Const::Type::Char:
-            emitRM("LDC", 3, (int)(constN->getCharValue()), 6, "Load char constant");
+            m_code.emitRM("LDC", 3, (int)(constN->getCharValue()), 6, "Load char constant");
             break;
         case Const::Type::String:
-            emitStrLit(m_litOffset, toChar(constN->getStringValue()));
+            m_code.emitStrLit(m_litOffset, toChar(constN->getStringValue()));
             Node *parent = constN->getParent();
-            emitRM("LDA", 3, constN->getMemLoc(), 0, "Load address of char array");
+            m_code.emitRM("LDA", 3, constN->getMemLoc(), 0, "Load address of char array");
             if (!isCall(parent))
             {
-                emitRM("LDA", 4, parent->getMemLoc(), 1, "address of lhs");
-                emitRM("LD", 5, 1, 3, "size of rhs");
-                emitRM("LD", 6, 1, 4, "size of lhs");
-                emitRO("SWP", 5, 6, 6, "pick smallest size");
-                emitRO("MOV", 4, 3, 5, "array op =");
+                m_code.emitRM("LDA", 4, parent->getMemLoc(), 1, "address of lhs");
+                m_code.emitRM("LD", 5, 1, 3, "size of rhs");
+                m_code.emitRM("LD", 6, 1, 4, "size of lhs");
+                m_code.emitRO("SWP", 5, 6, 6, "pick smallest size");
+                m_code.emitRO("MOV", 4, 3, 5, "array op =");
             }
             m_litOffset += constN->getMemSize();
             m_goffset -= constN->getMemSize();
@@ -515,13 +791,13 @@ void CodeGen::generateId(Id *id)
 
     if (id->getData()->getIsArray())
     {
-        if (id->getMemScope() == "Parameter")
+        if (id->getMemScope() == Node::MemScope::Parameter)
         {
-            emitRM("LD", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
+            m_code.emitRM("LD", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
         }
         else
         {
-            emitRM("LDA", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
+            m_code.emitRM("LDA", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
         }
         id->makeGenerated();
         return;
@@ -529,11 +805,11 @@ void CodeGen::generateId(Id *id)
 
     if (id->getIsGlobal() || id->getData()->getIsStatic())
     {
-        emitRM("LD", 3, id->getMemLoc(), 0, "Load variable", toChar(id->getName()));
+        m_code.emitRM("LD", 3, id->getMemLoc(), 0, "Load variable", toChar(id->getName()));
     }
     else
     {
-        emitRM("LD", 3, id->getMemLoc(), 1, "Load variable", toChar(id->getName()));
+        m_code.emitRM("LD", 3, id->getMemLoc(), 1, "Load variable", toChar(id->getName()));
     }
 }
 
@@ -543,33 +819,33 @@ void CodeGen::generateUnary(Unary *unary)
     {
         case Unary::Type::Chsign:
             generateAndTraverse(unary->getChild());
-            emitRO("NEG", 3, 3, 3, "Op unary -");
+            m_code.emitRO("NEG", 3, 3, 3, "Op unary -");
             break;
         case Unary::Type::Sizeof:
         {
             Id *id = (Id *)(unary->getChild());
-            if (id->getMemScope() == "Parameter")
+            if (id->getMemScope() == Node::MemScope::Parameter)
             {
-                emitRM("LD", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
+                m_code.emitRM("LD", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
             }
             else
             {
-                emitRM("LDA", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
+                m_code.emitRM("LDA", 3, id->getMemLoc(), !id->getIsGlobal(), "Load address of base of array", toChar(id->getName()));
             }
-            emitRM("LD", 3, 1, 3, "Load array size");
+            m_code.emitRM("LD", 3, 1, 3, "Load array size");
             id->makeGenerated();
             break;
         }
         case Unary::Type::Question:
             generateAndTraverse(unary->getChild());
-            emitRO("RND", 3, 3, 6, "Op ?");
+            m_code.emitRO("RND", 3, 3, 6, "Op ?");
             break;
         case Unary::Type::Not:
         {
             Node *lhs = unary->getChild();
             generateAndTraverse(lhs);
-            emitRM("LDC", 4, 1, 6, "Load 1");
-            emitRO("XOR", 3, 3, 4, "Op XOR to get logical not");
+            m_code.emitRM("LDC", 4, 1, 6, "Load 1");
+            m_code.emitRO("XOR", 3, 3, 4, "Op XOR to get logical not");
             break;
         }
     }
@@ -581,9 +857,9 @@ void CodeGen::generateUnaryAsgn(UnaryAsgn *unaryAsgn)
     if (isId(lhs))
     {
         Id *id = (Id *)lhs;
-        emitRM("LD", 3, id->getMemLoc(), !id->getIsGlobal(), "load lhs variable", toChar(id->getName()));
-        emitRM("LDA", 3, unaryAsgn->getTypeValue(), 3, toChar(unaryAsgn->getTypeString() + " value of"), toChar(id->getName()));
-        emitRM("ST", 3, id->getMemLoc(), !id->getIsGlobal(), "Store variable", toChar(id->getName()));
+        m_code.emitRM("LD", 3, id->getMemLoc(), !id->getIsGlobal(), "load lhs variable", toChar(id->getName()));
+        m_code.emitRM("LDA", 3, unaryAsgn->getTypeValue(), 3, toChar(unaryAsgn->getTypeString() + " value of"), toChar(id->getName()));
+        m_code.emitRM("ST", 3, id->getMemLoc(), !id->getIsGlobal(), "Store variable", toChar(id->getName()));
         id->makeGenerated();
     }
     else
@@ -591,15 +867,15 @@ void CodeGen::generateUnaryAsgn(UnaryAsgn *unaryAsgn)
         generateBinaryIndexValue((Binary *)(unaryAsgn->getChild()), unaryAsgn->getChild(1), 3);
 
         Id *id = (Id *)(unaryAsgn->getChild()->getChild());
-        emitRM("LD", 3, 0, 5, "load lhs variable", toChar(id->getName()));
-        emitRM("LDA", 3, unaryAsgn->getTypeValue(), 3, toChar(unaryAsgn->getTypeString() + " value of"), toChar(id->getName()));
-        emitRM("ST", 3, 0, 5, "Store variable", toChar(id->getName()));
+        m_code.emitRM("LD", 3, 0, 5, "load lhs variable", toChar(id->getName()));
+        m_code.emitRM("LDA", 3, unaryAsgn->getTypeValue(), 3, toChar(unaryAsgn->getTypeString() + " value of"), toChar(id->getName()));
+        m_code.emitRM("ST", 3, 0, 5, "Store variable", toChar(id->getName()));
     }
 }
 
 void CodeGen::generateBreak(Break *breakN)
 {
-    emitRM("JMP", 7, m_loffsets.back() - emitWhereAmI() - 1, 7, "break");
+    m_code.emitRM("JMP", 7, m_loffsets.back() - m_code.emitWhereAmI() - 1, 7, "break");
 }
 
 void CodeGen::generateCompound(Compound *compound)
@@ -622,39 +898,35 @@ void CodeGen::generateFor(For *forN)
     int prevInstLoc = m_toffsets.back();
     m_toffsets.push_back(m_toffsets.back() - 3);
     generateAndTraverse(range->getChild());
-    emitRM("ST", 3, prevInstLoc, 1, "save starting value in index variable");
+    m_code.emitRM("ST", 3, prevInstLoc, 1, "save starting value in index variable");
     generateAndTraverse(range->getChild(1));
-    emitRM("ST", 3, prevInstLoc - 1, 1, "save stop value");
+    m_code.emitRM("ST", 3, prevInstLoc - 1, 1, "save stop value");
     if (range->getChild(2))
     {
         generateAndTraverse(range->getChild(2));
     }
     else
     {
-        emitRM("LDC", 3, 1, 6, "default increment by 1");
+        m_code.emitRM("LDC", 3, 1, 6, "default increment by 1");
     }
-    emitRM("ST", 3, prevInstLoc - 2, 1, "save step value");
+    m_code.emitRM("ST", 3, prevInstLoc - 2, 1, "save step value");
 
-    int prevInstLoc2 = emitWhereAmI();
-    emitRM("LD", 4, prevInstLoc, 1, "loop index");
-    emitRM("LD", 5, prevInstLoc - 1, 1, "stop value");
-    emitRM("LD", 3, prevInstLoc - 2, 1, "step value");
-    emitRO("SLT", 3, 4, 5, "Op <");
-    emitRM("JNZ", 3, 1, 7, "Jump to loop body");
+    int prevInstLoc2 = m_code.emitWhereAmI();
+    m_code.emitRM("LD", 4, prevInstLoc, 1, "loop index");
+    m_code.emitRM("LD", 5, prevInstLoc - 1, 1, "stop value");
+    m_code.emitRM("LD", 3, prevInstLoc - 2, 1, "step value");
+    m_code.emitRO("SLT", 3, 4, 5, "Op <");
+    m_code.emitRM("JNZ", 3, 1, 7, "Jump to loop body");
 
-    int prevInstLoc3 = emitWhereAmI();
-    emitNewLoc(prevInstLoc3 + 1);
+    int prevInstLoc3 = m_code.emitSkip(1);
     generateAndTraverse(forN->getChild(2));
-    emitRM("LD", 3, prevInstLoc, 1, "Load index");
-    emitRM("LD", 5, prevInstLoc - 2, 1, "Load step");
-    emitRO("ADD", 3, 3, 5, "increment");
-    emitRM("ST", 3, prevInstLoc, 1, "store back to index");
-    emitRM("JMP", 7, prevInstLoc2 - emitWhereAmI() - 1, 7, "go to beginning of loop");
-
-    int prevInstLoc4 = emitWhereAmI();
-    emitNewLoc(prevInstLoc3);
-    emitRM("JMP", 7, prevInstLoc4 - prevInstLoc3 - 1, 7, "Jump past loop [backpatch]");
-    emitNewLoc(prevInstLoc4);
+    m_code.emitRM("LD", 3, prevInstLoc, 1, "Load index");
+    m_code.emitRM("LD", 5, prevInstLoc - 2, 1, "Load step");
+    m_code.emitRO("ADD", 3, 3, 5, "increment");
+    m_code.emitRM("ST", 3, prevInstLoc, 1, "store back to index");
+    m_code.emitRM("JMP", 7, prevInstLoc2 - m_code.emitWhereAmI() - 1, 7, "go to beginning of loop");
+
+    m_code.backPatchAJumpToHere(prevInstLoc3, "Jump past loop [backpatch]");
     m_toffsets.pop_back();
 }
 
@@ -662,32 +934,23 @@ void CodeGen::generateIf(If *ifN)
 {
     // Generate lhs
     generateAndTraverse(ifN->getChild());
-    int prevInstLoc = emitWhereAmI();
-    emitNewLoc(prevInstLoc + 1);
+    int prevInstLoc = m_code.emitSkip(1);
 
     // Generate rhs
     generateAndTraverse(ifN->getChild(1));
-    int prevInstLoc2 = emitWhereAmI();
-    emitNewLoc(prevInstLoc);
 
     if (ifN->getChild(2) != nullptr)
     {
         // Handle the "then" statement
-        emitRM("JZR", 3, prevInstLoc2 - prevInstLoc, 7, "Jump around the THEN if false [backpatch]");
-        emitNewLoc(prevInstLoc2);
-        prevInstLoc = emitWhereAmI();
-        emitNewLoc(prevInstLoc + 1);
+        int prevInstLoc2 = m_code.emitSkip(1);
+        m_code.backPatchAJumpToHere("JZR", 3, prevInstLoc, "Jump around the THEN if false [backpatch]");
         generateAndTraverse(ifN->getChild(2));
-        int prevInstLoc3 = emitWhereAmI();
-        emitNewLoc(prevInstLoc);
-        emitRM("JMP", 7, prevInstLoc3 - prevInstLoc - 1, 7, "Jump around the ELSE [backpatch]");
-        emitNewLoc(prevInstLoc3);
+        m_code.backPatchAJumpToHere(prevInstLoc2, "Jump around the ELSE [backpatch]");
     }
     else
     {
         // There is no "then" statement
-        emitRM("JZR", 3, prevInstLoc2 - prevInstLoc - 1, 7, "Jump around the THEN if false [backpatch]");
-        emitNewLoc(prevInstLoc2);
+        m_code.backPatchAJumpToHere("JZR", 3, prevInstLoc, "Jump around the THEN if false [backpatch]");
     }
 }
 
@@ -702,12 +965,12 @@ void CodeGen::generateReturn(Return *returnN)
     if (lhs != nullptr)
     {
         generateAndTraverse(lhs);
-        emitRM("LDA", 2, 0, 3, "Copy result to return register");
+        m_code.emitRM("LDA", 2, 0, 3, "Copy result to return register");
     }
 
-    emitRM("LD", 3, -1, 1, "Load return address");
-    emitRM("LD", 1, 0, 1, "Adjust fp");
-    emitRM("JMP", 7, 0, 3, "Return");
+    m_code.emitRM("LD", 3, -1, 1, "Load return address");
+    m_code.emitRM("LD", 1, 0, 1, "Adjust fp");
+    m_code.emitRM("JMP", 7, 0, 3, "Return");
 
     Func *func = (Func *)(returnN->getRelative(Node::Kind::Func));
     if (isFunc(func) && func->getName() == "main")
@@ -719,23 +982,19 @@ void CodeGen::generateReturn(Return *returnN)
 void CodeGen::generateWhile(While *whileN)
 {
     // Generate lhs
-    int prevInstLoc = emitWhereAmI();
+    int prevInstLoc = m_code.emitWhereAmI();
     generateAndTraverse(whileN->getChild());
-    emitRM("JNZ", 3, 1, 7, "Jump to while part");
+    m_code.emitRM("JNZ", 3, 1, 7, "Jump to while part");
 
     // Save offset for While
-    m_loffsets.push_back(emitWhereAmI());
+    m_loffsets.push_back(m_code.emitWhereAmI());
 
     // Generate rhs
-    int prevInstLoc2 = emitWhereAmI();
-    emitNewLoc(prevInstLoc2 + 1);
+    int prevInstLoc2 = m_code.emitSkip(1);
     generateAndTraverse(whileN->getChild(1));
-    emitRM("JMP", 7, prevInstLoc - emitWhereAmI() - 1, 7, "go to beginning of loop");
+    m_code.emitRM("JMP", 7, prevInstLoc - m_code.emitWhereAmI() - 1, 7, "go to beginning of loop");
 
-    int prevInstLoc3 = emitWhereAmI();
-    emitNewLoc(prevInstLoc2);
-    emitRM("JMP", 7, prevInstLoc3 - prevInstLoc2 - 1, 7, "Jump past loop [backpatch]");
-    emitNewLoc(prevInstLoc3);
+    m_code.backPatchAJumpToHere(prevInstLoc2, "Jump past loop [backpatch]");
 
     m_loffsets.pop_back();
 }
@@ -745,13 +1004,10 @@ void CodeGen::generateEnd(Node *node)
     if (isFunc(node))
     {
         Func *func = (Func *)node;
-        emitRM("LDC", 2, 0, 6, "Set return value to 0");
-        emitRM("LD", 3, -1, 1, "Load return address");
-        emitRM("LD", 1, 0, 1, "Adjust fp");
-        emitRM("JMP", 7, 0, 3, "Return");
-        int prevInstLoc = emitWhereAmI();
-        emitNewLoc(0);
-        emitNewLoc(prevInstLoc);
+        m_code.emitRM("LDC", 2, 0, 6, "Set return value to 0");
+        m_code.emitRM("LD", 3, -1, 1, "Load return address");
+        m_code.emitRM("LD", 1, 0, 1, "Adjust fp");
+        m_code.emitRM("JMP", 7, 0, 3, "Return");
         m_toffsets.back() = 0;
     }
     else if (isCompound(node))
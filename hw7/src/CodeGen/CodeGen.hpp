@@ -1,29 +1,64 @@
 #pragma once
 
-// #include "Instruction.hpp"
 #include "EmitCode/EmitCode.hpp"
+#include "../Intern/Intern.hpp"
+#include "../Tree/Traverse.hpp"
 #include "../Tree/Tree.hpp"
 #include "../Semantics/Semantics.hpp"
 
 #include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <string>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
+class Peephole;
+
 class CodeGen
 {
     public:
-        CodeGen(Node *root, const std::string tmPath);
+        // The code of one declaration and what it assumed about the code before it
+        struct Block
+        {
+            EmitCode::Block code;
+            std::vector<std::pair<int, Intern::Handle>> calls;     // Each call's jump, counted from the first instruction
+            int goffset;                                            // The offsets generating it started at
+            int litOffset;
+            int toffset;
+            int goffsetEnd;
+            int litOffsetEnd;
+            int toffsetEnd;
+        };
+
+        CodeGen(Node *root, const std::string tmPath="");
         ~CodeGen();
 
+        // Getters
+        size_t getGlobalCount() const { return m_globals.size(); }
+
+        // Setters
+        void setAllocateRegisters(const bool allocateRegisters) { m_allocateRegisters = allocateRegisters; }     // Before generating
+        void setPeephole(Peephole *peephole) { m_peephole = peephole; }                                           // Run over the functions by end()
+
         // Helpers
-        void generate();
+        void generate();                        // Write the program to the tmPath given to the constructor
+        void generate(std::ostream &code);
+
+        // A program generated a declaration at a time as it is parsed, with the same code as generate()
+        void begin();
+        void generateDecl(Node *decl, Block *block=nullptr);     // Copies the code into block as well
+        bool fits(const Block &block) const;                    // Whether block was generated at the offsets the code is at now
+        void emitBlock(const Block &block, const Intern::Handle func);     // Emit the code of a function generated before
+        void end();
+        void write(std::ostream &code) const { m_code.write(code); }
 
     private:
         // Helpers
-        void updateForMem(Node *node, std::vector<std::string> iterators);
+        void updateForMem(Node *node, std::vector<Intern::Handle> iterators);
+        void updateForMemNode(Node *node, std::vector<Intern::Handle> &iterators);
 
         // Generate
         void sortGlobals();
@@ -51,14 +86,30 @@ class CodeGen
         void generateWhile(While *whileN);
         void generateEnd(Node *node);
 
+        // Registers, an expression of constants, scalars and operators on them is evaluated in the accumulators
+        void labelRegisters(Node *node);
+        unsigned getNeed(const Node *node) const;
+        void generateInRegisters(Node *node, const int reg);
+        void generateOpInRegisters(Node *node, Node *lhs, Node *rhs, const int reg);
+
         Node *m_root;
         const std::string m_tmPath;
+        EmitCode m_code;
         bool m_showLog;
         bool m_mainHasReturn;
         int m_goffset;
         int m_litOffset;
         std::vector<int> m_toffsets;
         std::vector<int> m_loffsets;
-        std::map<std::string, int> m_funcs;
+        std::unordered_map<Intern::Handle, int> m_funcs;
+        std::vector<std::pair<int, Intern::Handle>> m_calls;   // Each call's jump, patched by end() once every function has an address
         std::vector<Var *> m_globals;
+        bool m_allocateRegisters;
+        Peephole *m_peephole;
+        int m_libraryEnd;                                       // Where the first function goes, after the IO library
+        std::unordered_map<const Node *, unsigned> m_needs;    // Of the expression being generated in registers
+
+        static const int s_firstAccumulator = 3;               // AC, AC1, AC2 and AC3 are free between statements
+        static const int s_lastAccumulator = 6;
+        static const unsigned s_allRegisters = 1000;           // The need of anything generated the usual way, it uses every register
 };
@@ -6,43 +6,62 @@
 //  Modified Nov 13, 2020 Robert Heckendorn
 //
 //  The two comment string forms of the calls allow you to easily
-//  compose a comment from text and a symbol name for example. 
+//  compose a comment from text and a symbol name for example.
+//
+//  Instructions are no longer printed as they are emitted. Each one is
+//  placed in its slot of an address-indexed buffer and the whole buffer
+//  is written once code generation is finished, in the order the lines
+//  were emitted.
 //
 
+#include <stdarg.h>
+#include <stdexcept>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "EmitCode.hpp"
 
-extern FILE *code;
 
+// Format a line the same way fprintf would have written it
+static std::string formatLine(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+
+    std::string line(length, '\0');
+    va_start(args, format);
+    vsnprintf(&line[0], length + 1, format, args);
+    va_end(args);
+    return line;
+}
 
-//  TM location number for current instruction emission
-static int emitLoc = 0;   // next empty slot in Imem growing to lower memory
-static int litLoc = 1;    // next empty slot in Dmem growing to higher memory
 
+EmitCode::EmitCode() : m_emitLoc(0), m_litLoc(1) {}
 
-//  Procedure emitComment prints a comment line 
+
+//  Procedure emitComment prints a comment line
 // with a comment that is the concatenation of c and d
-// 
-void emitComment(const char *c, const char *cc)
+//
+void EmitCode::emitComment(const char *c, const char *cc)
 {
-    fprintf(code, "* %s %s\n", c, cc);
+    m_lines.push_back({-1, formatLine("* %s %s", c, cc)});
 }
 
 
-void emitComment(const char *c, int n)
+void EmitCode::emitComment(const char *c, int n)
 {
-    fprintf(code, "* %s %d\n", c, n);
+    m_lines.push_back({-1, formatLine("* %s %d", c, n)});
 }
 
 
-//  Procedure emitComment prints a comment line 
+//  Procedure emitComment prints a comment line
 // with comment c in the code file
-// 
-void emitComment(const char *c)
+//
+void EmitCode::emitComment(const char *c)
 {
-    fprintf(code, "* %s\n", c);
+    m_lines.push_back({-1, formatLine("* %s", c)});
 }
 
 
@@ -53,15 +72,14 @@ void emitComment(const char *c)
 // s = 1st source register
 // t = 2nd source register
 // c = a comment
-// 
-void emitRO(const char *op, long long int r, long long int s, long long int t, const char *c, const char *cc)
+//
+void EmitCode::emitRO(const char *op, long long int r, long long int s, long long int t, const char *c, const char *cc)
 {
-    fprintf(code, "%3d:  %5s  %lld,%lld,%lld\t%s %s\n", emitLoc, op, r, s, t, c, cc);
-    fflush(code);
-    emitLoc++;
+    place(m_emitLoc, Instruction::Format::RO, op, r, s, t, c, cc);
+    m_emitLoc++;
 }
 
-void emitRO(const char *op,long long int r,long long int s,long long int t, const char *c)
+void EmitCode::emitRO(const char *op,long long int r,long long int s,long long int t, const char *c)
 {
     emitRO(op, r, s, t, c, (char *)"");
 }
@@ -74,70 +92,66 @@ void emitRO(const char *op,long long int r,long long int s,long long int t, cons
 // d = the offset
 // s = the base register
 // c = a comment
-// 
-void emitRM(const char *op, long long int r, long long int d, long long int s, const char *c, const char *cc)
+//
+void EmitCode::emitRM(const char *op, long long int r, long long int d, long long int s, const char *c, const char *cc)
 {
-    fprintf(code, "%3d:  %5s  %lld,%lld(%lld)\t%s %s\n", emitLoc, op, r, d, s, c, cc);
-    fflush(code);
-    emitLoc++;
+    place(m_emitLoc, Instruction::Format::RM, op, r, d, s, c, cc);
+    m_emitLoc++;
 }
 
-void emitRM(const char *op,long long int r,long long int d,long long int s, const char *c)
+void EmitCode::emitRM(const char *op,long long int r,long long int d,long long int s, const char *c)
 {
     emitRM(op, r, d, s, c, (char *)"");
 }
 
 
-void emitGoto(int d,long long int s, const char *c, const char *cc)
+void EmitCode::emitGoto(int d,long long int s, const char *c, const char *cc)
 {
     emitRM((char *)"JMP", (long long int)PC, d, s, c, cc);
 }
 
 
-void emitGoto(int d,long long int s, const char *c)
+void EmitCode::emitGoto(int d,long long int s, const char *c)
 {
     emitGoto(d,  s, c, (char *)"");
 }
 
 
 
-// emitRMAbs converts an absolute reference 
+// emitRMAbs converts an absolute reference
 // to a pc-relative reference when emitting a
 // register-to-memory TM instruction
 // op = the opcode
 // r = target register
 // a = the absolute location in memory
 // c = a comment
-// 
-void emitRMAbs(const char *op, long long int r, long long int a, const char *c, const char *cc)
+//
+void EmitCode::emitRMAbs(const char *op, long long int r, long long int a, const char *c, const char *cc)
 {
-    fprintf(code, "%3d:  %5s  %lld,%lld(%lld)\t%s %s\n", emitLoc, op, r, a - (long long int)(emitLoc + 1),
-	    (long long int)PC, c, cc);
-    fflush(code);
-    emitLoc++;
+    emitRM(op, r, a - (long long int)(m_emitLoc + 1), (long long int)PC, c, cc);
 }
 
 
-void emitRMAbs(const char *op,long long int r,long long int a, const char *c)
+void EmitCode::emitRMAbs(const char *op,long long int r,long long int a, const char *c)
 {
     emitRMAbs(op, r, a, c, (char *)"");
 }
 
 
-void emitGotoAbs(int a, const char *c, const char *cc)
+void EmitCode::emitGotoAbs(int a, const char *c, const char *cc)
 {
     emitRMAbs((char *)"JMP", (long long int)PC, a, c, cc);
 }
 
 
-void emitGotoAbs(int a, const char *c)
+void EmitCode::emitGotoAbs(int a, const char *c)
 {
     emitGotoAbs(a, c, (char *)"");
 }
 
 
 // emit a string literal instruction
-// 
+//
 // IMPORTANT: assumes litterals are stored in the global space at an
 // address which is an offset from the beginning of global space.
 //
@@ -146,36 +160,36 @@ void emitGotoAbs(int a, const char *c)
 //
 // The string is stored from higher order address to lower order address!!
 // An example assuming R0=9999:
-// 
+//
 // 2: LIT "horse"
-// 
+//
 // 9999  blah
 // 9998  5
 // 9997  h  <-- location of string
 // 9996  o
 // 9995  r
-// 9994  s 
+// 9994  s
 // 9993  e
 // 9992  blah
 // 9991  blah
 // 9990  blah
 
-int emitStrLit(int goffset, const char *s)
+int EmitCode::emitStrLit(int goffset, const char *s)
 {
-    fprintf(code, "%3d:  %5s  \"%s\"\n", goffset, (char *)"LIT", s);
+    m_lines.push_back({-1, formatLine("%3d:  %5s  \"%s\"", goffset, (char *)"LIT", s)});
     return goffset;
 }
 
 
-// 
+//
 //  Backpatching Functions
-// 
+//
 
 
 // asks where the next instruction will go.   Same as emitSkip(0).
-int emitWhereAmI()
+int EmitCode::emitWhereAmI() const
 {
-    return emitLoc;
+    return m_emitLoc;
 }
 
 
@@ -183,13 +197,13 @@ int emitWhereAmI()
 // locations for later backpatch.
 // It also returns the current code position.
 // emitSkip(0) tells you where you are and reserves no space.
-// 
+//
 
 
-int emitSkip(int howMany)
+int EmitCode::emitSkip(int howMany)
 {
-    int i = emitLoc;
-    emitLoc += howMany;
+    int i = m_emitLoc;
+    m_emitLoc += howMany;
 
     return i;
 }
@@ -197,86 +211,240 @@ int emitSkip(int howMany)
 
 // emitNewLoc sets the emitLoc to a new location
 // often loc = a previously skipped location
-// 
-void emitNewLoc(int loc)
+//
+void EmitCode::emitNewLoc(int loc)
+{
+    m_emitLoc = loc;
+}
+
+
+// this replaces the skipped instruction at addr with a
+// REGISTER-TO-MEMORY instruction without moving emitLoc
+void EmitCode::backPatchRM(int addr, const char *op, long long int r, long long int d, long long int s, const char *c, const char *cc)
 {
-    emitLoc = loc;
+    place(addr, Instruction::Format::RM, op, r, d, s, c, cc);
+}
+
+void EmitCode::backPatchRM(int addr, const char *op, long long int r, long long int d, long long int s, const char *c)
+{
+    backPatchRM(addr, op, r, d, s, c, (char *)"");
 }
 
 
 // this back patches a LDA at the instruction address addr that
 // jumps to the current instruction location now that it is known.
 // This is essentially a backpatched "goto"
-void backPatchAJumpToHere(int addr, const char *comment)
+void EmitCode::backPatchAJumpToHere(int addr, const char *comment)
 {
-    int currloc;
-
-    currloc = emitWhereAmI();       // remember where we are
-    emitNewLoc(addr);               // go to addr
-    emitGotoAbs(currloc, comment);  // the LDA to here
-    emitNewLoc(currloc);            // restore addr
+    backPatchRM(addr, (char *)"JMP", (long long int)PC, m_emitLoc - (addr + 1), (long long int)PC, comment);
 }
 
 
 // this back patches a JZR or JNZ at the instruction address addr that
 // jumps to the current instruction location now that it is known.
-void backPatchAJumpToHere(const char *cmd, int reg, int addr, const char *comment)
+void EmitCode::backPatchAJumpToHere(const char *cmd, int reg, int addr, const char *comment)
 {
-    int currloc;
+    backPatchRM(addr, cmd, reg, m_emitLoc - (addr + 1), (long long int)PC, comment);   // cmd = JZR, JNZ
+}
 
-    currloc = emitWhereAmI();       // remember where we are
-    emitNewLoc(addr);               // go to addr
-    emitRMAbs(cmd, reg, currloc, comment);  // cmd = JZR, JNZ
-    emitNewLoc(currloc);            // restore addr
+void EmitCode::emitIO()
+{
+    emitComment("** ** ** ** ** ** ** ** ** ** ** **");
+    emitComment("IO Library");
+
+    // input
+    emitRM("ST", 3, -1, 1, "Store return address");
+    emitRO("IN", 2, 2, 2, "Grab int input");
+    emitRM("LD", 3, -1, 1, "Load return address");
+    emitRM("LD", 1, 0, 1, "Adjust fp");
+    emitRM("JMP", 7, 0, 3, "Return");
+
+    // output
+    emitRM("ST", 3, -1, 1, "Store return address");
+    emitRM("LD", 3, -2, 1, "Load parameter");
+    emitRO("OUT", 3, 3, 3, "Output integer");
+    emitRM("LD", 3, -1, 1, "Load return address");
+    emitRM("LD", 1, 0, 1, "Adjust fp");
+    emitRM("JMP", 7, 0, 3, "Return");
+
+    // inputb
+    emitRM("ST", 3, -1, 1, "Store return address");
+    emitRO("INB", 2, 2, 2, "Grab bool input");
+    emitRM("LD", 3, -1, 1, "Load return address");
+    emitRM("LD", 1, 0, 1, "Adjust fp");
+    emitRM("JMP", 7, 0, 3, "Return");
+
+    // outputb
+    emitRM("ST", 3, -1, 1, "Store return address");
+    emitRM("LD", 3, -2, 1, "Load parameter");
+    emitRO("OUTB", 3, 3, 3, "Output bool");
+    emitRM("LD", 3, -1, 1, "Load return address");
+    emitRM("LD", 1, 0, 1, "Adjust fp");
+    emitRM("JMP", 7, 0, 3, "Return");
+
+    // inputc
+    emitRM("ST", 3, -1, 1, "Store return address");
+    emitRO("INC", 2, 2, 2, "Grab char input");
+    emitRM("LD", 3, -1, 1, "Load return address");
+    emitRM("LD", 1, 0, 1, "Adjust fp");
+    emitRM("JMP", 7, 0, 3, "Return");
+
+    // outputc
+    emitRM("ST", 3, -1, 1, "Store return address");
+    emitRM("LD", 3, -2, 1, "Load parameter");
+    emitRO("OUTC", 3, 3, 3, "Output char");
+    emitRM("LD", 3, -1, 1, "Load return address");
+    emitRM("LD", 1, 0, 1, "Adjust fp");
+    emitRM("JMP", 7, 0, 3, "Return");
+
+    // outnl
+    emitRM("ST", 3, -1, 1, "Store return address");
+    emitRO("OUTNL", 3, 3, 3, "Output a newline");
+    emitRM("LD", 3, -1, 1, "Load return address");
+    emitRM("LD", 1, 0, 1, "Adjust fp");
+    emitRM("JMP", 7, 0, 3, "Return");
+
+    emitComment("** ** ** ** ** ** ** ** ** ** ** **");
+}
+
+EmitCode::Block EmitCode::copyBlock(int loc, size_t line) const
+{
+    Block block;
+    block.lines.reserve(m_lines.size() - line);
+    for (size_t i = line; i < m_lines.size(); i++)
+    {
+        Line copy = m_lines[i];
+        if (copy.loc >= 0)
+        {
+            if (copy.loc < loc)
+            {
+                throw std::runtime_error("EmitCode::copyBlock() - A line backpatches an instruction before the block");
+            }
+            copy.loc -= loc;
+        }
+        block.lines.push_back(copy);
+    }
+    block.instructions.assign(m_instructions.begin() + std::min<size_t>(loc, m_instructions.size()), m_instructions.begin() + std::min<size_t>(m_emitLoc, m_instructions.size()));
+    return block;
+}
+
+void EmitCode::emitBlock(const Block &block)
+{
+    // Jumps inside a block are relative to the pc, so it runs from anywhere
+    int loc = m_emitLoc;
+    if (loc + block.instructions.size() > m_instructions.size())
+    {
+        m_instructions.resize(loc + block.instructions.size());
+    }
+    std::copy(block.instructions.begin(), block.instructions.end(), m_instructions.begin() + loc);
+    for (const Line &line : block.lines)
+    {
+        m_lines.push_back({(line.loc >= 0) ? line.loc + loc : -1, line.text});
+    }
+    m_emitLoc += block.instructions.size();
+}
+
+void EmitCode::removeInstructions(const std::vector<bool> &removed)
+{
+    // A reference to a removed instruction goes to the first one kept after it
+    int count = m_instructions.size();
+    std::vector<int> locs(count + 1);
+    int kept = 0;
+    for (int loc = 0; loc < count; loc++)
+    {
+        locs[loc] = kept;
+        if (loc >= removed.size() || !removed[loc])
+        {
+            kept++;
+        }
+    }
+    locs[count] = kept;
+
+    for (int loc = 0; loc < count; loc++)
+    {
+        Instruction &instruction = m_instructions[loc];
+        if ((loc < removed.size() && removed[loc]) || instruction.format != Instruction::Format::RM || instruction.t != PC || instruction.op == "LDC")
+        {
+            continue;
+        }
+        long long int target = loc + 1 + instruction.s;
+        if (target < 0 || target > count)
+        {
+            throw std::runtime_error("EmitCode::removeInstructions() - Reference outside of instruction memory");
+        }
+        instruction.s = locs[target] - (locs[loc] + 1);
+    }
+
+    for (int loc = 0; loc < count; loc++)
+    {
+        if (locs[loc] != loc && (loc >= removed.size() || !removed[loc]))
+        {
+            m_instructions[locs[loc]] = std::move(m_instructions[loc]);
+        }
+    }
+    m_instructions.resize(kept);
+
+    size_t line = 0;
+    for (const Line &each : m_lines)
+    {
+        if (each.loc >= 0 && each.loc < removed.size() && removed[each.loc])
+        {
+            continue;
+        }
+        m_lines[line++] = {(each.loc >= 0) ? locs[each.loc] : -1, each.text};
+    }
+    m_lines.resize(line);
+    m_emitLoc = locs[std::min(m_emitLoc, count)];
+}
+
+// Write out every line in the order it was emitted
+void EmitCode::write(std::ostream &code) const
+{
+    for (const Line &line : m_lines)
+    {
+        if (line.loc < 0)
+        {
+            code << line.text << '\n';
+            continue;
+        }
+
+        const Instruction &instruction = m_instructions[line.loc];
+        if (instruction.format == Instruction::Format::RO)
+        {
+            code << formatLine("%3d:  %5s  %lld,%lld,%lld\t%s\n", line.loc, instruction.op.c_str(), instruction.r, instruction.s, instruction.t, instruction.comment.c_str());
+        }
+        else
+        {
+            code << formatLine("%3d:  %5s  %lld,%lld(%lld)\t%s\n", line.loc, instruction.op.c_str(), instruction.r, instruction.s, instruction.t, instruction.comment.c_str());
+        }
+    }
 }
 
-void emitIO()
+void EmitCode::place(int loc, Instruction::Format format, const char *op, long long int r, long long int s, long long int t, const char *c, const char *cc)
 {
-    fprintf(code, "%s", R"""(* ** ** ** ** ** ** ** ** ** ** ** **
-* IO Library
-  1:     ST  3,-1(1)	Store return address 
-  2:     IN  2,2,2	Grab int input 
-  3:     LD  3,-1(1)	Load return address 
-  4:     LD  1,0(1)	Adjust fp 
-  5:    JMP  7,0(3)	Return 
-  6:     ST  3,-1(1)	Store return address 
-  7:     LD  3,-2(1)	Load parameter 
-  8:    OUT  3,3,3	Output integer 
-  9:     LD  3,-1(1)	Load return address 
- 10:     LD  1,0(1)	Adjust fp 
- 11:    JMP  7,0(3)	Return 
- 12:     ST  3,-1(1)	Store return address 
- 13:    INB  2,2,2	Grab bool input 
- 14:     LD  3,-1(1)	Load return address 
- 15:     LD  1,0(1)	Adjust fp 
- 16:    JMP  7,0(3)	Return 
- 17:     ST  3,-1(1)	Store return address 
- 18:     LD  3,-2(1)	Load parameter 
- 19:   OUTB  3,3,3	Output bool 
- 20:     LD  3,-1(1)	Load return address 
- 21:     LD  1,0(1)	Adjust fp 
- 22:    JMP  7,0(3)	Return 
- 23:     ST  3,-1(1)	Store return address 
- 24:    INC  2,2,2	Grab char input 
- 25:     LD  3,-1(1)	Load return address 
- 26:     LD  1,0(1)	Adjust fp 
- 27:    JMP  7,0(3)	Return 
- 28:     ST  3,-1(1)	Store return address 
- 29:     LD  3,-2(1)	Load parameter 
- 30:   OUTC  3,3,3	Output char 
- 31:     LD  3,-1(1)	Load return address 
- 32:     LD  1,0(1)	Adjust fp 
- 33:    JMP  7,0(3)	Return 
- 34:     ST  3,-1(1)	Store return address 
- 35:  OUTNL  3,3,3	Output a newline 
- 36:     LD  3,-1(1)	Load return address 
- 37:     LD  1,0(1)	Adjust fp 
- 38:    JMP  7,0(3)	Return 
-* ** ** ** ** ** ** ** ** ** ** ** **
-)""");
+    if (loc < 0)
+    {
+        throw std::runtime_error("EmitCode::place() - Invalid instruction location");
+    }
+    if (loc >= m_instructions.size())
+    {
+        m_instructions.resize(loc + 1);
+    }
+
+    Instruction &instruction = m_instructions[loc];
+    if (instruction.format == Instruction::Format::None)
+    {
+        m_lines.push_back({loc, ""});
+    }
+    instruction.format = format;
+    instruction.op = op;
+    instruction.r = r;
+    instruction.s = s;
+    instruction.t = t;
+    instruction.comment = std::string(c) + " " + cc;
 }
 
-char * toChar(const std::string comment)
+char * toChar(const std::string &comment)
 {
     return const_cast<char *>((comment).c_str());
 }
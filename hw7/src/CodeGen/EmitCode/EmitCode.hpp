@@ -2,7 +2,7 @@
 #define EMIT_CODE_H__
 
 //
-//  REGISTER DEFINES for optional use in calling the 
+//  REGISTER DEFINES for optional use in calling the
 //  routines below.
 //
 #define GP   0	//  The global pointer
@@ -19,41 +19,86 @@
 //
 #define NO_COMMENT (char *)""
 
+#include "Instruction.hpp"
+
 #include <algorithm>
+#include <ostream>
+#include <stdio.h>
 #include <string>
+#include <vector>
 
 //
-//  The following functions were borrowed from Tiny compiler code generator
+//  The following routines were borrowed from Tiny compiler code generator.
+//  Instructions are collected in an address-indexed buffer and written out
+//  in one pass by write(), so backpatching replaces the placeholder in place.
+//  The file keeps the order lines were emitted in, backpatches included.
 //
-int emitWhereAmI();           // gives where the next instruction will be placed
-int emitSkip(int howMany);    // emitSkip(0) tells you where the next instruction will be placed
-void emitNewLoc(int loc);     // set the instruction counter back to loc
+class EmitCode
+{
+    public:
+        struct Line
+        {
+            int loc;            // Instruction slot, or -1 for a comment or LIT line
+            std::string text;
+        };
+
+        // Lines emitted since some point, their slots counted from the first instruction among them
+        struct Block
+        {
+            std::vector<Line> lines;
+            std::vector<Instruction> instructions;
+        };
+
+        EmitCode();
+
+        int emitWhereAmI() const;       // gives where the next instruction will be placed
+        int emitSkip(int howMany);      // emitSkip(0) tells you where the next instruction will be placed
+        void emitNewLoc(int loc);       // set the instruction counter back to loc
+
+        void emitComment(const char *c);
+        void emitComment(const char *c, const char *cc);
+        void emitComment(const char *c, int n);
+
+        void emitGoto(int d, long long int s, const char *c);
+        void emitGoto(int d, long long int s, const char *c, const char *cc);
+        void emitGotoAbs(int a, const char *c);
+        void emitGotoAbs(int a, const char *c, const char *cc);
+
+        void emitRM(const char *op, long long int r, long long int d, long long int s, const char *c);
+        void emitRM(const char *op, long long int r, long long int d, long long int s, const char *c, const char *cc);
+        void emitRMAbs(const char *op, long long int r, long long int a, const char *c);
+        void emitRMAbs(const char *op, long long int r, long long int a, const char *c, const char *cc);
+
+        void emitRO(const char *op, long long int r, long long int s, long long int t, const char *c);
+        void emitRO(const char *op, long long int r, long long int s, long long int t, const char *c, const char *cc);
 
-void emitComment(const char *c);
-void emitComment(const char *c, const char *cc);
-void emitComment(const char *c, int n);
+        void backPatchRM(int addr, const char *op, long long int r, long long int d, long long int s, const char *c);
+        void backPatchRM(int addr, const char *op, long long int r, long long int d, long long int s, const char *c, const char *cc);
+        void backPatchAJumpToHere(int addr, const char *comment);
+        void backPatchAJumpToHere(const char *cmd, int reg, int addr, const char *comment);
 
-void emitGoto(int d, long long int s, const char *c);
-void emitGoto(int d, long long int s, const char *c, const char *cc);
-void emitGotoAbs(int a, const char *c);
-void emitGotoAbs(int a, const char *c, const char *cc);
+        int emitStrLit(int goffset, const char *s); // for const char arrays
 
-void emitRM(const char *op, long long int r, long long int d, long long int s, const char *c);
-void emitRM(const char *op, long long int r, long long int d, long long int s, const char *c, const char *cc);
-void emitRMAbs(const char *op, long long int r, long long int a, const char *c);
-void emitRMAbs(const char *op, long long int r, long long int a, const char *c, const char *cc);
+        void emitIO();
 
-void emitRO(const char *op, long long int r, long long int s, long long int t, const char *c);
-void emitRO(const char *op, long long int r, long long int s, long long int t, const char *c, const char *cc);
+        size_t emitLineCount() const { return m_lines.size(); }
+        const Instruction & getInstruction(int loc) const { return m_instructions[loc]; }
+        void removeInstructions(const std::vector<bool> &removed);  // close up the gaps, every pc-relative reference follows its target
+        Block copyBlock(int loc, size_t line) const;    // everything emitted since loc and line were where things went
+        void emitBlock(const Block &block);             // emit a copied block again from the current location
 
-void backPatchAJumpToHere(int addr, const char *comment);
-void backPatchAJumpToHere(const char *cmd, int reg, int addr, const char *comment);
+        void write(std::ostream &code) const;   // write every emitted line in order
 
-int emitStrLit(int goffset, const char *s); // for const char arrays
+    private:
+        void place(int loc, Instruction::Format format, const char *op, long long int r, long long int s, long long int t, const char *c, const char *cc);
 
-void emitIO();
+        std::vector<Instruction> m_instructions;
+        std::vector<Line> m_lines;
+        int m_emitLoc;  // next empty slot in Imem growing to lower memory
+        int m_litLoc;   // next empty slot in Dmem growing to higher memory
+};
 
-char * toChar(const std::string comment);
+char * toChar(const std::string &comment);
 std::string toUpper(std::string s);
 
-#endif
\ No newline at end of file
+#endif
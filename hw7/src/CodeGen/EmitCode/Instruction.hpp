@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+// One slot of TM instruction memory
+struct Instruction
+{
+    enum class Format { None, RO, RM };
+
+    Format format = Format::None;   // None until an instruction is placed in the slot
+    std::string op;                 // The opcode
+    long long int r = 0;            // Target register
+    long long int s = 0;            // RO: 1st source register, RM: offset
+    long long int t = 0;            // RO: 2nd source register, RM: base register
+    std::string comment;            // The trailing comment
+};
@@ -0,0 +1,182 @@
+#include "Batch.hpp"
+#include "Compilation.hpp"
+#include "../Tree/Traverse.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+Batch::Batch(const unsigned threadCount, const bool handScanner) : m_threadCount(threadCount), m_handScanner(handScanner), m_format(Emit::Format::Text), m_optimize(false), m_printReport(false), m_lowerIR(false), m_printIR(false)
+{
+    if (m_threadCount == 0)
+    {
+        m_threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+void Batch::add(const std::string &path)
+{
+    // Anything but a directory is compiled as given, a missing file is reported in its turn
+    std::error_code error;
+    if (!std::filesystem::is_directory(path, error))
+    {
+        m_units.push_back({path, "", 0, false});
+        return;
+    }
+
+    // Directories are walked in name order so the report does not depend on the file system
+    std::vector<std::string> paths;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(path, error))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".c-")
+        {
+            paths.push_back(entry.path().string());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const std::string &source : paths)
+    {
+        m_units.push_back({source, "", 0, false});
+    }
+}
+
+bool Batch::compile(std::ostream &out)
+{
+    // Deal the files out round robin, stealing evens out whatever imbalance is left
+    unsigned threadCount = std::max(1u, std::min<unsigned>(m_threadCount, m_units.size()));
+    m_queues.clear();
+    m_queues.resize(threadCount);
+    for (size_t i = 0; i < m_units.size(); i++)
+    {
+        m_queues[i % threadCount].units.push_back(i);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned worker = 1; worker < threadCount; worker++)
+    {
+        threads.emplace_back(&Batch::work, this, worker);
+    }
+    work(0);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    bool opened = true;
+    size_t lineCount = 0;
+    for (const Unit &unit : m_units)
+    {
+        out << "==> " << unit.path << " <==" << std::endl;
+        out << unit.diagnostics;
+        opened = opened && unit.opened;
+        lineCount += unit.lineCount;
+    }
+
+    double seconds = std::max(elapsed.count(), 1e-9);
+    out << "Compiled " << m_units.size() << " files (" << lineCount << " lines) on " << threadCount << (threadCount == 1 ? " thread" : " threads") << " in " << std::fixed << std::setprecision(3) << seconds << "s: ";
+    out << std::setprecision(1) << m_units.size() / seconds << " files/s, " << lineCount / seconds << " lines/s" << std::defaultfloat << std::endl;
+    return opened;
+}
+
+std::string Batch::tmFilepath(const std::string &path)
+{
+    // Only a .c- extension is replaced, any other name keeps all of its own
+    std::filesystem::path tmPath = path;
+    if (tmPath.extension() == ".c-")
+    {
+        return tmPath.replace_extension(".tm").string();
+    }
+    return path + ".tm";
+}
+
+void Batch::work(const unsigned worker)
+{
+    size_t unit;
+    while (take(worker, unit))
+    {
+        compileUnit(m_units[unit]);
+    }
+}
+
+bool Batch::take(const unsigned worker, size_t &unit)
+{
+    {
+        Queue &own = m_queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.units.empty())
+        {
+            unit = own.units.back();
+            own.units.pop_back();
+            return true;
+        }
+    }
+
+    // Nothing is ever added once compiling starts, so empty queues everywhere means done
+    for (unsigned i = 1; i < m_queues.size(); i++)
+    {
+        Queue &victim = m_queues[(worker + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.units.empty())
+        {
+            unit = victim.units.front();
+            victim.units.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Batch::compileUnit(Unit &unit)
+{
+    // Functions are generated while parsing, so one file that throws anywhere must not take the other files down with it
+    std::ostringstream diagnostics;
+    try
+    {
+        Compilation compilation(diagnostics);
+        Emit::setFormat(m_format);
+        compilation.setUseHandScanner(m_handScanner);
+        compilation.setOptimize(m_optimize);
+        compilation.setLowerIR(m_lowerIR);
+        compilation.setPrintIR(m_printIR);
+        compilation.setStreaming(!m_lowerIR);
+        unit.opened = compilation.open(unit.path);
+        if (!unit.opened)
+        {
+            Emit::error("ARGLIST", "source file \"" + unit.path + "\" could not be opened.");
+        }
+        else
+        {
+            compilation.parse();
+            compilation.analyze();
+            unit.lineCount = compilation.getLineCount() - 1;
+        }
+        Emit::count();
+
+        if (unit.opened && compilation.getSucceeded())
+        {
+            compilation.generate(tmFilepath(unit.path));
+            if (m_printReport)
+            {
+                compilation.printReport(diagnostics);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        // A walk it threw out of leaves its frames on this thread's stack, the compilation's diagnostics are gone with it
+        traverseStack().clear();
+        Emit emit(diagnostics);
+        Emit *previous = Emit::setUnit(&emit);
+        Emit::setFormat(m_format);
+        Emit::error("COMPILER", e.what());
+        Emit::count();
+        Emit::setUnit(previous);
+    }
+    unit.diagnostics = diagnostics.str();
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../Semantics/Emit.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Compiles many files at once, each in its own Compilation. Files are dealt
+// out to one work queue per thread; a thread takes from the back of its own
+// queue and steals from the front of the others once it runs dry. Every .tm
+// is written next to its source and the diagnostics are reported in the
+// order the files were given, whatever order they finished in.
+class Batch
+{
+    public:
+        Batch(const unsigned threadCount=0, const bool handScanner=false); // 0 threads sizes the pool to the machine
+
+        // Getters
+        size_t getFileCount() const { return m_units.size(); }
+        unsigned getThreadCount() const { return m_threadCount; }
+
+        // Setters
+        void setFormat(const Emit::Format format) { m_format = format; }     // Of every file's diagnostics
+        void setOptimize(const bool optimize) { m_optimize = optimize; }
+        void setPrintReport(const bool printReport) { m_printReport = printReport; }     // After each file's diagnostics
+        void setLowerIR(const bool lowerIR) { m_lowerIR = lowerIR; }     // Keeps each file's whole tree instead of streaming it
+        void setPrintIR(const bool printIR) { m_printIR = printIR; }
+
+        // Helpers
+        void add(const std::string &path);      // A source file, or every .c- file below a directory
+        bool compile(std::ostream &out);        // False if any file could not be opened
+
+        // Static
+        static std::string tmFilepath(const std::string &path);
+
+    private:
+        struct Unit
+        {
+            std::string path;
+            std::string diagnostics;
+            size_t lineCount;
+            bool opened;
+        };
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<size_t> units;
+        };
+
+        void work(const unsigned worker);
+        bool take(const unsigned worker, size_t &unit);
+        void compileUnit(Unit &unit);
+
+        unsigned m_threadCount;
+        bool m_handScanner;
+        Emit::Format m_format;
+        bool m_optimize;
+        bool m_printReport;
+        bool m_lowerIR;
+        bool m_printIR;
+        std::vector<Unit> m_units;
+        std::deque<Queue> m_queues;
+};
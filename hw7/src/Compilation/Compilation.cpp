@@ -0,0 +1,552 @@
+#include "Compilation.hpp"
+#include "Incremental.hpp"
+#include "../CodeGen/CodeGen.hpp"
+#include "../SyntaxError/SyntaxError.hpp"
+#include "../TokenData.hpp"
+#include "../c-.tab.h"
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+// From c-.l scanner
+extern int flexLex(YYSTYPE *yylval, void *scanner);
+extern void * scannerCreate(Compilation *compilation);
+extern void scannerRead(void *scanner, FILE *file);
+extern void scannerScanInPlace(void *scanner, char *base, size_t size);
+extern void scannerDestroy(void *scanner);
+
+Compilation::Current::Current(Compilation &compilation)
+{
+    m_arena = Arena::setUnit(&compilation.m_arena);
+    m_pool = NodePool::setUnit(&compilation.m_pool);
+    m_emit = Emit::setUnit(&compilation.m_emit);
+    s_depth++;
+}
+
+Compilation::Current::~Current()
+{
+    Arena::setUnit(m_arena);
+    NodePool::setUnit(m_pool);
+    Emit::setUnit(m_emit);
+
+    // A long-lived thread would otherwise keep every name and type it has ever compiled
+    if (--s_depth == 0)
+    {
+        Intern::reset();
+        Data::reset();
+    }
+}
+
+Compilation::Compilation(std::ostream &diagnostics) : m_emit(diagnostics), m_current(*this), m_file(nullptr), m_stream(stdin), m_sourceSize(0), m_handScanner(this), m_root(nullptr), m_lineCount(1), m_scanningInPlace(false), m_useHandScanner(false), m_loadSource(false), m_hasSyntaxError(false), m_streaming(false), m_semantics(&m_symTable, true), m_optimize(false), m_lowerIR(false), m_printIR(false), m_deferredEmit(diagnostics, &m_emit), m_codeGen(nullptr), m_body(nullptr), m_pending(nullptr), m_pendingLast(nullptr), m_pendingBody(nullptr), m_incremental(nullptr)
+{
+    SyntaxError::initErrorProcessing();
+    m_scanner = scannerCreate(this);
+}
+
+Compilation::~Compilation()
+{
+    // The tree and the tokens all live in the arenas, tokens and constants may point into the source
+    scannerDestroy(m_scanner);
+    m_root = nullptr;
+    m_pool.release();
+    m_arena.release();
+    m_source.release();
+    if (m_file != nullptr)
+    {
+        fclose(m_file);
+    }
+}
+
+Compilation::Result Compilation::compile(const std::string_view source)
+{
+    std::ostringstream diagnostics;
+    std::ostringstream code;
+
+    Result result;
+    {
+        Compilation compilation(diagnostics);
+        compilation.setStreaming(true);
+        compilation.setSource(source);
+        compilation.parse();
+        compilation.analyze();
+        Emit::count();
+
+        result.succeeded = compilation.getSucceeded();
+        if (result.succeeded)
+        {
+            compilation.generate(code);
+        }
+        result.errorCount = Emit::getErrorCount();
+        result.warnCount = Emit::getWarnCount();
+    }
+    result.tm = code.str();
+    result.diagnostics = diagnostics.str();
+    return result;
+}
+
+bool Compilation::open(const std::string &path)
+{
+    // A regular file is mapped, or loaded if told to, and scanned in place, anything else is streamed
+    if (m_loadSource ? m_source.load(path) : m_source.map(path))
+    {
+        m_sourceSize = m_source.getSize();
+        scanInPlace(m_source.getBuffer(), m_source.getBufferSize());
+        return true;
+    }
+
+    m_file = fopen(path.c_str(), "r");
+    if (m_file == nullptr)
+    {
+        return false;
+    }
+    stream(m_file);
+    return true;
+}
+
+void Compilation::setSource(const std::string_view source)
+{
+    // Keep a copy ending in the two NULs the scanner needs so it can be scanned in place
+    m_text.reserve(source.size() + 2);
+    m_text.assign(source);
+    m_text.append(2, '\0');
+    m_sourceSize = source.size();
+    scanInPlace(&m_text[0], m_text.size());
+}
+
+void Compilation::parse()
+{
+    if (m_streaming)
+    {
+        m_semantics.begin();
+        m_codeGen.setAllocateRegisters(m_optimize);
+        m_codeGen.setPeephole(m_optimize ? &m_peephole : nullptr);
+        m_codeGen.begin();
+    }
+
+    if (m_scanningInPlace)
+    {
+        yyparse(this);
+    }
+    else
+    {
+        push();
+    }
+    Emit::flush();
+}
+
+int Compilation::lex(TokenData *&tokenData)
+{
+    if (m_useHandScanner)
+    {
+        int tokenClass;
+        while ((tokenClass = m_handScanner.next(tokenData)) == 0 && refill())
+        {
+        }
+        return tokenClass;
+    }
+
+    YYSTYPE value;
+    value.tokenData = nullptr;
+    int tokenClass = flexLex(&value, m_scanner);
+    tokenData = value.tokenData;
+    return tokenClass;
+}
+
+void Compilation::declare(Node *decl)
+{
+    if (decl == nullptr)
+    {
+        return;
+    }
+
+    // The declaration is already in the program so what it inherits comes from the one before it
+    Node::evaluateAttributes(decl);
+
+    if (m_streaming && !m_hasSyntaxError)
+    {
+        compilePending();
+        m_pending = decl;
+        m_pendingLast = decl;
+        while (m_pendingLast->getSibling() != nullptr)
+        {
+            m_pendingLast = m_pendingLast->getSibling();
+        }
+        m_pendingBody = m_body;
+    }
+    m_body = nullptr;
+
+    if (m_declHandler)
+    {
+        m_declHandler(decl);
+    }
+}
+
+void Compilation::beginBody()
+{
+    if (!m_streaming)
+    {
+        return;
+    }
+
+    if (m_freeBodyArenas.empty())
+    {
+        m_bodyArenas.emplace_back();
+        m_freeBodyArenas.push_back(&m_bodyArenas.back());
+    }
+    m_body = m_freeBodyArenas.back();
+    m_freeBodyArenas.pop_back();
+    Arena::setUnit(m_body);
+}
+
+void Compilation::endBody()
+{
+    // The function node itself outlives its body
+    Arena::setUnit(&m_arena);
+}
+
+void Compilation::analyze()
+{
+    if (m_hasSyntaxError)
+    {
+        return;
+    }
+    if (!m_streaming)
+    {
+        m_semantics.analyze(m_root);
+        Emit::flush();
+        return;
+    }
+
+    compilePending();
+    Emit *emit = Emit::setUnit(&m_deferredEmit);
+    m_semantics.end(m_root);
+    Emit::setUnit(emit);
+
+    Emit::unit().append(m_deferredEmit);
+    Emit::flush();
+}
+
+void Compilation::compilePending()
+{
+    Node *decl = m_pending;
+    if (decl == nullptr)
+    {
+        return;
+    }
+    m_pending = nullptr;
+
+    // Passes walk a declaration's siblings, so the ones reduced after it are cut off until it is compiled
+    // A function is only recorded while the scanner has reported nothing, a misplaced character drops warnings on its line
+    Node::Index next = m_pendingLast->detachSibling();
+    bool record = m_incremental != nullptr && isFunc(decl) && m_pendingBody != nullptr && Emit::getErrorCount() == 0;
+    Emit *emit = Emit::setUnit(&m_deferredEmit);
+    bool keepBody = false;
+    size_t hash = record ? Incremental::hash((Func *)decl) : 0;
+    if (!record || !reuseFunc((Func *)decl, hash))
+    {
+        keepBody = compileDecl(decl, record, hash);
+    }
+    Emit::setUnit(emit);
+    m_pendingLast->attachSibling(next);
+
+    if (m_pendingBody == nullptr || keepBody)
+    {
+        return;
+    }
+
+    // Only the signature is left, the pool hands the body's indices to the functions after it
+    std::vector<Node::Index> indices;
+    traverse(decl->getChild(1), [&indices](Node *node)
+    {
+        indices.push_back(node->getIndex());
+        return true;
+    });
+    for (Node::Index index : indices)
+    {
+        m_pool.free(index);
+    }
+    decl->removeChild(1);
+    m_pendingBody->release();
+    m_freeBodyArenas.push_back(m_pendingBody);
+    m_pendingBody = nullptr;
+}
+
+bool Compilation::compileDecl(Node *decl, const bool record, const size_t hash)
+{
+    // Code is only worth generating while there have been no errors
+    size_t diagnosticCount = m_deferredEmit.getDiagnostics().size();
+    Incremental::Record funcRecord;
+    funcRecord.goffset = m_semantics.getGoffset();
+    m_semantics.analyzeDecl(decl);
+    funcRecord.goffsetEnd = m_semantics.getGoffset();
+
+    bool keepBody = false;
+    funcRecord.hasCode = Emit::getErrorCount() == 0;
+    if (funcRecord.hasCode)
+    {
+        if (m_optimize)
+        {
+            // Constants that replace nodes of the body go with it
+            Arena *arena = Arena::setUnit((m_pendingBody != nullptr) ? m_pendingBody : &m_arena);
+            m_optimizer.optimize(decl);
+            Arena::setUnit(arena);
+        }
+        size_t globalCount = m_codeGen.getGlobalCount();
+        m_codeGen.generateDecl(decl, record ? &funcRecord.code : nullptr);
+        keepBody = m_codeGen.getGlobalCount() != globalCount;   // Static locals are generated with the globals at the end
+    }
+    if (!record || keepBody)
+    {
+        return keepBody;
+    }
+
+    // The function's own redeclaration is reported again with its signature
+    Func *func = (Func *)decl;
+    const std::vector<Emit::Diagnostic> &diagnostics = m_deferredEmit.getDiagnostics();
+    if (func->getPrevDecl() != nullptr)
+    {
+        diagnosticCount++;
+    }
+    funcRecord.hash = hash;
+    funcRecord.dependencies = Incremental::dependencies(func);
+    funcRecord.diagnostics.assign(diagnostics.begin() + std::min(diagnosticCount, diagnostics.size()), diagnostics.end());
+    m_incremental->store(func, std::move(funcRecord), false);
+    return false;
+}
+
+bool Compilation::reuseFunc(Func *func, const size_t hash)
+{
+    // Only a function with string constants depends on where the globals end
+    const Incremental::Record *record = m_incremental->find(func, hash);
+    if (record == nullptr || (record->goffsetEnd != record->goffset && record->goffset != m_semantics.getGoffset()))
+    {
+        return false;
+    }
+
+    // Its code is only needed while there have been no errors, and then only fits where it was generated
+    unsigned errorCount = 0;
+    for (const Emit::Diagnostic &diagnostic : record->diagnostics)
+    {
+        errorCount += diagnostic.severity == Emit::Severity::Error;
+    }
+    bool generate = Emit::getErrorCount() == 0 && errorCount == 0;
+    if (generate && (!record->hasCode || !m_codeGen.fits(record->code)))
+    {
+        return false;
+    }
+
+    // Every name the body used must still mean what it did, its own name is not declared yet
+    for (const Incremental::Dependency &dependency : record->dependencies)
+    {
+        Decl *decl = m_semantics.lookup(dependency.name);
+        if (decl == nullptr && dependency.name == func->getNameHandle())
+        {
+            decl = func;
+        }
+        if (Incremental::fingerprint(decl) != dependency.fingerprint)
+        {
+            return false;
+        }
+    }
+
+    m_semantics.analyzeSignature(func);
+    for (const Emit::Diagnostic &diagnostic : record->diagnostics)
+    {
+        if (diagnostic.severity == Emit::Severity::Error)
+        {
+            Emit::error(diagnostic.lineNum, diagnostic.msg);
+        }
+        else
+        {
+            Emit::warn(diagnostic.lineNum, diagnostic.msg);
+        }
+    }
+    for (const Incremental::Dependency &dependency : record->dependencies)
+    {
+        Decl *decl = m_semantics.lookup(dependency.name);
+        if (decl != nullptr)
+        {
+            decl->makeUsed();
+        }
+    }
+    m_semantics.setGoffset(m_semantics.getGoffset() + record->goffsetEnd - record->goffset);
+    if (generate)
+    {
+        m_codeGen.emitBlock(record->code, func->getNameHandle());
+    }
+    m_incremental->store(func, *record, true);
+    return true;
+}
+
+void Compilation::scanInPlace(char *base, const size_t size)
+{
+    if (m_useHandScanner)
+    {
+        m_handScanner.scanInPlace(base, size);
+    }
+    else
+    {
+        scannerScanInPlace(m_scanner, base, size);
+    }
+    m_scanningInPlace = true;
+    m_stream = nullptr;
+}
+
+void Compilation::stream(FILE *file)
+{
+    // Flex reads the stream through its own buffer, the hand-written scanner is refilled from it
+    m_stream = file;
+    scannerRead(m_scanner, file);
+}
+
+bool Compilation::refill()
+{
+    // Hand the scanner the whole lines read so far, no token spans a newline so none is cut in two
+    if (m_stream == nullptr)
+    {
+        return false;
+    }
+
+    m_text.swap(m_carry);
+    m_carry.clear();
+    char chunk[s_chunkSize];
+    size_t count;
+    while ((count = SourceFile::read(m_stream, chunk, sizeof(chunk))) > 0)
+    {
+        m_sourceSize += count;
+        std::string_view data(chunk, count);
+        size_t newline = data.rfind('\n');
+        if (newline == std::string_view::npos)
+        {
+            m_text.append(data);
+            continue;
+        }
+        m_text.append(data.substr(0, newline + 1));
+        m_carry.assign(data.substr(newline + 1));
+        break;
+    }
+
+    if (count == 0)
+    {
+        m_stream = nullptr;
+    }
+    if (m_text.empty())
+    {
+        return false;
+    }
+    m_text.append(2, '\0');
+    m_handScanner.scanInPlace(m_text.data(), m_text.size());
+    return true;
+}
+
+void Compilation::push()
+{
+    // Each token goes to the parser as soon as it is scanned, so declarations are reduced while the stream is still arriving
+    // Freed even if compiling a declaration throws
+    std::unique_ptr<yypstate, void (*)(yypstate *)> state(yypstate_new(), yypstate_delete);
+    if (state == nullptr)
+    {
+        throw std::runtime_error("Compilation::push() - Unable to create parser");
+    }
+
+    int status = YYPUSH_MORE;
+    while (status == YYPUSH_MORE)
+    {
+        YYSTYPE value;
+        value.tokenData = nullptr;
+        int tokenClass = lex(value.tokenData);
+        status = yypush_parse(state.get(), tokenClass, &value, this);
+    }
+}
+
+void Compilation::printReport(std::ostream &out) const
+{
+    m_optimizer.printReport(out);
+    if (m_lowerIR)
+    {
+        m_liveness.printReport(out);
+    }
+    m_peephole.printReport(out);
+}
+
+IRProgram Compilation::buildIR()
+{
+    IRBuilder builder;
+    IRProgram program = builder.build(m_root);
+    if (m_optimize)
+    {
+        m_liveness.eliminate(program);
+    }
+    if (m_printIR)
+    {
+        // With the diagnostics, so a batch keeps each file's IR together
+        program.print(Emit::out());
+    }
+    return program;
+}
+
+void Compilation::generate(const std::string &tmPath)
+{
+    if (!m_streaming)
+    {
+        if (m_optimize)
+        {
+            m_optimizer.optimize(m_root);
+        }
+        if (m_lowerIR)
+        {
+            IRLower lower(tmPath);
+            lower.setPeephole(m_optimize ? &m_peephole : nullptr);
+            lower.generate(buildIR());
+            return;
+        }
+        CodeGen generator(m_root, tmPath);
+        generator.setAllocateRegisters(m_optimize);
+        generator.setPeephole(m_optimize ? &m_peephole : nullptr);
+        generator.generate();
+        return;
+    }
+    if (m_root == nullptr)
+    {
+        return;
+    }
+
+    std::ofstream code(tmPath);
+    if (!code)
+    {
+        throw std::runtime_error("Compilation::generate() - Unable to write " + tmPath);
+    }
+    generate(code);
+}
+
+void Compilation::generate(std::ostream &code)
+{
+    if (!m_streaming)
+    {
+        if (m_optimize)
+        {
+            m_optimizer.optimize(m_root);
+        }
+        if (m_lowerIR)
+        {
+            IRLower lower;
+            lower.setPeephole(m_optimize ? &m_peephole : nullptr);
+            lower.generate(buildIR(), code);
+            return;
+        }
+        CodeGen generator(m_root);
+        generator.setAllocateRegisters(m_optimize);
+        generator.setPeephole(m_optimize ? &m_peephole : nullptr);
+        generator.generate(code);
+        return;
+    }
+    if (m_root == nullptr)
+    {
+        return;
+    }
+
+    m_codeGen.end();
+    m_codeGen.write(code);
+}
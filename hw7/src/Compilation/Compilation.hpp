@@ -0,0 +1,185 @@
+#pragma once
+
+#include "../Arena/Arena.hpp"
+#include "../CodeGen/CodeGen.hpp"
+#include "../IR/IRBuilder.hpp"
+#include "../IR/IRLower.hpp"
+#include "../IR/Liveness.hpp"
+#include "../Optimizer/Optimizer.hpp"
+#include "../Optimizer/Peephole.hpp"
+#include "../Scanner/Scanner.hpp"
+#include "../Semantics/Emit.hpp"
+#include "../Semantics/Semantics.hpp"
+#include "../Semantics/SymTable.hpp"
+#include "../Source/SourceFile.hpp"
+#include "../Tree/NodePool.hpp"
+#include "../Tree/Tree.hpp"
+
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <stdio.h>
+#include <string>
+#include <string_view>
+
+class Incremental;
+
+// Everything one translation unit needs from source to TM code: its scanner,
+// the arena and node pool holding its tree, its diagnostics, symbol table and
+// analysis. A compilation is the current unit of the thread that creates it
+// for as long as it lives, so compilations on different threads never share
+// state and any number of them can run at once. A file is parsed in place; a
+// stream, stdin unless given a file or source, is parsed as it arrives by
+// pushing tokens into the parser, and each top-level declaration is handed
+// on as soon as it is reduced.
+//
+// A streaming compilation analyzes and generates each declaration while the
+// rest is still being parsed. A function body lives in an arena of its own
+// that is released once the function is compiled, leaving only its
+// signature, so memory grows with the largest function rather than the
+// program. Its diagnostics are held back until parsing is done and come out
+// exactly as analyze() would have printed them. Given an Incremental, it
+// reuses the functions that have not changed since the compile before.
+//
+// Told to optimize, it folds and propagates constants in each function
+// between analysis and code generation, see Optimizer, and removes
+// redundant instructions from the code, see Peephole. Told to lower through
+// the IR, it builds the whole program's IR, see IRBuilder, and generates
+// code from that instead of from the tree, see IRLower, after removing the
+// IR's dead code when optimizing, see Liveness.
+class Compilation
+{
+    public:
+        struct Result
+        {
+            bool succeeded;
+            std::string tm;                 // The TM program, empty unless succeeded
+            std::string diagnostics;        // Everything the compiler would print, counts included
+            unsigned errorCount;
+            unsigned warnCount;
+        };
+
+        Compilation(std::ostream &diagnostics=std::cout);
+        Compilation(const Compilation &) = delete;
+        Compilation & operator=(const Compilation &) = delete;
+        ~Compilation();
+
+        // Static
+        static Result compile(const std::string_view source);
+
+        // Getters
+        Node * getRoot() const { return m_root; }
+        bool getHasSyntaxError() const { return m_hasSyntaxError; }
+        bool getSucceeded() const { return !m_hasSyntaxError && !Emit::getErrorCount(); }
+        int getLineCount() const { return m_lineCount; }
+        std::string_view getLastToken() const { return m_lastToken; }
+        bool getScanningInPlace() const { return m_scanningInPlace; }
+        size_t getSourceSize() const { return m_sourceSize; }      // 0 while flex reads a stream
+        bool getUseHandScanner() const { return m_useHandScanner; }
+        Scanner & getHandScanner() { return m_handScanner; }
+        SymTable & getSymTable() { return m_symTable; }
+        Semantics & getSemantics() { return m_semantics; }
+        const Optimizer & getOptimizer() const { return m_optimizer; }
+        const Peephole & getPeephole() const { return m_peephole; }
+        const Liveness & getLiveness() const { return m_liveness; }
+        const Arena & getArena() const { return m_arena; }
+        const std::deque<Arena> & getBodyArenas() const { return m_bodyArenas; }      // Each reused by one function body after another while streaming
+
+        // Setters
+        void setRoot(Node *root) { m_root = root; }
+        void setHasSyntaxError(const bool hasSyntaxError) { m_hasSyntaxError = hasSyntaxError; }
+        void setLastToken(const std::string_view lastToken) { m_lastToken = lastToken; }
+        void setUseHandScanner(const bool useHandScanner) { m_useHandScanner = useHandScanner; }    // Before the source is given
+        void setLoadSource(const bool loadSource) { m_loadSource = loadSource; }                     // Read the file rather than map it, before open()
+        void setStreaming(const bool streaming) { m_streaming = streaming; }                         // Before parsing
+        void setIncremental(Incremental *incremental) { m_incremental = incremental; }            // Before parsing, only while streaming
+        void setOptimize(const bool optimize) { m_optimize = optimize; }                             // Before parsing
+        void setLowerIR(const bool lowerIR) { m_lowerIR = lowerIR; }                                 // Not while streaming
+        void setPrintIR(const bool printIR) { m_printIR = printIR; }
+        void setDeclHandler(const std::function<void(Node *)> &declHandler) { m_declHandler = declHandler; }
+        void incLineCount() { m_lineCount++; }
+
+        // Helpers
+        bool open(const std::string &path);         // False if path could not be opened, stdin is read otherwise
+        void setSource(const std::string_view source);
+        void parse();
+        int lex(TokenData *&tokenData);             // The next token from whichever scanner is in use
+        void declare(Node *decl);                   // Called by the parser as each top-level declaration is reduced
+        void beginBody();                           // Called by the parser around each function body
+        void endBody();
+        void analyze();
+        void generate(const std::string &tmPath);
+        void generate(std::ostream &code);
+
+        // Print
+        void printReport(std::ostream &out=std::cout) const;      // What each optimization did, once generated
+
+    private:
+        void scanInPlace(char *base, const size_t size);
+        void stream(FILE *file);
+        bool refill();
+        void push();
+        void compilePending();
+        bool compileDecl(Node *decl, const bool record, const size_t hash);      // True if the body has to be kept
+        bool reuseFunc(Func *func, const size_t hash);
+        IRProgram buildIR();                        // Without dead code if optimizing, printed if told to
+
+        // Makes a compilation the unit of its thread, restoring the previous one when it ends.
+        // Once the last one on the thread ends, the thread's own names and types are emptied.
+        class Current
+        {
+            public:
+                Current(Compilation &compilation);
+                ~Current();
+
+            private:
+                Arena *m_arena;
+                NodePool *m_pool;
+                Emit *m_emit;
+
+                inline static thread_local unsigned s_depth = 0;    // Compilations alive on this thread
+        };
+
+        Emit m_emit;
+        Arena m_arena;
+        NodePool m_pool;
+        Current m_current;
+        SourceFile m_source;
+        std::string m_text;
+        FILE *m_file;
+        FILE *m_stream;                             // Read a chunk at a time, null once exhausted or scanning in place
+        std::string m_carry;                        // The partial line at the end of the last chunk
+        size_t m_sourceSize;
+        void *m_scanner;
+        Scanner m_handScanner;
+        Node *m_root;
+        int m_lineCount;
+        std::string_view m_lastToken;
+        bool m_scanningInPlace;
+        bool m_useHandScanner;
+        bool m_loadSource;
+        bool m_hasSyntaxError;
+        bool m_streaming;
+        std::function<void(Node *)> m_declHandler;
+        SymTable m_symTable;
+        Semantics m_semantics;
+        Optimizer m_optimizer;
+        Peephole m_peephole;
+        Liveness m_liveness;
+        bool m_optimize;
+        bool m_lowerIR;
+        bool m_printIR;
+
+        // Streaming
+        Emit m_deferredEmit;                        // Semantic diagnostics, held back until parsing is done
+        CodeGen m_codeGen;
+        std::deque<Arena> m_bodyArenas;
+        std::vector<Arena *> m_freeBodyArenas;
+        Arena *m_body;                              // The arena of the body being parsed, or of the function just reduced
+        Node *m_pending;                            // Compiled once the declaration after it is reduced, its last line is fully scanned by then
+        Node *m_pendingLast;                        // Its last sibling, the declarations reduced since follow it
+        Arena *m_pendingBody;
+        Incremental *m_incremental;
+
+        static const size_t s_chunkSize = 64 * 1024;         // The most a stream is read ahead of the scanner
+};
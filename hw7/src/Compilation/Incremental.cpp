@@ -0,0 +1,196 @@
+#include "Incremental.hpp"
+#include "Compilation.hpp"
+#include "../Semantics/Is.hpp"
+#include "../Tree/Traverse.hpp"
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <system_error>
+#include <thread>
+
+Incremental::Incremental(const bool handScanner) : m_handScanner(handScanner), m_format(Emit::Format::Text), m_optimize(false), m_printReport(false), m_funcCount(0), m_reusedCount(0) {}
+
+bool Incremental::compile(const std::string &path, const std::string &tmPath, std::ostream &out)
+{
+    // The records keep names from one compile to the next, while the thread's own table is emptied after each
+    Intern::Table *previousNames = Intern::setTable(&m_names);
+    bool opened = run(path, tmPath, out);
+    Intern::setTable(previousNames);
+    return opened;
+}
+
+bool Incremental::run(const std::string &path, const std::string &tmPath, std::ostream &out)
+{
+    // Only the functions of the compile before this one can be reused, a record not reused or replaced is dropped
+    m_previous.swap(m_records);
+    m_records.clear();
+    m_funcCount = 0;
+    m_reusedCount = 0;
+
+    Compilation compilation(out);
+    Emit::setFormat(m_format);
+    compilation.setUseHandScanner(m_handScanner);
+    compilation.setOptimize(m_optimize);
+    compilation.setLoadSource(true);            // An editor may truncate the file while it is scanned
+    compilation.setStreaming(true);
+    compilation.setIncremental(this);
+    if (!compilation.open(path))
+    {
+        Emit::error("ARGLIST", "source file \"" + path + "\" could not be opened.");
+        Emit::count();
+        return false;
+    }
+    compilation.parse();
+    compilation.analyze();
+    Emit::count();
+
+    if (compilation.getSucceeded())
+    {
+        compilation.generate(tmPath);
+        if (m_printReport)
+        {
+            compilation.printReport(out);
+        }
+    }
+    return true;
+}
+
+void Incremental::watch(const std::string &path, const std::string &tmPath, std::ostream &out)
+{
+    // A file is compiled again once its time or size changes, a missing file is reported once and waited for
+    namespace fs = std::filesystem;
+    fs::file_time_type lastTime;
+    uintmax_t lastSize = 0;
+    bool first = true;
+    while (true)
+    {
+        std::error_code error;
+        fs::file_time_type time = fs::last_write_time(path, error);
+        uintmax_t size = error ? 0 : fs::file_size(path, error);
+        if (first || time != lastTime || size != lastSize)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (compile(path, tmPath, out))
+            {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                out << "Reused " << m_reusedCount << " of " << m_funcCount << " functions in " << std::fixed << std::setprecision(3) << elapsed.count() << "s" << std::defaultfloat << std::endl;
+            }
+            first = false;
+            lastTime = time;
+            lastSize = size;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(s_pollMilliseconds));
+    }
+}
+
+const Incremental::Record * Incremental::find(const Func *func, const size_t hash) const
+{
+    auto record = m_previous.find(func->getNameHandle());
+    if (record == m_previous.end() || record->second.hash != hash)
+    {
+        return nullptr;
+    }
+    return &record->second;
+}
+
+void Incremental::store(const Func *func, Record record, const bool reused)
+{
+    m_funcCount++;
+    if (reused)
+    {
+        m_reusedCount++;
+    }
+    m_records[func->getNameHandle()] = std::move(record);
+}
+
+size_t Incremental::hash(const Func *func)
+{
+    // Lines are hashed as they are, a function whose lines moved reports its diagnostics on other lines
+    // A node prints without its size, which is an array's length
+    size_t hash = 0;
+    std::hash<std::string> hashString;
+    auto combine = [&hash](const size_t value)
+    {
+        hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    };
+    traverse((Node *)func, [&](Node *node, const TraversePosition &position)
+    {
+        combine(hashString(node->stringify()));
+        combine(node->getLineNum());
+        combine(node->getMemSize());
+        combine(position.depth);
+        combine(position.childIndex);
+        combine(position.siblingIndex);
+        return true;
+    });
+    return hash;
+}
+
+std::string Incremental::fingerprint(const Decl *decl)
+{
+    // Everything a body's analysis and code read from a declaration outside it
+    if (decl == nullptr)
+    {
+        return "";
+    }
+
+    std::string fingerprint = decl->stringifyWithType() + " " + std::to_string(decl->getLineNum());
+    if (isFunc(decl))
+    {
+        for (const Node *parm : ((const Func *)decl)->getParms())
+        {
+            fingerprint += ", " + parm->stringifyWithType();
+        }
+    }
+    else
+    {
+        fingerprint += " " + decl->getMemStr();
+    }
+    return fingerprint;
+}
+
+std::vector<Incremental::Dependency> Incremental::dependencies(const Func *func)
+{
+    // Every name the body used that is not its own, each once
+    std::vector<Dependency> dependencies;
+    traverse((Node *)func, [&dependencies](Node *node)
+    {
+        Intern::Handle name;
+        const Decl *decl;
+        if (isId(node))
+        {
+            name = ((Id *)node)->getNameHandle();
+            decl = ((Id *)node)->getDecl();
+        }
+        else if (isCall(node))
+        {
+            name = ((Call *)node)->getNameHandle();
+            decl = ((Call *)node)->getDecl();
+        }
+        else
+        {
+            return true;
+        }
+
+        if (decl != nullptr)
+        {
+            Node::MemScope memScope = decl->getMemScope();
+            if (memScope == Node::MemScope::Local || memScope == Node::MemScope::LocalStatic || memScope == Node::MemScope::Parameter)
+            {
+                return true;
+            }
+        }
+        for (const Dependency &dependency : dependencies)
+        {
+            if (dependency.name == name)
+            {
+                return true;
+            }
+        }
+        dependencies.push_back({name, fingerprint(decl)});
+        return true;
+    });
+    return dependencies;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../CodeGen/CodeGen.hpp"
+#include "../Intern/Intern.hpp"
+#include "../Semantics/Emit.hpp"
+#include "../Tree/Tree.hpp"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compiles a file again and again as it is edited, reusing each function that
+// has not changed since the last compile. A function compiled while streaming
+// leaves a record of its tree's hash, the globals and functions its body used
+// as they were declared then, its diagnostics and its code. Next time, a
+// function whose tree hashes the same, whose dependencies are declared the
+// same way and whose strings would land where they did only has its signature
+// analyzed; its diagnostics are reported again and its code is copied in with
+// its calls relinked. Any other function is compiled as usual. The output is
+// the same as a fresh compile's.
+class Incremental
+{
+    public:
+        struct Dependency
+        {
+            Intern::Handle name;
+            std::string fingerprint;                // Empty if the name was not declared
+        };
+
+        struct Record
+        {
+            size_t hash;
+            std::vector<Dependency> dependencies;
+            std::vector<Emit::Diagnostic> diagnostics;  // Of its parameters and body, not its own declaration
+            int goffset;                            // The global offsets of its string constants
+            int goffsetEnd;
+            bool hasCode;
+            CodeGen::Block code;
+        };
+
+        Incremental(const bool handScanner=false);
+
+        // Getters
+        unsigned getFuncCount() const { return m_funcCount; }      // Of the last compile
+        unsigned getReusedCount() const { return m_reusedCount; }
+
+        // Setters
+        void setFormat(const Emit::Format format) { m_format = format; }     // Of the diagnostics of every compile
+        void setOptimize(const bool optimize) { m_optimize = optimize; }
+        void setPrintReport(const bool printReport) { m_printReport = printReport; }     // After each compile's diagnostics
+
+        // Helpers
+        bool compile(const std::string &path, const std::string &tmPath, std::ostream &out);  // False if path could not be opened
+        void watch(const std::string &path, const std::string &tmPath, std::ostream &out);    // Compile path whenever it changes, never returns
+
+        // Used by Compilation for each function it compiles
+        const Record * find(const Func *func, const size_t hash) const;    // The record of the last compile's function of that name, if hash matches
+        void store(const Func *func, Record record, const bool reused);
+
+        // Static
+        static size_t hash(const Func *func);
+        static std::string fingerprint(const Decl *decl);
+        static std::vector<Dependency> dependencies(const Func *func);
+
+    private:
+        bool m_handScanner;
+        Emit::Format m_format;
+        bool m_optimize;
+        bool m_printReport;
+        std::unordered_map<Intern::Handle, Record> m_records;      // Of the compile running now
+        std::unordered_map<Intern::Handle, Record> m_previous;     // Of the one before
+        unsigned m_funcCount;
+        unsigned m_reusedCount;
+        Intern::Table m_names;                      // Of every compile, the records keep its handles
+
+        bool run(const std::string &path, const std::string &tmPath, std::ostream &out);
+
+        inline static const unsigned s_pollMilliseconds = 100;     // Defined inline, milliseconds() takes it by reference
+};
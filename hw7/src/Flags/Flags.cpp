@@ -3,7 +3,7 @@
 
 #include "ourgetopt/ourgetopt.hpp"
 
-Flags::Flags() : m_debug(false), m_symTableDebug(false), m_printSyntaxTree(false), m_printSyntaxTreeWithTypes(false), m_printSyntaxTreeWithMem(false) {}
+Flags::Flags() : m_debug(false), m_symTableDebug(false), m_printSyntaxTree(false), m_printSyntaxTreeWithTypes(false), m_printSyntaxTreeWithMem(false), m_printArenaStats(false), m_batch(false), m_threadCount(0), m_handScanner(false), m_printTokens(false), m_printScanSpeed(false), m_jsonDiagnostics(false), m_watch(false), m_optimize(false), m_printOptimizerReport(false), m_lowerIR(false), m_printIR(false) {}
 
 Flags::Flags(int argc, char *argv[])
 {
@@ -20,7 +20,7 @@ Flags::Flags(int argc, char *argv[])
     while (true)
     {
         // Hunt for a string of options
-        while ((flag = ourGetopt(argc, argv, (char *)"hdDpPM")) != EOF)
+        while ((flag = ourGetopt(argc, argv, (char *)"hdDpPMAbj:stTJwORIG")) != EOF)
         {
             switch (flag)
             {
@@ -42,6 +42,42 @@ Flags::Flags(int argc, char *argv[])
                 case 'M':
                     m_printSyntaxTreeWithMem = true;
                     break;
+                case 'A':
+                    m_printArenaStats = true;
+                    break;
+                case 'b':
+                    m_batch = true;
+                    break;
+                case 'j':
+                    m_threadCount = atoi(optarg);
+                    break;
+                case 's':
+                    m_handScanner = true;
+                    break;
+                case 't':
+                    m_printTokens = true;
+                    break;
+                case 'T':
+                    m_printScanSpeed = true;
+                    break;
+                case 'J':
+                    m_jsonDiagnostics = true;
+                    break;
+                case 'w':
+                    m_watch = true;
+                    break;
+                case 'O':
+                    m_optimize = true;
+                    break;
+                case 'R':
+                    m_printOptimizerReport = true;
+                    break;
+                case 'I':
+                    m_lowerIR = true;
+                    break;
+                case 'G':
+                    m_printIR = true;
+                    break;
                 default:
                     errorFlag = true;
             }
@@ -64,6 +100,7 @@ Flags::Flags(int argc, char *argv[])
             if (optind < argc)
             {
                 m_filepath = argv[optind];
+                m_filepaths.push_back(m_filepath);
                 optind++;
             }
             else
@@ -76,6 +113,12 @@ Flags::Flags(int argc, char *argv[])
 
 std::string Flags::getFileBase() const
 {
+    // A program read from stdin is named after it
+    if (m_filepath.empty())
+    {
+        return "stdin";
+    }
+
     std::string base = m_filepath;
     base.erase(base.size() - 3);
     while (base.find("/") != std::string::npos)
@@ -92,6 +135,11 @@ std::string Flags::getTmFilename() const
 
 std::string Flags::getTmFilepath() const
 {
+    if (m_filepath.empty())
+    {
+        return getTmFilename();
+    }
+
     std::string base = m_filepath;
     base.erase(base.size() - 3);
     return base + ".tm";
@@ -104,11 +152,24 @@ void Flags::resetAll()
     m_printSyntaxTree = false;             // -p
     m_printSyntaxTreeWithTypes = false;    // -P
     m_printSyntaxTreeWithMem = false;      // -M
+    m_printArenaStats = false;             // -A
+    m_batch = false;                       // -b
+    m_threadCount = 0;                     // -j
+    m_handScanner = false;                 // -s
+    m_printTokens = false;                 // -t
+    m_printScanSpeed = false;              // -T
+    m_jsonDiagnostics = false;             // -J
+    m_watch = false;                       // -w
+    m_optimize = false;                    // -O
+    m_printOptimizerReport = false;        // -R
+    m_lowerIR = false;                     // -I
+    m_printIR = false;                     // -G
 }
 
 void Flags::emitHelp()
 {
     std::cout << "usage: ./c- [options] [sourcefile]" << std::endl;
+    std::cout << "       ./c- -b [-j threads] sourcefile|directory ..." << std::endl;
     std::cout << "options:" << std::endl;
     std::cout << "-h: \t - print this usage message" << std::endl;
     std::cout << "-d: \t - turn on parser debugging" << std::endl;
@@ -116,4 +177,16 @@ void Flags::emitHelp()
     std::cout << "-p: \t - print the abstract syntax tree" << std::endl;
     std::cout << "-P: \t - print the abstract syntax tree plus type information" << std::endl;
     std::cout << "-M: \t - print the abstract syntax tree plus type and memory information" << std::endl;
+    std::cout << "-A: \t - print arena allocation statistics, of the main and body arenas" << std::endl;
+    std::cout << "-b: \t - compile every file given, and every .c- file below each directory given, in parallel" << std::endl;
+    std::cout << "-j: \t - number of threads for -b, defaults to one per core; without -b, check function bodies on that many threads" << std::endl;
+    std::cout << "-s: \t - scan with the hand-written scanner instead of flex" << std::endl;
+    std::cout << "-t: \t - only scan, printing every token" << std::endl;
+    std::cout << "-T: \t - only scan, printing the scanner's throughput" << std::endl;
+    std::cout << "-J: \t - print diagnostics as JSON, one object per line" << std::endl;
+    std::cout << "-w: \t - compile sourcefile again whenever it changes, reusing the functions that did not" << std::endl;
+    std::cout << "-O: \t - fold and propagate constants, evaluate expressions in registers and remove redundant instructions; with -I, also remove dead stores, unused values and unreachable code" << std::endl;
+    std::cout << "-R: \t - with -O, print how many expressions were folded, constants propagated and dead instructions removed, and each function\'s instructions before and after" << std::endl;
+    std::cout << "-I: \t - generate code through the three-address IR instead of straight from the tree" << std::endl;
+    std::cout << "-G: \t - with -I, print each function\'s IR with its blocks, predecessors and dominators" << std::endl;
 }
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 class Flags
 {
@@ -11,11 +12,24 @@ class Flags
 
         // Getters
         std::string getFilepath() const { return m_filepath; }
+        const std::vector<std::string> & getFilepaths() const { return m_filepaths; }
         bool getDebug() const { return m_debug; }
         bool getSymTableDebug() const { return m_symTableDebug; }
         bool getPrintSyntaxTree() const { return m_printSyntaxTree; }
         bool getPrintSyntaxTreeWithTypes() const { return m_printSyntaxTreeWithTypes; }
         bool getPrintSyntaxTreeWithMem() const { return m_printSyntaxTreeWithMem; }
+        bool getPrintArenaStats() const { return m_printArenaStats; }
+        bool getBatch() const { return m_batch; }
+        bool getHandScanner() const { return m_handScanner; }
+        bool getPrintTokens() const { return m_printTokens; }
+        bool getPrintScanSpeed() const { return m_printScanSpeed; }
+        bool getJsonDiagnostics() const { return m_jsonDiagnostics; }
+        bool getWatch() const { return m_watch; }
+        bool getOptimize() const { return m_optimize; }
+        bool getPrintOptimizerReport() const { return m_printOptimizerReport; }
+        bool getLowerIR() const { return m_lowerIR; }
+        bool getPrintIR() const { return m_printIR; }
+        unsigned getThreadCount() const { return m_threadCount; }
         std::string getFileBase() const;
         std::string getTmFilename() const;
         std::string getTmFilepath() const;
@@ -25,9 +39,22 @@ class Flags
         void emitHelp();
 
         std::string m_filepath;
+        std::vector<std::string> m_filepaths;
         bool m_debug;                       // -d
         bool m_symTableDebug;               // -D
         bool m_printSyntaxTree;             // -p
         bool m_printSyntaxTreeWithTypes;    // -P
         bool m_printSyntaxTreeWithMem;      // -M
+        bool m_printArenaStats;             // -A
+        bool m_batch;                       // -b
+        unsigned m_threadCount;             // -j
+        bool m_handScanner;                 // -s
+        bool m_printTokens;                 // -t
+        bool m_printScanSpeed;              // -T
+        bool m_jsonDiagnostics;             // -J
+        bool m_watch;                       // -w
+        bool m_optimize;                    // -O
+        bool m_printOptimizerReport;        // -R
+        bool m_lowerIR;                     // -I
+        bool m_printIR;                     // -G
 };
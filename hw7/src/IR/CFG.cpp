@@ -0,0 +1,146 @@
+#include "CFG.hpp"
+
+#include <stdexcept>
+
+void CFG::build(IRFunc &func)
+{
+    link(func);
+    order(func);
+    dominators(func);
+}
+
+bool CFG::dominates(const IRFunc &func, int dominator, int block)
+{
+    // Up the tree from block, an unreachable block is dominated by nothing
+    if (block != 0 && func.blocks[block].idom == -1)
+    {
+        return false;
+    }
+    while (block != dominator && block != 0)
+    {
+        block = func.blocks[block].idom;
+    }
+    return block == dominator;
+}
+
+std::vector<int> CFG::successors(const IRBlock &block)
+{
+    if (block.instrs.empty() || !block.instrs.back().getIsTerminator())
+    {
+        throw std::runtime_error("CFG::successors() - Block does not end in a terminator");
+    }
+
+    const IRInstr &last = block.instrs.back();
+    switch (last.kind)
+    {
+        case IRInstr::Kind::Jump:
+            return {last.target};
+        case IRInstr::Kind::Branch:
+            if (last.target == last.other)
+            {
+                return {last.target};
+            }
+            return {last.target, last.other};
+        default:
+            return {};
+    }
+}
+
+void CFG::link(IRFunc &func)
+{
+    for (IRBlock &block : func.blocks)
+    {
+        block.preds.clear();
+    }
+    for (size_t i = 0; i < func.blocks.size(); i++)
+    {
+        func.blocks[i].succs = successors(func.blocks[i]);
+        for (int succ : func.blocks[i].succs)
+        {
+            func.blocks[succ].preds.push_back(i);
+        }
+    }
+}
+
+void CFG::order(IRFunc &func)
+{
+    // Postorder without recursion, a block is finished once its last successor is
+    std::vector<int> postorder;
+    std::vector<bool> visited(func.blocks.size(), false);
+    std::vector<std::pair<int, size_t>> stack = {{0, 0}};
+    visited[0] = true;
+    while (!stack.empty())
+    {
+        auto &[block, next] = stack.back();
+        const std::vector<int> &succs = func.blocks[block].succs;
+        if (next < succs.size())
+        {
+            int succ = succs[next++];
+            if (!visited[succ])
+            {
+                visited[succ] = true;
+                stack.push_back({succ, 0});
+            }
+            continue;
+        }
+        postorder.push_back(block);
+        stack.pop_back();
+    }
+    func.order.assign(postorder.rbegin(), postorder.rend());
+}
+
+void CFG::dominators(IRFunc &func)
+{
+    std::vector<int> position(func.blocks.size(), -1);
+    for (size_t i = 0; i < func.order.size(); i++)
+    {
+        position[func.order[i]] = i;
+    }
+    for (IRBlock &block : func.blocks)
+    {
+        block.idom = -1;
+    }
+
+    // The entry stands as its own dominator while the others settle
+    func.blocks[0].idom = 0;
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 1; i < func.order.size(); i++)
+        {
+            int block = func.order[i];
+            int idom = -1;
+            for (int pred : func.blocks[block].preds)
+            {
+                if (func.blocks[pred].idom == -1)
+                {
+                    continue;
+                }
+                idom = (idom == -1) ? pred : intersect(func, position, pred, idom);
+            }
+            if (idom != func.blocks[block].idom)
+            {
+                func.blocks[block].idom = idom;
+                changed = true;
+            }
+        }
+    }
+    func.blocks[0].idom = -1;
+}
+
+int CFG::intersect(const IRFunc &func, const std::vector<int> &position, int a, int b)
+{
+    while (a != b)
+    {
+        while (position[a] > position[b])
+        {
+            a = func.blocks[a].idom;
+        }
+        while (position[b] > position[a])
+        {
+            b = func.blocks[b].idom;
+        }
+    }
+    return a;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "IR.hpp"
+
+#include <vector>
+
+// The control-flow graph of a function's blocks and its dominator tree. The
+// edges come from each block's terminator; the immediate dominators are found
+// by iterating over the reachable blocks in reverse postorder until they
+// settle (Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm").
+class CFG
+{
+    public:
+        // Static
+        static void build(IRFunc &func);       // Fill in succs, preds, order and idom again
+        static bool dominates(const IRFunc &func, int dominator, int block);
+        static std::vector<int> successors(const IRBlock &block);
+
+    private:
+        static void link(IRFunc &func);
+        static void order(IRFunc &func);
+        static void dominators(IRFunc &func);
+        static int intersect(const IRFunc &func, const std::vector<int> &position, int a, int b);
+};
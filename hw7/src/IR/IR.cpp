@@ -0,0 +1,201 @@
+#include "IR.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+static std::string regString(const int reg)
+{
+    return "v" + std::to_string(reg);
+}
+
+static std::string blockString(const int block)
+{
+    return "bb" + std::to_string(block);
+}
+
+static std::string typeString(const IRType type)
+{
+    switch (type)
+    {
+        case IRType::Int:
+            return "int";
+        case IRType::Bool:
+            return "bool";
+        case IRType::Char:
+            return "char";
+        default:
+            return "addr";
+    }
+}
+
+static std::string slotString(const IRInstr::Base base, const int offset)
+{
+    return std::string(base == IRInstr::Base::Global ? "gp" : "fp") + "[" + std::to_string(offset) + "]";
+}
+
+static std::string lower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+std::vector<int> IRInstr::getUses() const
+{
+    std::vector<int> uses;
+    if (lhs != -1)
+    {
+        uses.push_back(lhs);
+    }
+    if (rhs != -1)
+    {
+        uses.push_back(rhs);
+    }
+    uses.insert(uses.end(), args.begin(), args.end());
+    return uses;
+}
+
+bool IRInstr::getHasSideEffects() const
+{
+    // TM stops on a zero divisor, and every ? moves the random sequence on
+    switch (kind)
+    {
+        case Kind::Binary:
+            return (op == "DIV" || op == "MOD") && !(immediate && value != 0);
+        case Kind::Unary:
+            return op == "RND";
+        case Kind::Store:
+        case Kind::StoreAt:
+        case Kind::ArrayCopy:
+        case Kind::Call:
+        case Kind::Return:
+        case Kind::Jump:
+        case Kind::Branch:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::string IRInstr::stringify() const
+{
+    std::ostringstream out;
+    if (dest != -1)
+    {
+        out << regString(dest) << ":" << typeString(type) << " = ";
+    }
+
+    switch (kind)
+    {
+        case Kind::Const:
+            out << "const " << value;
+            break;
+        case Kind::Addr:
+            out << "addr " << slotString(base, offset);
+            break;
+        case Kind::Load:
+            out << "load " << slotString(base, offset);
+            break;
+        case Kind::Store:
+            out << "store " << slotString(base, offset) << ", " << regString(lhs);
+            break;
+        case Kind::LoadAt:
+            out << "load [" << regString(lhs) << (offset < 0 ? "" : "+") << offset << "]";
+            break;
+        case Kind::StoreAt:
+            out << "store [" << regString(lhs) << (offset < 0 ? "" : "+") << offset << "], " << regString(rhs);
+            break;
+        case Kind::Binary:
+            out << lower(op) << " " << regString(lhs) << ", " << (immediate ? std::to_string(value) : regString(rhs));
+            break;
+        case Kind::Unary:
+            out << lower(op) << " " << regString(lhs);
+            break;
+        case Kind::ArrayCopy:
+            out << "copy " << regString(lhs) << ", " << regString(rhs);
+            break;
+        case Kind::ArrayCompare:
+            out << "compare." << lower(op) << " " << regString(lhs) << ", " << regString(rhs);
+            break;
+        case Kind::Call:
+        {
+            out << "call " << Intern::string(func) << "(";
+            for (size_t i = 0; i < args.size(); i++)
+            {
+                out << (i == 0 ? "" : ", ") << regString(args[i]);
+            }
+            out << ")";
+            break;
+        }
+        case Kind::Return:
+            out << "return";
+            if (lhs != -1)
+            {
+                out << " " << regString(lhs);
+            }
+            else if (immediate)
+            {
+                out << " " << value;
+            }
+            break;
+        case Kind::Jump:
+            out << "jump " << blockString(target);
+            break;
+        case Kind::Branch:
+            out << "branch " << regString(lhs) << ", " << blockString(target) << ", " << blockString(other);
+            break;
+    }
+
+    if (!comment.empty())
+    {
+        out << "  ; " << comment;
+    }
+    return out.str();
+}
+
+void IRFunc::print(std::ostream &out) const
+{
+    out << "func " << (name == Intern::None ? std::string("init") : Intern::string(name)) << " (" << regCount << " registers, frame ends at " << frameEnd << ")" << std::endl;
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        const IRBlock &block = blocks[i];
+        out << blockString(i) << ":";
+        if (!block.preds.empty())
+        {
+            out << "  preds";
+            for (int pred : block.preds)
+            {
+                out << " " << blockString(pred);
+            }
+        }
+        if (block.idom != -1)
+        {
+            out << "  idom " << blockString(block.idom);
+        }
+        else if (i != 0)
+        {
+            out << "  unreachable";
+        }
+        out << std::endl;
+
+        for (const IRInstr &instr : block.instrs)
+        {
+            out << "    " << instr.stringify() << std::endl;
+        }
+    }
+}
+
+void IRProgram::print(std::ostream &out) const
+{
+    for (const auto &[offset, string] : strings)
+    {
+        out << "string " << offset << " \"" << string << "\"" << std::endl;
+    }
+    out << "globals end at " << goffset << std::endl;
+    init.print(out);
+    for (const IRFunc &func : funcs)
+    {
+        out << std::endl;
+        func.print(out);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../Intern/Intern.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A linear three-address code between analysis and TM. Values live in
+// virtual registers, each assigned by exactly one instruction and typed by
+// what it holds; variables stay in the frame and global slots analysis gave
+// them and are only reached through explicit loads and stores. A function is
+// a list of basic blocks, each ending in the one jump, branch or return that
+// leaves it. See IRBuilder for how a tree becomes IR, CFG for the edges and
+// dominators, IRLower for the TM code.
+
+enum class IRType { Int, Bool, Char, Address };
+
+struct IRInstr
+{
+    enum class Kind { Const, Addr, Load, Store, LoadAt, StoreAt, Binary, Unary, ArrayCopy, ArrayCompare, Call, Return, Jump, Branch };
+    enum class Base { None, Global, Frame };
+
+    Kind kind = Kind::Const;
+    std::string op = "";                    // Binary, Unary and ArrayCompare: the TM operator
+    int dest = -1;                          // The register it assigns, -1 if none
+    IRType type = IRType::Int;
+    int lhs = -1;
+    int rhs = -1;
+    bool immediate = false;                 // Binary: value stands in for rhs, Return: value is returned
+    long long value = 0;                    // Const: the value
+    Base base = Base::None;                 // Addr, Load and Store: the slot
+    int offset = 0;                         // Its offset, LoadAt and StoreAt: from the address in lhs
+    Intern::Handle func = Intern::None;     // Call
+    std::vector<int> args = {};
+    int target = -1;                        // Jump, Branch when lhs is not 0
+    int other = -1;                         // Branch when lhs is 0
+    std::string comment = "";               // The name it is about
+
+    // Getters
+    std::vector<int> getUses() const;       // The registers it reads
+    bool getIsTerminator() const { return kind == Kind::Return || kind == Kind::Jump || kind == Kind::Branch; }
+    bool getHasSideEffects() const;         // Whether it does anything besides assigning dest
+
+    // Print
+    std::string stringify() const;
+};
+
+struct IRBlock
+{
+    std::vector<IRInstr> instrs;
+    std::vector<int> succs;                 // Filled in by CFG
+    std::vector<int> preds;
+    int idom = -1;                          // -1 for the entry and any block it cannot reach
+};
+
+struct IRFunc
+{
+    Intern::Handle name = Intern::None;
+    std::vector<IRBlock> blocks;            // The entry first, in the order they are laid out
+    std::vector<int> order;                 // The reachable blocks in reverse postorder
+    int regCount = 0;
+    int frameEnd = -2;                      // The first frame offset below its locals and parameters
+    std::vector<int> scalars;               // The frame offsets of its scalar locals and parameters, only ever reached by Load and Store
+
+    // Print
+    void print(std::ostream &out=std::cout) const;
+};
+
+struct IRProgram
+{
+    std::vector<IRFunc> funcs;
+    IRFunc init;                            // Sets up globals and statics before main, one block without a terminator
+    std::vector<std::pair<int, std::string>> strings;  // Each string constant and its offset from the top of memory
+    int goffset = 0;                        // The end of global space, where the first frame starts
+
+    // Print
+    void print(std::ostream &out=std::cout) const;
+};
@@ -0,0 +1,784 @@
+#include "IRBuilder.hpp"
+#include "CFG.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+IRBuilder::IRBuilder() : m_func(nullptr), m_block(-1) {}
+
+IRProgram IRBuilder::build(Node *root)
+{
+    m_program = IRProgram();
+    buildGlobals(root);
+    for (Node *node = root; node != nullptr; node = node->getSibling())
+    {
+        if (isFunc(node))
+        {
+            buildFunc((Func *)node);
+        }
+    }
+    m_func = nullptr;
+    return std::move(m_program);
+}
+
+void IRBuilder::buildGlobals(Node *root)
+{
+    // Statics live with the globals and are set up with them, string constants are loaded with the program
+    std::vector<Var *> globals;
+    traverse(root, [this, &globals](Node *node)
+    {
+        Node::MemScope memScope = node->getMemScope();
+        if (isVar(node) && (memScope == Node::MemScope::Global || memScope == Node::MemScope::LocalStatic))
+        {
+            globals.push_back((Var *)node);
+            m_program.goffset -= node->getMemSize();
+        }
+        else if (isStringConst(node))
+        {
+            m_program.strings.push_back({-node->getMemLoc(), ((Const *)node)->getStringValue()});
+            m_program.goffset -= node->getMemSize();
+        }
+        return true;
+    });
+
+    // In the order CodeGen sets them up
+    std::stable_sort(globals.begin(), globals.end(), [](const Var *lhs, const Var *rhs)
+    {
+        return lhs->getName() < rhs->getName();
+    });
+
+    m_func = &m_program.init;
+    m_started.clear();
+    m_block = -1;
+    startBlock(newBlock());
+    for (Var *var : globals)
+    {
+        buildVar(var);
+    }
+}
+
+void IRBuilder::buildFunc(Func *func)
+{
+    m_program.funcs.push_back(IRFunc());
+    m_func = &m_program.funcs.back();
+    m_func->name = func->getNameHandle();
+    for (unsigned i = 0; i < 2; i++)
+    {
+        traverse(func->getChild(i), [this](Node *node)
+        {
+            Node::MemScope memScope = node->getMemScope();
+            if ((isVar(node) || isParm(node)) && (memScope == Node::MemScope::Local || memScope == Node::MemScope::Parameter))
+            {
+                m_func->frameEnd = std::min(m_func->frameEnd, lowest(node) - 1);
+                if (!((Decl *)node)->getData()->getIsArray())
+                {
+                    m_func->scalars.push_back(node->getMemLoc());
+                }
+            }
+            return true;
+        });
+    }
+
+    m_started.clear();
+    m_exits.clear();
+    m_block = -1;
+    startBlock(newBlock());
+    buildStmt(func->getChild(1));
+    finishFunc(*m_func);
+}
+
+void IRBuilder::buildStmts(Node *node)
+{
+    for (; node != nullptr; node = node->getSibling())
+    {
+        buildStmt(node);
+    }
+}
+
+void IRBuilder::buildStmt(Node *node)
+{
+    if (node == nullptr)
+    {
+        return;
+    }
+
+    switch (node->getNodeKind())
+    {
+        case Node::Kind::Compound:
+            for (Node *decl = node->getChild(); decl != nullptr; decl = decl->getSibling())
+            {
+                if (isVar(decl) && decl->getMemScope() == Node::MemScope::Local)
+                {
+                    buildVar((Var *)decl);
+                }
+            }
+            buildStmts(node->getChild(1));
+            break;
+        case Node::Kind::If:
+            buildIf((If *)node);
+            break;
+        case Node::Kind::While:
+            buildWhile((While *)node);
+            break;
+        case Node::Kind::For:
+            buildFor((For *)node);
+            break;
+        case Node::Kind::Return:
+            buildReturn((Return *)node);
+            break;
+        case Node::Kind::Break:
+            buildBreak();
+            break;
+        default:
+            if (isExp(node))
+            {
+                buildExp(node);
+            }
+            break;
+    }
+}
+
+void IRBuilder::buildVar(Var *var)
+{
+    IRInstr::Base base = baseOf(var);
+    bool isArray = var->getData()->getIsArray();
+    if (isArray)
+    {
+        IRInstr store = {IRInstr::Kind::Store};
+        store.lhs = emitConst(var->getMemSize() - 1);
+        store.base = base;
+        store.offset = var->getMemLoc() + 1;
+        store.comment = "size of " + var->getName();
+        emit(store);
+    }
+
+    Node *value = var->getChild();
+    if (value == nullptr)
+    {
+        return;
+    }
+
+    if (isArray)
+    {
+        IRInstr copy = {IRInstr::Kind::ArrayCopy};
+        copy.rhs = buildExp(value);
+        IRInstr addr = {IRInstr::Kind::Addr};
+        addr.base = base;
+        addr.offset = var->getMemLoc();
+        addr.comment = var->getName();
+        copy.lhs = emitValue(addr, IRType::Address);
+        copy.comment = var->getName();
+        emit(copy);
+        return;
+    }
+
+    IRInstr store = {IRInstr::Kind::Store};
+    store.lhs = buildExp(value);
+    store.base = base;
+    store.offset = var->getMemLoc();
+    store.comment = var->getName();
+    emit(store);
+}
+
+void IRBuilder::buildIf(If *ifN)
+{
+    int cond = buildExp(ifN->getChild());
+    int thenBlock = newBlock();
+    int elseBlock = (ifN->getChild(2) != nullptr) ? newBlock() : -1;
+    int join = newBlock();
+    emitBranch(cond, thenBlock, (elseBlock != -1) ? elseBlock : join);
+
+    startBlock(thenBlock);
+    buildStmt(ifN->getChild(1));
+    if (elseBlock != -1)
+    {
+        emitJump(join);
+        startBlock(elseBlock);
+        buildStmt(ifN->getChild(2));
+    }
+    startBlock(join);
+}
+
+void IRBuilder::buildWhile(While *whileN)
+{
+    int header = newBlock();
+    int body = newBlock();
+    int exit = newBlock();
+    startBlock(header);
+    emitBranch(buildExp(whileN->getChild()), body, exit);
+
+    m_exits.push_back(exit);
+    startBlock(body);
+    buildStmt(whileN->getChild(1));
+    emitJump(header);
+    m_exits.pop_back();
+    startBlock(exit);
+}
+
+void IRBuilder::buildFor(For *forN)
+{
+    // The stop and step are evaluated once, a step known up front decides the test at compile time as SLT would at run time
+    Var *var = (Var *)(forN->getChild());
+    Range *range = (Range *)(forN->getChild(1));
+    IRInstr store = {IRInstr::Kind::Store};
+    store.lhs = buildExp(range->getChild());
+    store.base = baseOf(var);
+    store.offset = var->getMemLoc();
+    store.comment = var->getName();
+    emit(store);
+    int stop = buildExp(range->getChild(1));
+
+    Node *by = range->getChild(2);
+    bool known = true;
+    long long stepValue = 1;
+    int step = -1;
+    if (by != nullptr && isConst(by) && ((Const *)by)->getType() == Const::Type::Int)
+    {
+        stepValue = ((Const *)by)->getIntValue();
+    }
+    else if (by != nullptr && isUnary(by) && ((Unary *)by)->getType() == Unary::Type::Chsign && isConst(by->getChild()) && ((Const *)by->getChild())->getType() == Const::Type::Int)
+    {
+        stepValue = -(long long)((Const *)by->getChild())->getIntValue();
+    }
+    else if (by != nullptr)
+    {
+        known = false;
+        step = buildExp(by);
+    }
+
+    IRInstr load = {IRInstr::Kind::Load};
+    load.base = store.base;
+    load.offset = store.offset;
+    load.comment = store.comment;
+
+    int header = newBlock();
+    int body = newBlock();
+    int exit = newBlock();
+    startBlock(header);
+    int index = emitValue(load);
+    int cond;
+    if (known)
+    {
+        cond = emitBinary((stepValue >= 0) ? "TLT" : "TGT", index, stop, IRType::Bool);
+    }
+    else
+    {
+        int up = emitImmediate("TGE", step, 0, IRType::Bool);
+        int below = emitBinary("TLT", index, stop, IRType::Bool);
+        int above = emitBinary("TGT", index, stop, IRType::Bool);
+        int down = emitImmediate("XOR", up, 1, IRType::Bool);
+        cond = emitBinary("OR", emitBinary("AND", up, below, IRType::Bool), emitBinary("AND", down, above, IRType::Bool), IRType::Bool);
+    }
+    emitBranch(cond, body, exit);
+
+    m_exits.push_back(exit);
+    startBlock(body);
+    buildStmt(forN->getChild(2));
+    index = emitValue(load);
+    store.lhs = known ? emitImmediate("ADD", index, stepValue) : emitBinary("ADD", index, step);
+    emit(store);
+    emitJump(header);
+    m_exits.pop_back();
+    startBlock(exit);
+}
+
+void IRBuilder::buildReturn(Return *returnN)
+{
+    IRInstr ret = {IRInstr::Kind::Return};
+    if (returnN->getChild() != nullptr)
+    {
+        ret.lhs = buildExp(returnN->getChild());
+    }
+    emit(ret);
+    startBlock(newBlock());
+}
+
+void IRBuilder::buildBreak()
+{
+    if (m_exits.empty())
+    {
+        throw std::runtime_error("IRBuilder::buildBreak() - Break outside of a loop");
+    }
+    emitJump(m_exits.back());
+    startBlock(newBlock());
+}
+
+int IRBuilder::buildExp(Node *node)
+{
+    // Children are built before their parents on the tree's own work stack, the statements after node are no part of it
+    size_t base = m_operands.size();
+    Node::Index next = node->detachSibling();
+    traverse(node, [](Node *)
+    {
+        return true;
+    }, [this](Node *exp)
+    {
+        buildOperand(exp);
+    });
+    node->attachSibling(next);
+
+    if (m_operands.size() != base + 1)
+    {
+        throw std::runtime_error("IRBuilder::buildExp() - Not an expression");
+    }
+    return toRegister(popOperand());
+}
+
+void IRBuilder::buildOperand(Node *node)
+{
+    switch (node->getNodeKind())
+    {
+        case Node::Kind::Asgn:
+            m_operands.push_back({buildAsgn((Asgn *)node), nullptr});
+            break;
+        case Node::Kind::Binary:
+            m_operands.push_back({buildBinary((Binary *)node), nullptr});
+            break;
+        case Node::Kind::Call:
+            m_operands.push_back({buildCall((Call *)node), nullptr});
+            break;
+        case Node::Kind::Const:
+            m_operands.push_back({-1, (Const *)node});
+            break;
+        case Node::Kind::Id:
+            m_operands.push_back({buildId((Id *)node), nullptr});
+            break;
+        case Node::Kind::Unary:
+            m_operands.push_back({buildUnary((Unary *)node), nullptr});
+            break;
+        case Node::Kind::UnaryAsgn:
+            m_operands.push_back({buildUnaryAsgn((UnaryAsgn *)node), nullptr});
+            break;
+        default:
+            throw std::runtime_error("IRBuilder::buildOperand() - Not an expression");
+    }
+}
+
+int IRBuilder::buildAsgn(Asgn *asgn)
+{
+    // The right side is built before the old value is loaded, as CodeGen does
+    Node *lhs = asgn->getChild();
+    Operand rhs = popOperand();
+    Operand target = popOperand();
+    std::string op = asgn->getTypeString();
+    bool isCompound = asgn->getType() != Asgn::Type::Asgn;
+    bool isImmediate = isCompound && isIntConst(rhs) && (op == "ADD" || op == "SUB");
+    IRType type = typeOf(asgn);
+
+    if (isId(lhs))
+    {
+        Id *id = (Id *)lhs;
+        Decl *decl = id->getDecl();
+        if (decl->getData()->getIsArray())
+        {
+            IRInstr copy = {IRInstr::Kind::ArrayCopy};
+            copy.rhs = toRegister(rhs);
+            copy.lhs = buildArray(id);
+            copy.comment = id->getName();
+            emit(copy);
+            return copy.rhs;
+        }
+
+        IRInstr store = {IRInstr::Kind::Store};
+        store.base = baseOf(decl);
+        store.offset = decl->getMemLoc();
+        store.comment = id->getName();
+        int value = isImmediate ? -1 : toRegister(rhs);
+        if (isCompound)
+        {
+            IRInstr load = {IRInstr::Kind::Load};
+            load.base = store.base;
+            load.offset = store.offset;
+            load.comment = store.comment;
+            int old = emitValue(load, type);
+            value = isImmediate ? emitImmediate(op, old, rhs.constN->getIntValue(), type) : emitBinary(op, old, value, type);
+        }
+        store.lhs = value;
+        emit(store);
+        return value;
+    }
+
+    // An indexed target left its element's address
+    Id *id = (Id *)(lhs->getChild());
+    int addr = target.reg;
+    int value = isImmediate ? -1 : toRegister(rhs);
+    if (isCompound)
+    {
+        IRInstr load = {IRInstr::Kind::LoadAt};
+        load.lhs = addr;
+        load.comment = id->getName();
+        int old = emitValue(load, type);
+        value = isImmediate ? emitImmediate(op, old, rhs.constN->getIntValue(), type) : emitBinary(op, old, value, type);
+    }
+    IRInstr store = {IRInstr::Kind::StoreAt};
+    store.lhs = addr;
+    store.rhs = value;
+    store.comment = id->getName();
+    emit(store);
+    return value;
+}
+
+int IRBuilder::buildBinary(Binary *binary)
+{
+    Operand rhs = popOperand();
+    Operand lhs = popOperand();
+    if (binary->getType() == Binary::Type::Index)
+    {
+        // As the target of an assignment only the element's address is wanted
+        int addr = emitBinary("SUB", toRegister(lhs), toRegister(rhs), IRType::Address);
+        if (isTarget(binary))
+        {
+            return addr;
+        }
+        IRInstr load = {IRInstr::Kind::LoadAt};
+        load.lhs = addr;
+        load.comment = ((Id *)binary->getChild())->getName();
+        return emitValue(load, typeOf(binary));
+    }
+
+    // Arrays compare element by element, the shorter one first if they agree that far
+    std::string op = binary->getTypeString();
+    Exp *lhsN = (Exp *)(binary->getChild());
+    Exp *rhsN = (Exp *)(binary->getChild(1));
+    if (binary->getIsComparison() && lhsN->getData()->getIsArray() && rhsN->getData()->getIsArray())
+    {
+        IRInstr compare = {IRInstr::Kind::ArrayCompare};
+        compare.op = op;
+        compare.lhs = toRegister(lhs);
+        compare.rhs = toRegister(rhs);
+        return emitValue(compare, IRType::Bool);
+    }
+
+    int value = toRegister(lhs);
+    if (isIntConst(rhs) && (op == "ADD" || op == "SUB"))
+    {
+        return emitImmediate(op, value, rhs.constN->getIntValue(), typeOf(binary));
+    }
+    return emitBinary(op, value, toRegister(rhs), typeOf(binary));
+}
+
+int IRBuilder::buildCall(Call *call)
+{
+    // Arrays are passed by address
+    IRInstr instr = {IRInstr::Kind::Call};
+    instr.func = call->getNameHandle();
+    size_t argCount = call->getParms().size();
+    std::vector<Operand> args(m_operands.end() - argCount, m_operands.end());
+    m_operands.resize(m_operands.size() - argCount);
+    for (const Operand &arg : args)
+    {
+        instr.args.push_back(toRegister(arg));
+    }
+    instr.comment = call->getName();
+    if (call->getData()->getType() == Data::Type::Void)
+    {
+        emit(instr);
+        return -1;
+    }
+    return emitValue(instr, typeOf(call));
+}
+
+int IRBuilder::buildConst(Const *constN)
+{
+    switch (constN->getType())
+    {
+        case Const::Type::Int:
+            return emitConst(constN->getIntValue(), IRType::Int);
+        case Const::Type::Bool:
+            return emitConst(constN->getBoolValue(), IRType::Bool);
+        case Const::Type::Char:
+            return emitConst((int)(constN->getCharValue()), IRType::Char);
+        default:
+        {
+            IRInstr addr = {IRInstr::Kind::Addr};
+            addr.base = IRInstr::Base::Global;
+            addr.offset = constN->getMemLoc();
+            addr.comment = "\"" + constN->getStringValue() + "\"";
+            return emitValue(addr, IRType::Address);
+        }
+    }
+}
+
+int IRBuilder::buildId(Id *id)
+{
+    // A variable assigned to is only loaded by its assignment, if at all
+    Decl *decl = id->getDecl();
+    if (isTarget(id))
+    {
+        return -1;
+    }
+    if (decl->getData()->getIsArray())
+    {
+        return buildArray(id);
+    }
+
+    IRInstr load = {IRInstr::Kind::Load};
+    load.base = baseOf(decl);
+    load.offset = decl->getMemLoc();
+    load.comment = id->getName();
+    return emitValue(load, typeOf(id));
+}
+
+int IRBuilder::buildUnary(Unary *unary)
+{
+    int value = toRegister(popOperand());
+    switch (unary->getType())
+    {
+        case Unary::Type::Chsign:
+        {
+            IRInstr neg = {IRInstr::Kind::Unary};
+            neg.op = "NEG";
+            neg.lhs = value;
+            return emitValue(neg, IRType::Int);
+        }
+        case Unary::Type::Question:
+        {
+            IRInstr rnd = {IRInstr::Kind::Unary};
+            rnd.op = "RND";
+            rnd.lhs = value;
+            return emitValue(rnd, IRType::Int);
+        }
+        case Unary::Type::Not:
+            return emitImmediate("XOR", value, 1, IRType::Bool);
+        default:
+        {
+            // The size sits just above the first element
+            IRInstr load = {IRInstr::Kind::LoadAt};
+            load.lhs = value;
+            load.offset = 1;
+            load.comment = "size of " + ((Id *)(unary->getChild()))->getName();
+            return emitValue(load, IRType::Int);
+        }
+    }
+}
+
+int IRBuilder::buildUnaryAsgn(UnaryAsgn *unaryAsgn)
+{
+    Node *lhs = unaryAsgn->getChild();
+    Operand target = popOperand();
+    if (isId(lhs))
+    {
+        Id *id = (Id *)lhs;
+        Decl *decl = id->getDecl();
+        IRInstr load = {IRInstr::Kind::Load};
+        load.base = baseOf(decl);
+        load.offset = decl->getMemLoc();
+        load.comment = id->getName();
+        IRInstr store = load;
+        store.kind = IRInstr::Kind::Store;
+        store.lhs = emitImmediate("ADD", emitValue(load), unaryAsgn->getTypeValue());
+        emit(store);
+        return store.lhs;
+    }
+
+    IRInstr load = {IRInstr::Kind::LoadAt};
+    load.lhs = target.reg;
+    load.comment = ((Id *)(lhs->getChild()))->getName();
+    IRInstr store = load;
+    store.kind = IRInstr::Kind::StoreAt;
+    store.rhs = emitImmediate("ADD", emitValue(load), unaryAsgn->getTypeValue());
+    emit(store);
+    return store.rhs;
+}
+
+int IRBuilder::buildArray(Id *id)
+{
+    // An array parameter holds the address of the caller's array
+    Decl *decl = id->getDecl();
+    IRInstr instr = {(decl->getMemScope() == Node::MemScope::Parameter) ? IRInstr::Kind::Load : IRInstr::Kind::Addr};
+    instr.base = baseOf(decl);
+    instr.offset = decl->getMemLoc();
+    instr.comment = id->getName();
+    return emitValue(instr, IRType::Address);
+}
+
+IRBuilder::Operand IRBuilder::popOperand()
+{
+    Operand operand = m_operands.back();
+    m_operands.pop_back();
+    return operand;
+}
+
+int IRBuilder::toRegister(const Operand &operand)
+{
+    if (operand.constN != nullptr)
+    {
+        return buildConst(operand.constN);
+    }
+    return operand.reg;
+}
+
+void IRBuilder::emit(IRInstr instr)
+{
+    if (instr.dest == -1 && instr.kind != IRInstr::Kind::Call && instr.kind != IRInstr::Kind::Store && instr.kind != IRInstr::Kind::StoreAt && instr.kind != IRInstr::Kind::ArrayCopy && !instr.getIsTerminator())
+    {
+        throw std::runtime_error("IRBuilder::emit() - Instruction needs a register to assign");
+    }
+    m_func->blocks[m_block].instrs.push_back(instr);
+}
+
+int IRBuilder::emitValue(IRInstr instr, const IRType type)
+{
+    instr.dest = m_func->regCount++;
+    instr.type = type;
+    m_func->blocks[m_block].instrs.push_back(instr);
+    return instr.dest;
+}
+
+int IRBuilder::emitConst(const long long value, const IRType type)
+{
+    IRInstr instr = {IRInstr::Kind::Const};
+    instr.value = value;
+    return emitValue(instr, type);
+}
+
+int IRBuilder::emitBinary(const std::string &op, const int lhs, const int rhs, const IRType type)
+{
+    IRInstr instr = {IRInstr::Kind::Binary};
+    instr.op = op;
+    instr.lhs = lhs;
+    instr.rhs = rhs;
+    return emitValue(instr, type);
+}
+
+int IRBuilder::emitImmediate(const std::string &op, const int lhs, const long long value, const IRType type)
+{
+    IRInstr instr = {IRInstr::Kind::Binary};
+    instr.op = op;
+    instr.lhs = lhs;
+    instr.immediate = true;
+    instr.value = value;
+    return emitValue(instr, type);
+}
+
+void IRBuilder::emitJump(const int target)
+{
+    // Nothing follows a block's terminator
+    if (isFinished())
+    {
+        return;
+    }
+    IRInstr jump = {IRInstr::Kind::Jump};
+    jump.target = target;
+    emit(jump);
+}
+
+void IRBuilder::emitBranch(const int cond, const int target, const int other)
+{
+    IRInstr branch = {IRInstr::Kind::Branch};
+    branch.lhs = cond;
+    branch.target = target;
+    branch.other = other;
+    emit(branch);
+}
+
+bool IRBuilder::isFinished() const
+{
+    const std::vector<IRInstr> &instrs = m_func->blocks[m_block].instrs;
+    return !instrs.empty() && instrs.back().getIsTerminator();
+}
+
+int IRBuilder::newBlock()
+{
+    m_func->blocks.push_back(IRBlock());
+    return m_func->blocks.size() - 1;
+}
+
+void IRBuilder::startBlock(const int block)
+{
+    if (m_block != -1)
+    {
+        emitJump(block);
+    }
+    m_block = block;
+    m_started.push_back(block);
+}
+
+void IRBuilder::finishFunc(IRFunc &func)
+{
+    // Falling off the end returns 0, then the blocks are renumbered in the order they were started
+    if (!isFinished())
+    {
+        IRInstr ret = {IRInstr::Kind::Return};
+        ret.immediate = true;
+        emit(ret);
+    }
+
+    if (m_started.size() != func.blocks.size())
+    {
+        throw std::runtime_error("IRBuilder::finishFunc() - A block was never started");
+    }
+    std::vector<int> number(func.blocks.size());
+    std::vector<IRBlock> blocks(func.blocks.size());
+    for (size_t i = 0; i < m_started.size(); i++)
+    {
+        number[m_started[i]] = i;
+    }
+    for (size_t i = 0; i < m_started.size(); i++)
+    {
+        blocks[i] = std::move(func.blocks[m_started[i]]);
+        IRInstr &last = blocks[i].instrs.back();
+        if (last.target != -1)
+        {
+            last.target = number[last.target];
+        }
+        if (last.other != -1)
+        {
+            last.other = number[last.other];
+        }
+    }
+    func.blocks.swap(blocks);
+    CFG::build(func);
+}
+
+IRType IRBuilder::typeOf(const Node *node)
+{
+    const Data *data = ((const Exp *)node)->getData();
+    if (data->getIsArray())
+    {
+        return IRType::Address;
+    }
+    switch (data->getType())
+    {
+        case Data::Type::Bool:
+            return IRType::Bool;
+        case Data::Type::Char:
+            return IRType::Char;
+        case Data::Type::String:
+            return IRType::Address;
+        default:
+            return IRType::Int;
+    }
+}
+
+IRInstr::Base IRBuilder::baseOf(const Decl *decl)
+{
+    Node::MemScope memScope = decl->getMemScope();
+    return (memScope == Node::MemScope::Global || memScope == Node::MemScope::LocalStatic) ? IRInstr::Base::Global : IRInstr::Base::Frame;
+}
+
+bool IRBuilder::isTarget(const Node *node)
+{
+    Node *parent = node->getParent();
+    return parent != nullptr && (isAsgn(parent) || isUnaryAsgn(parent)) && parent->getChild() == node;
+}
+
+bool IRBuilder::isIntConst(const Operand &operand)
+{
+    return operand.constN != nullptr && operand.constN->getType() == Const::Type::Int;
+}
+
+bool IRBuilder::isStringConst(const Node *node)
+{
+    return isConst(node) && ((const Const *)node)->getType() == Const::Type::String;
+}
+
+int IRBuilder::lowest(const Node *decl)
+{
+    // An array's size sits just above its first element, the rest run down from it
+    if (isVar(decl) && ((const Var *)decl)->getData()->getIsArray())
+    {
+        return decl->getMemLoc() - (decl->getMemSize() - 2);
+    }
+    return decl->getMemLoc() - decl->getMemSize() + 1;
+}
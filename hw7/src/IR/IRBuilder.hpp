@@ -0,0 +1,86 @@
+#pragma once
+
+#include "IR.hpp"
+#include "../Semantics/Is.hpp"
+#include "../Tree/Traverse.hpp"
+#include "../Tree/Tree.hpp"
+
+#include <vector>
+
+// Builds the IR of an analyzed tree. Expressions are evaluated left to right
+// into fresh registers, each node once its children are built, on the work
+// stack of traverse() so a deep expression costs no recursion. Statements
+// become blocks: an if branches to its then and else, a loop tests at its
+// header and jumps back from the end of its body, a break jumps out of the
+// innermost loop. Globals and statics are set up once by the program's init,
+// and the blocks of each function are numbered in the order they are laid
+// out.
+class IRBuilder
+{
+    public:
+        IRBuilder();
+
+        // Helpers
+        IRProgram build(Node *root);            // Every function and global of root and its siblings
+
+    private:
+        // A built expression waiting for its parent, a constant is only loaded once something needs it in a register
+        struct Operand
+        {
+            int reg;                            // -1 for a constant, a call of a void function or a variable assigned to
+            Const *constN;
+        };
+
+        void buildGlobals(Node *root);
+        void buildFunc(Func *func);
+        void buildStmts(Node *node);            // node and its siblings
+        void buildStmt(Node *node);
+        void buildVar(Var *var);
+        void buildIf(If *ifN);
+        void buildWhile(While *whileN);
+        void buildFor(For *forN);
+        void buildReturn(Return *returnN);
+        void buildBreak();
+
+        int buildExp(Node *node);               // The register holding its value, -1 for a call of a void function
+        void buildOperand(Node *node);          // Once its children are built, each of these takes their operands off the stack
+        int buildAsgn(Asgn *asgn);
+        int buildBinary(Binary *binary);
+        int buildCall(Call *call);
+        int buildConst(Const *constN);
+        int buildId(Id *id);
+        int buildUnary(Unary *unary);
+        int buildUnaryAsgn(UnaryAsgn *unaryAsgn);
+        int buildArray(Id *id);                 // The address of the array's first element
+
+        Operand popOperand();
+        int toRegister(const Operand &operand);
+
+        // The current block
+        void emit(IRInstr instr);
+        int emitValue(IRInstr instr, const IRType type=IRType::Int);      // The register it assigns
+        int emitConst(const long long value, const IRType type=IRType::Int);
+        int emitBinary(const std::string &op, const int lhs, const int rhs, const IRType type=IRType::Int);
+        int emitImmediate(const std::string &op, const int lhs, const long long value, const IRType type=IRType::Int);
+        void emitJump(const int target);
+        void emitBranch(const int cond, const int target, const int other);
+        int newBlock();
+        bool isFinished() const;                // Whether the current block has its terminator
+        void startBlock(const int block);       // Falls through from the current block unless it is finished
+        void finishFunc(IRFunc &func);
+
+        // Static
+        static IRType typeOf(const Node *node);
+        static IRInstr::Base baseOf(const Decl *decl);
+        static bool isTarget(const Node *node);         // Whether an assignment stores to it
+        static bool isIntConst(const Operand &operand);
+        static bool isStringConst(const Node *node);
+        static int lowest(const Node *decl);    // The lowest offset it takes up
+
+        IRProgram m_program;
+        IRFunc *m_func;
+        int m_block;
+        std::vector<int> m_started;             // The blocks of the function in the order they were started
+        std::vector<int> m_exits;               // Where a break in each enclosing loop goes
+        std::vector<Operand> m_operands;
+};
@@ -0,0 +1,441 @@
+#include "IRLower.hpp"
+#include "../Optimizer/Peephole.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+IRLower::IRLower(const std::string tmPath) : m_tmPath(tmPath), m_peephole(nullptr), m_libraryEnd(0), m_frameEnd(0) {}
+
+void IRLower::generate(const IRProgram &program)
+{
+    std::ofstream code(m_tmPath);
+    if (!code)
+    {
+        throw std::runtime_error("IRLower::generate() - Invalid tmPath provided to constructor");
+    }
+    generate(program, code);
+}
+
+void IRLower::generate(const IRProgram &program, std::ostream &code)
+{
+    m_funcs[Intern::handle("input")] = 1;
+    m_funcs[Intern::handle("output")] = 6;
+    m_funcs[Intern::handle("inputb")] = 12;
+    m_funcs[Intern::handle("outputb")] = 17;
+    m_funcs[Intern::handle("inputc")] = 23;
+    m_funcs[Intern::handle("outputc")] = 28;
+    m_funcs[Intern::handle("outnl")] = 34;
+    m_code.emitSkip(1);
+    m_code.emitIO();
+    m_libraryEnd = m_code.emitWhereAmI();
+
+    for (const IRFunc &func : program.funcs)
+    {
+        lowerFunc(func);
+    }
+
+    int init = m_code.emitWhereAmI();
+    m_code.backPatchRM(0, "JMP", PC, init - 1, PC, "Jump to init [backpatch]");
+    for (const auto &[offset, string] : program.strings)
+    {
+        m_code.emitStrLit(offset, string.c_str());
+    }
+    m_code.emitRM("LDA", FP, program.goffset, GP, "set first frame at end of globals");
+    m_code.emitRM("ST", FP, 0, FP, "store old fp (point to self)");
+    lowerFunc(program.init, true);
+    m_code.emitRM("LDA", AC, 1, PC, "Return address in ac");
+    m_code.emitRM("JMP", PC, -(m_code.emitWhereAmI() + 1 - m_funcs[Intern::handle("main")]), PC, "Jump to main");
+    m_code.emitRO("HALT", 0, 0, 0, "DONE!");
+
+    for (const auto &[loc, name] : m_calls)
+    {
+        m_code.backPatchRM(loc, "JMP", PC, -(loc + 1 - m_funcs[name]), PC, "CALL", Intern::string(name).c_str());
+    }
+
+    if (m_peephole != nullptr)
+    {
+        std::vector<std::pair<int, std::string>> funcs;
+        for (const auto &[name, loc] : m_funcs)
+        {
+            if (loc >= m_libraryEnd)
+            {
+                funcs.push_back({loc, Intern::string(name)});
+            }
+        }
+        m_peephole->optimize(m_code, funcs, init);
+    }
+    m_code.write(code);
+}
+
+void IRLower::allocate(const IRFunc &func)
+{
+    // Where each register is assigned and last read
+    const int none = -1;
+    std::vector<int> defBlock(func.regCount, none);
+    std::vector<int> defIndex(func.regCount, none);
+    std::vector<int> lastUse(func.regCount, none);
+    std::vector<bool> local(func.regCount, true);
+    for (size_t b = 0; b < func.blocks.size(); b++)
+    {
+        const std::vector<IRInstr> &instrs = func.blocks[b].instrs;
+        for (size_t i = 0; i < instrs.size(); i++)
+        {
+            if (instrs[i].dest != none)
+            {
+                defBlock[instrs[i].dest] = b;
+                defIndex[instrs[i].dest] = i;
+            }
+        }
+    }
+    for (size_t b = 0; b < func.blocks.size(); b++)
+    {
+        const std::vector<IRInstr> &instrs = func.blocks[b].instrs;
+        int clobber = none;
+        for (size_t i = 0; i < instrs.size(); i++)
+        {
+            for (int reg : instrs[i].getUses())
+            {
+                if (defBlock[reg] != (int)b || defIndex[reg] >= (int)i || (clobber != none && clobber > defIndex[reg]))
+                {
+                    local[reg] = false;
+                }
+                lastUse[reg] = i;
+            }
+            if (clobbers(instrs[i]))
+            {
+                clobber = i;
+            }
+        }
+    }
+
+    // Values kept across blocks or calls get slots of their own, the rest share registers and then slots block by block
+    m_locations.assign(func.regCount, {none, 0});
+    int slotCount = 0;
+    for (int reg = 0; reg < func.regCount; reg++)
+    {
+        if (!local[reg])
+        {
+            m_locations[reg] = {none, func.frameEnd - slotCount++};
+        }
+    }
+
+    int sharedCount = 0;
+    for (const IRBlock &block : func.blocks)
+    {
+        std::vector<bool> isFree(s_lastRegister + 1, true);
+        std::vector<int> freeSlots;
+        int blockSlotCount = 0;
+        for (size_t i = 0; i < block.instrs.size(); i++)
+        {
+            const IRInstr &instr = block.instrs[i];
+            for (int reg : instr.getUses())
+            {
+                if (local[reg] && lastUse[reg] == (int)i)
+                {
+                    if (m_locations[reg].reg != none)
+                    {
+                        isFree[m_locations[reg].reg] = true;
+                    }
+                    else if (std::find(freeSlots.begin(), freeSlots.end(), m_locations[reg].offset) == freeSlots.end())
+                    {
+                        freeSlots.push_back(m_locations[reg].offset);
+                    }
+                }
+            }
+
+            int dest = instr.dest;
+            if (dest == none || !local[dest])
+            {
+                continue;
+            }
+            if (lastUse[dest] == none)
+            {
+                // Never read, it is computed in scratch and dropped
+                m_locations[dest] = {AC3, 0};
+                continue;
+            }
+            int reg = s_firstRegister;
+            while (reg <= s_lastRegister && !isFree[reg])
+            {
+                reg++;
+            }
+            if (reg <= s_lastRegister)
+            {
+                isFree[reg] = false;
+                m_locations[dest] = {reg, 0};
+            }
+            else if (!freeSlots.empty())
+            {
+                m_locations[dest] = {none, freeSlots.back()};
+                freeSlots.pop_back();
+            }
+            else
+            {
+                m_locations[dest] = {none, func.frameEnd - slotCount - blockSlotCount++};
+            }
+        }
+        sharedCount = std::max(sharedCount, blockSlotCount);
+    }
+    m_frameEnd = func.frameEnd - slotCount - sharedCount;
+}
+
+void IRLower::lowerFunc(const IRFunc &func, const bool isInit)
+{
+    allocate(func);
+    m_blockLocs.assign(func.blocks.size(), -1);
+    m_patches.clear();
+    if (!isInit)
+    {
+        m_code.emitRM("ST", AC, -1, FP, "Store return address");
+        m_funcs[func.name] = m_code.emitWhereAmI() - 1;
+    }
+
+    for (size_t b = 0; b < func.blocks.size(); b++)
+    {
+        m_blockLocs[b] = m_code.emitWhereAmI();
+        for (const IRInstr &instr : func.blocks[b].instrs)
+        {
+            lowerInstr(instr, b + 1);
+        }
+    }
+
+    for (const Patch &patch : m_patches)
+    {
+        m_code.backPatchRM(patch.loc, patch.op.c_str(), patch.reg, m_blockLocs[patch.block] - (patch.loc + 1), PC, "Jump to block [backpatch]", ("bb" + std::to_string(patch.block)).c_str());
+    }
+}
+
+void IRLower::lowerInstr(const IRInstr &instr, const int next)
+{
+    const char *comment = instr.comment.c_str();
+    int base = (instr.base == IRInstr::Base::Global) ? GP : FP;
+    switch (instr.kind)
+    {
+        case IRInstr::Kind::Const:
+            m_code.emitRM("LDC", target(instr.dest), instr.value, AC3, "Load constant");
+            define(instr.dest, target(instr.dest));
+            break;
+        case IRInstr::Kind::Addr:
+            m_code.emitRM("LDA", target(instr.dest), instr.offset, base, "Load address", comment);
+            define(instr.dest, target(instr.dest));
+            break;
+        case IRInstr::Kind::Load:
+            m_code.emitRM("LD", target(instr.dest), instr.offset, base, "Load variable", comment);
+            define(instr.dest, target(instr.dest));
+            break;
+        case IRInstr::Kind::Store:
+            m_code.emitRM("ST", use(instr.lhs, AC3), instr.offset, base, "Store variable", comment);
+            break;
+        case IRInstr::Kind::LoadAt:
+        {
+            int addr = use(instr.lhs, AC3);
+            m_code.emitRM("LD", target(instr.dest), instr.offset, addr, "Load array element", comment);
+            define(instr.dest, target(instr.dest));
+            break;
+        }
+        case IRInstr::Kind::StoreAt:
+        {
+            int addr = use(instr.lhs, AC3);
+            m_code.emitRM("ST", use(instr.rhs, RT), instr.offset, addr, "Store array element", comment);
+            break;
+        }
+        case IRInstr::Kind::Binary:
+        {
+            int lhs = use(instr.lhs, AC3);
+            std::string opComment = "Op " + instr.op;
+            if (instr.immediate && (instr.op == "ADD" || instr.op == "SUB"))
+            {
+                m_code.emitRM("LDA", target(instr.dest), (instr.op == "ADD") ? instr.value : -instr.value, lhs, opComment.c_str());
+            }
+            else
+            {
+                int rhs = RT;
+                if (instr.immediate)
+                {
+                    m_code.emitRM("LDC", RT, instr.value, AC3, "Load constant");
+                }
+                else
+                {
+                    rhs = use(instr.rhs, RT);
+                }
+                m_code.emitRO(instr.op.c_str(), target(instr.dest), lhs, rhs, opComment.c_str());
+            }
+            define(instr.dest, target(instr.dest));
+            break;
+        }
+        case IRInstr::Kind::Unary:
+        {
+            int lhs = use(instr.lhs, AC3);
+            std::string opComment = "Op " + instr.op;
+            m_code.emitRO(instr.op.c_str(), target(instr.dest), lhs, lhs, opComment.c_str());
+            define(instr.dest, target(instr.dest));
+            break;
+        }
+        case IRInstr::Kind::ArrayCopy:
+        case IRInstr::Kind::ArrayCompare:
+            lowerArrays(instr);
+            break;
+        case IRInstr::Kind::Call:
+        {
+            // The caller's frame pointer, then each argument, at the bottom of this frame
+            m_code.emitRM("ST", FP, m_frameEnd, FP, "Store fp in ghost frame for", comment);
+            for (size_t i = 0; i < instr.args.size(); i++)
+            {
+                m_code.emitRM("ST", use(instr.args[i], AC3), m_frameEnd - 2 - (int)i, FP, "Push parameter");
+            }
+            m_code.emitRM("LDA", FP, m_frameEnd, FP, "Ghost frame becomes new active frame");
+            m_code.emitRM("LDA", AC, 1, PC, "Return address in ac");
+            m_calls.push_back({m_code.emitWhereAmI(), instr.func});
+            m_code.emitRM("JMP", PC, 0, PC, "CALL", comment);
+            if (instr.dest != -1)
+            {
+                define(instr.dest, RT);
+            }
+            break;
+        }
+        case IRInstr::Kind::Return:
+            if (instr.lhs != -1)
+            {
+                m_code.emitRM("LDA", RT, 0, use(instr.lhs, AC3), "Copy result to return register");
+            }
+            else if (instr.immediate)
+            {
+                m_code.emitRM("LDC", RT, instr.value, AC3, "Set return value to", std::to_string(instr.value).c_str());
+            }
+            m_code.emitRM("LD", AC, -1, FP, "Load return address");
+            m_code.emitRM("LD", FP, 0, FP, "Adjust fp");
+            m_code.emitRM("JMP", PC, 0, AC, "Return");
+            break;
+        case IRInstr::Kind::Jump:
+            if (instr.target != next)
+            {
+                emitJumpTo("JMP", PC, instr.target, "Jump");
+            }
+            break;
+        case IRInstr::Kind::Branch:
+        {
+            int cond = use(instr.lhs, AC3);
+            if (instr.other == next)
+            {
+                emitJumpTo("JNZ", cond, instr.target, "Jump if true");
+            }
+            else if (instr.target == next)
+            {
+                emitJumpTo("JZR", cond, instr.other, "Jump if false");
+            }
+            else
+            {
+                emitJumpTo("JNZ", cond, instr.target, "Jump if true");
+                emitJumpTo("JMP", PC, instr.other, "Jump");
+            }
+            break;
+        }
+    }
+}
+
+void IRLower::lowerArrays(const IRInstr &instr)
+{
+    // The left array's address goes in AC1 and the right's in AC, without losing either on the way
+    Location lhs = m_locations[instr.lhs];
+    Location rhs = m_locations[instr.rhs];
+    if (lhs.reg == AC && rhs.reg == AC1)
+    {
+        m_code.emitRM("LDA", RT, 0, AC1, "Swap array addresses");
+        m_code.emitRM("LDA", AC1, 0, AC, "Swap array addresses");
+        m_code.emitRM("LDA", AC, 0, RT, "Swap array addresses");
+    }
+    else if (rhs.reg == AC1)
+    {
+        moveTo(instr.rhs, AC);
+        moveTo(instr.lhs, AC1);
+    }
+    else
+    {
+        moveTo(instr.lhs, AC1);
+        moveTo(instr.rhs, AC);
+    }
+
+    if (instr.kind == IRInstr::Kind::ArrayCopy)
+    {
+        m_code.emitRM("LD", AC2, 1, AC, "size of rhs");
+        m_code.emitRM("LD", AC3, 1, AC1, "size of lhs");
+        m_code.emitRO("SWP", AC2, AC3, AC3, "pick smallest size");
+        m_code.emitRO("MOV", AC1, AC, AC2, "array op =", instr.comment.c_str());
+        return;
+    }
+
+    // The first elements that differ decide, or the sizes if the shorter one runs out first
+    std::string opComment = "Op " + instr.op;
+    m_code.emitRM("LD", AC2, 1, AC, "AC2 <- |RHS|");
+    m_code.emitRM("LD", AC3, 1, AC1, "AC3 <- |LHS|");
+    m_code.emitRM("LDA", RT, 0, AC2, "R2 <- |RHS|");
+    m_code.emitRO("SWP", AC2, AC3, AC3, "pick smallest size");
+    m_code.emitRM("LD", AC3, 1, AC1, "AC3 <- |LHS|");
+    m_code.emitRO("CO", AC1, AC, AC2, "setup array compare  LHS vs RHS");
+    m_code.emitRO("TNE", AC2, AC1, AC, "if not equal then test (AC1, AC)");
+    m_code.emitRM("JNZ", AC2, 2, PC, "jump not equal");
+    m_code.emitRM("LDA", AC, 0, RT, "AC1 <- |RHS|");
+    m_code.emitRM("LDA", AC1, 0, AC3, "AC <- |LHS|");
+    m_code.emitRO(instr.op.c_str(), AC, AC1, AC, opComment.c_str());
+    define(instr.dest, AC);
+}
+
+int IRLower::use(const int reg, const int scratch)
+{
+    const Location &location = m_locations[reg];
+    if (location.reg != -1)
+    {
+        return location.reg;
+    }
+    m_code.emitRM("LD", scratch, location.offset, FP, "Load temporary");
+    return scratch;
+}
+
+int IRLower::target(const int reg) const
+{
+    const Location &location = m_locations[reg];
+    return (location.reg != -1) ? location.reg : AC3;
+}
+
+void IRLower::define(const int reg, const int from)
+{
+    const Location &location = m_locations[reg];
+    if (location.reg == -1)
+    {
+        m_code.emitRM("ST", from, location.offset, FP, "Store temporary");
+    }
+    else if (location.reg != from)
+    {
+        m_code.emitRM("LDA", location.reg, 0, from, "Copy value");
+    }
+}
+
+void IRLower::moveTo(const int reg, const int to)
+{
+    const Location &location = m_locations[reg];
+    if (location.reg == -1)
+    {
+        m_code.emitRM("LD", to, location.offset, FP, "Load temporary");
+    }
+    else if (location.reg != to)
+    {
+        m_code.emitRM("LDA", to, 0, location.reg, "Copy value");
+    }
+}
+
+void IRLower::emitJumpTo(const std::string &op, const int reg, const int block, const char *comment)
+{
+    // A block placed already is behind, any other is patched once the function is done
+    if (m_blockLocs[block] != -1)
+    {
+        m_code.emitRM(op.c_str(), reg, m_blockLocs[block] - (m_code.emitWhereAmI() + 1), PC, comment, ("bb" + std::to_string(block)).c_str());
+        return;
+    }
+    m_patches.push_back({m_code.emitSkip(1), op, reg, block});
+}
+
+bool IRLower::clobbers(const IRInstr &instr)
+{
+    return instr.kind == IRInstr::Kind::Call || instr.kind == IRInstr::Kind::ArrayCopy || instr.kind == IRInstr::Kind::ArrayCompare;
+}
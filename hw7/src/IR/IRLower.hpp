@@ -0,0 +1,77 @@
+#pragma once
+
+#include "IR.hpp"
+#include "../CodeGen/EmitCode/EmitCode.hpp"
+#include "../Intern/Intern.hpp"
+
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Peephole;
+
+// Lowers IR to a TM program laid out as CodeGen lays it out: the IO library,
+// each function, then the code that sets up globals and calls main. A value
+// used only in the block that assigns it, with no call or array operation in
+// between, is kept in AC, AC1 or AC2 while one is free; any other value gets
+// a frame slot below the function's locals, and calls build their frames
+// below those. AC3 and RT hold whatever an instruction loads from a slot.
+// A jump to a block not placed yet is backpatched once the function is done.
+class IRLower
+{
+    public:
+        IRLower(const std::string tmPath="");
+
+        // Setters
+        void setPeephole(Peephole *peephole) { m_peephole = peephole; }      // Run over the functions before writing
+
+        // Helpers
+        void generate(const IRProgram &program);                // Write the program to the tmPath given to the constructor
+        void generate(const IRProgram &program, std::ostream &code);
+
+    private:
+        // Where a register's value is kept, a frame offset if not in a TM register
+        struct Location
+        {
+            int reg;
+            int offset;
+        };
+
+        struct Patch
+        {
+            int loc;
+            std::string op;
+            int reg;
+            int block;
+        };
+
+        void allocate(const IRFunc &func);
+        void lowerFunc(const IRFunc &func, const bool isInit=false);
+        void lowerInstr(const IRInstr &instr, const int next);
+        void lowerArrays(const IRInstr &instr);
+        int use(const int reg, const int scratch);         // The TM register holding reg, loaded into scratch if kept in the frame
+        int target(const int reg) const;                    // The TM register to compute reg in
+        void define(const int reg, const int from);         // Put reg where it is kept once computed in from
+        void moveTo(const int reg, const int to);
+        void emitJumpTo(const std::string &op, const int reg, const int block, const char *comment);
+
+        // Static
+        static bool clobbers(const IRInstr &instr);        // Whether its TM code uses every register
+
+        const std::string m_tmPath;
+        EmitCode m_code;
+        Peephole *m_peephole;
+        int m_libraryEnd;
+        std::unordered_map<Intern::Handle, int> m_funcs;
+        std::vector<std::pair<int, Intern::Handle>> m_calls;
+
+        // The function being lowered
+        std::vector<Location> m_locations;
+        std::vector<int> m_blockLocs;
+        std::vector<Patch> m_patches;
+        int m_frameEnd;                                     // Where the frame of a call starts
+
+        static const int s_firstRegister = AC;             // AC, AC1 and AC2 hold values, AC3 and RT are scratch
+        static const int s_lastRegister = AC2;
+};
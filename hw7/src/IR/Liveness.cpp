@@ -0,0 +1,196 @@
+#include "Liveness.hpp"
+#include "CFG.hpp"
+
+Liveness::Liveness() : m_regCount(0), m_unreachableCount(0), m_deadStoreCount(0), m_deadValueCount(0) {}
+
+void Liveness::eliminate(IRProgram &program)
+{
+    for (IRFunc &func : program.funcs)
+    {
+        eliminateFunc(func);
+    }
+}
+
+Liveness::Sets Liveness::analyze(const IRFunc &func)
+{
+    setSlots(func);
+    size_t size = m_regCount + m_slots.size();
+    Sets sets;
+    sets.in.assign(func.blocks.size(), std::vector<bool>(size, false));
+    sets.out.assign(func.blocks.size(), std::vector<bool>(size, false));
+
+    // Successors first, so a loop body settles in a few rounds
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto block = func.order.rbegin(); block != func.order.rend(); block++)
+        {
+            std::vector<bool> live(size, false);
+            for (int succ : func.blocks[*block].succs)
+            {
+                for (size_t i = 0; i < size; i++)
+                {
+                    live[i] = live[i] || sets.in[succ][i];
+                }
+            }
+            sets.out[*block] = live;
+
+            const std::vector<IRInstr> &instrs = func.blocks[*block].instrs;
+            for (auto instr = instrs.rbegin(); instr != instrs.rend(); instr++)
+            {
+                transfer(*instr, live);
+            }
+            if (live != sets.in[*block])
+            {
+                sets.in[*block] = live;
+                changed = true;
+            }
+        }
+    }
+    return sets;
+}
+
+void Liveness::printReport(std::ostream &out) const
+{
+    out << "Removed " << m_unreachableCount << " unreachable blocks, " << m_deadStoreCount << " dead stores, " << m_deadValueCount << " unused values" << std::endl;
+}
+
+void Liveness::eliminateFunc(IRFunc &func)
+{
+    removeUnreachable(func);
+    bool removed = true;
+    while (removed)
+    {
+        removed = removeDead(func, analyze(func));
+    }
+}
+
+void Liveness::removeUnreachable(IRFunc &func)
+{
+    if (func.order.size() == func.blocks.size())
+    {
+        return;
+    }
+
+    // The blocks left keep their order, every jump follows its target
+    std::vector<int> number(func.blocks.size(), -1);
+    for (int block : func.order)
+    {
+        number[block] = 0;
+    }
+    std::vector<IRBlock> blocks;
+    for (size_t i = 0; i < func.blocks.size(); i++)
+    {
+        if (number[i] == -1)
+        {
+            m_unreachableCount++;
+            continue;
+        }
+        number[i] = blocks.size();
+        blocks.push_back(std::move(func.blocks[i]));
+    }
+    for (IRBlock &block : blocks)
+    {
+        IRInstr &last = block.instrs.back();
+        if (last.target != -1)
+        {
+            last.target = number[last.target];
+        }
+        if (last.other != -1)
+        {
+            last.other = number[last.other];
+        }
+    }
+    func.blocks.swap(blocks);
+    CFG::build(func);
+}
+
+bool Liveness::removeDead(IRFunc &func, const Sets &sets)
+{
+    bool removed = false;
+    for (size_t b = 0; b < func.blocks.size(); b++)
+    {
+        std::vector<IRInstr> &instrs = func.blocks[b].instrs;
+        std::vector<bool> live = sets.out[b];
+        std::vector<bool> isDead(instrs.size(), false);
+        for (size_t i = instrs.size(); i-- > 0;)
+        {
+            IRInstr &instr = instrs[i];
+            int slot = slotOf(instr);
+            if (instr.kind == IRInstr::Kind::Store && slot != -1 && !live[slot])
+            {
+                isDead[i] = true;
+                m_deadStoreCount++;
+                continue;
+            }
+            if (instr.dest != -1 && !live[instr.dest])
+            {
+                if (!instr.getHasSideEffects())
+                {
+                    isDead[i] = true;
+                    m_deadValueCount++;
+                    continue;
+                }
+                if (instr.kind == IRInstr::Kind::Call)
+                {
+                    instr.dest = -1;
+                }
+            }
+            transfer(instr, live);
+        }
+
+        std::vector<IRInstr> kept;
+        for (size_t i = 0; i < instrs.size(); i++)
+        {
+            if (!isDead[i])
+            {
+                kept.push_back(std::move(instrs[i]));
+            }
+        }
+        removed = removed || kept.size() != instrs.size();
+        instrs.swap(kept);
+    }
+    return removed;
+}
+
+void Liveness::transfer(const IRInstr &instr, std::vector<bool> &live) const
+{
+    int slot = slotOf(instr);
+    if (instr.dest != -1)
+    {
+        live[instr.dest] = false;
+    }
+    if (instr.kind == IRInstr::Kind::Store && slot != -1)
+    {
+        live[slot] = false;
+    }
+    for (int reg : instr.getUses())
+    {
+        live[reg] = true;
+    }
+    if (instr.kind == IRInstr::Kind::Load && slot != -1)
+    {
+        live[slot] = true;
+    }
+}
+
+int Liveness::slotOf(const IRInstr &instr) const
+{
+    if ((instr.kind != IRInstr::Kind::Load && instr.kind != IRInstr::Kind::Store) || instr.base != IRInstr::Base::Frame)
+    {
+        return -1;
+    }
+    auto slot = m_slots.find(instr.offset);
+    return (slot != m_slots.end()) ? slot->second : -1;
+}
+
+void Liveness::setSlots(const IRFunc &func)
+{
+    m_regCount = func.regCount;
+    m_slots.clear();
+    for (int offset : func.scalars)
+    {
+        m_slots.insert({offset, m_regCount + (int)m_slots.size()});
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "IR.hpp"
+
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Backward liveness over each function's blocks and the dead code it finds.
+// A register is live where some path on to a use has not assigned it again,
+// a scalar local or parameter where some path reads its slot before a store
+// to it; nothing in the frame is live past a return. Blocks the entry cannot
+// reach are dropped, then stores to slots that are dead after them and
+// instructions whose register is dead after them are removed until none is
+// left. An instruction with side effects stays, a call only loses its result.
+class Liveness
+{
+    public:
+        // What is live on entry to and exit from each block, registers first and then scalars
+        struct Sets
+        {
+            std::vector<std::vector<bool>> in;
+            std::vector<std::vector<bool>> out;
+        };
+
+        Liveness();
+
+        // Getters
+        unsigned getUnreachableCount() const { return m_unreachableCount; }
+        unsigned getDeadStoreCount() const { return m_deadStoreCount; }
+        unsigned getDeadValueCount() const { return m_deadValueCount; }
+
+        // Helpers
+        void eliminate(IRProgram &program);         // Every function of program, the init only stores globals
+        Sets analyze(const IRFunc &func);
+
+        // Print
+        void printReport(std::ostream &out=std::cout) const;
+
+    private:
+        void eliminateFunc(IRFunc &func);
+        void removeUnreachable(IRFunc &func);
+        bool removeDead(IRFunc &func, const Sets &sets);       // Whether anything was removed
+        void transfer(const IRInstr &instr, std::vector<bool> &live) const;    // live after instr becomes live before it
+        int slotOf(const IRInstr &instr) const;                 // The scalar instr loads or stores, -1 for none
+        void setSlots(const IRFunc &func);
+
+        std::unordered_map<int, int> m_slots;       // Each scalar's frame offset to its place in a set
+        int m_regCount;
+        unsigned m_unreachableCount;
+        unsigned m_deadStoreCount;
+        unsigned m_deadValueCount;
+};
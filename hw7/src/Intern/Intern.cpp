@@ -0,0 +1,78 @@
+#include "Intern.hpp"
+
+#include <functional>
+
+Intern::Handle Intern::handle(const std::string_view name)
+{
+    Table &table = Intern::table();
+    if (table.slots.empty())
+    {
+        table.slots.assign(256, None);
+    }
+
+    size_t hash = std::hash<std::string_view>{}(name);
+    size_t slot = probe(table, name, hash);
+    if (table.slots[slot] != None)
+    {
+        return table.slots[slot];
+    }
+
+    table.strings.emplace_back(name);
+    table.hashes.push_back(hash);
+    table.slots[slot] = table.strings.size() - 1;
+
+    // Keep the load factor at or under a half so probe sequences stay short
+    if (table.strings.size() * 2 > table.slots.size())
+    {
+        grow(table);
+    }
+    return table.strings.size() - 1;
+}
+
+Intern::Handle Intern::find(const std::string_view name)
+{
+    const Table &table = Intern::table();
+    if (table.slots.empty())
+    {
+        return None;
+    }
+    return table.slots[probe(table, name, std::hash<std::string_view>{}(name))];
+}
+
+Intern::Table * Intern::setTable(Table *table)
+{
+    Table *previous = s_table;
+    s_table = table;
+    return previous;
+}
+
+size_t Intern::probe(const Table &table, const std::string_view name, const size_t hash)
+{
+    size_t mask = table.slots.size() - 1;
+    size_t slot = hash & mask;
+    while (table.slots[slot] != None)
+    {
+        Handle handle = table.slots[slot];
+        if (table.hashes[handle] == hash && table.strings[handle] == name)
+        {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void Intern::grow(Table &table)
+{
+    table.slots.assign(table.slots.size() * 2, None);
+    size_t mask = table.slots.size() - 1;
+    for (Handle handle = 0; handle < table.strings.size(); handle++)
+    {
+        size_t slot = table.hashes[handle] & mask;
+        while (table.slots[slot] != None)
+        {
+            slot = (slot + 1) & mask;
+        }
+        table.slots[slot] = handle;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Table of identifier spellings. Each distinct name is stored once and
+// referred to by a small integer handle, so passes compare and index names
+// without touching the characters. Every thread has its own table, handles
+// are only meaningful on the thread that made them, or on a thread that
+// borrows its table while it is not growing. A thread's own table is emptied
+// once its last compilation ends, see Compilation, so handles kept from one
+// compilation to the next need a table of their own, see Incremental.
+class Intern
+{
+    public:
+        typedef int Handle;
+        inline static const Handle None = -1;
+
+        struct Table
+        {
+            std::deque<std::string> strings;        // A deque so string() and view() stay valid as it grows
+            std::vector<size_t> hashes;
+            std::vector<Handle> slots;              // Open addressing into strings, None when empty
+        };
+
+        static Handle handle(const std::string_view name);          // Handle for name, interned if new
+        static Handle find(const std::string_view name);            // Handle for name, None if never interned
+        static const std::string & string(const Handle handle) { return table().strings[handle]; }
+        static std::string_view view(const Handle handle) { return table().strings[handle]; }
+        static int count() { return table().strings.size(); }
+        static Table & table() { return (s_table != nullptr) ? *s_table : s_own; }
+        static Table * setTable(Table *table);                      // Returns the table it replaces, nullptr restores this thread's own
+        static void reset() { s_own = Table(); }                    // Empties this thread's own table
+
+    private:
+        static size_t probe(const Table &table, const std::string_view name, const size_t hash);
+        static void grow(Table &table);
+
+        inline static thread_local Table s_own;
+        inline static thread_local Table *s_table = nullptr;
+};
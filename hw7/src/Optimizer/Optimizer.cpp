@@ -0,0 +1,377 @@
+#include "Optimizer.hpp"
+
+#include <climits>
+#include <cstdlib>
+
+Optimizer::Optimizer() : m_foldedCount(0), m_propagatedCount(0) {}
+
+void Optimizer::optimize(Node *node)
+{
+    // A global's initializer is checked to be constant already
+    for (; node != nullptr; node = node->getSibling())
+    {
+        if (isFunc(node))
+        {
+            optimizeFunc((Func *)node);
+        }
+    }
+}
+
+void Optimizer::printReport(std::ostream &out) const
+{
+    out << "Folded " << m_foldedCount << " expressions, propagated " << m_propagatedCount << " constants" << std::endl;
+}
+
+void Optimizer::optimizeFunc(Func *func)
+{
+    // A parameter's value is never known on entry
+    m_values.clear();
+    m_frames.clear();
+    traverse(func->getChild(1), [this](Node *node)
+    {
+        return enter(node);
+    }, [this](Node *node)
+    {
+        leave(node);
+    });
+}
+
+bool Optimizer::enter(Node *node)
+{
+    // Both branches of an if start from what is known after its condition
+    Node *parent = node->getParent();
+    if (!m_frames.empty() && m_frames.back().node == parent && isIf(parent))
+    {
+        Frame &frame = m_frames.back();
+        if (node == parent->getChild(1))
+        {
+            frame.values = m_values;
+        }
+        else if (node == parent->getChild(2))
+        {
+            frame.thenValues.swap(m_values);
+            m_values = frame.values;
+            frame.hasElse = true;
+        }
+    }
+
+    if (isIf(node))
+    {
+        m_frames.push_back({node, Values(), Values(), false});
+    }
+    else if (isWhile(node) || isFor(node))
+    {
+        forget(node);
+        m_frames.push_back({node, m_values, Values(), false});
+    }
+    return true;
+}
+
+void Optimizer::leave(Node *node)
+{
+    switch (node->getNodeKind())
+    {
+        case Node::Kind::Id:
+            propagate((Id *)node);
+            break;
+        case Node::Kind::Binary:
+            fold((Binary *)node);
+            break;
+        case Node::Kind::Unary:
+            fold((Unary *)node);
+            break;
+        case Node::Kind::Asgn:
+            assign((Asgn *)node);
+            break;
+        case Node::Kind::UnaryAsgn:
+            if (isId(node->getChild()))
+            {
+                m_values.erase(((Id *)node->getChild())->getDecl());
+            }
+            break;
+        case Node::Kind::Var:
+            initialize((Var *)node);
+            break;
+        case Node::Kind::If:
+        {
+            // Without an else the condition may skip straight past the then
+            Frame &frame = m_frames.back();
+            m_values = intersect(m_values, frame.hasElse ? frame.thenValues : frame.values);
+            m_frames.pop_back();
+            break;
+        }
+        case Node::Kind::While:
+        case Node::Kind::For:
+            m_values.swap(m_frames.back().values);
+            m_frames.pop_back();
+            break;
+        default:
+            break;
+    }
+}
+
+void Optimizer::forget(Node *loop)
+{
+    // The header runs again after the body, so only what neither assigns is known throughout
+    for (unsigned i = 0; i < loop->getChildCount(); i++)
+    {
+        traverse(loop->getChild(i), [this](Node *node)
+        {
+            if ((isAsgn(node) || isUnaryAsgn(node)) && isId(node->getChild()))
+            {
+                m_values.erase(((Id *)node->getChild())->getDecl());
+            }
+            return true;
+        });
+    }
+}
+
+void Optimizer::propagate(Id *id)
+{
+    // The name being assigned is not a use
+    Node *parent = id->getParent();
+    if ((isAsgn(parent) && parent->getChild() == id) || isUnaryAsgn(parent))
+    {
+        return;
+    }
+
+    auto value = m_values.find(id->getDecl());
+    if (value == m_values.end())
+    {
+        return;
+    }
+    Const *constN = new Const(id->getLineNum(), value->second.type, value->second.value);
+    id->replaceWith(constN);
+    NodePool::unit().free(id->getIndex());
+    m_propagatedCount++;
+}
+
+void Optimizer::fold(Binary *binary)
+{
+    // TM computes in 64 bits and stops on a zero divisor, its mod is never negative
+    Node *lhs = binary->getChild();
+    Node *rhs = binary->getChild(1);
+    if (binary->getType() == Binary::Type::Index || !isValue(lhs) || !isValue(rhs))
+    {
+        return;
+    }
+
+    long long l = valueOf((Const *)lhs);
+    long long r = valueOf((Const *)rhs);
+    long long value = 0;
+    switch (binary->getType())
+    {
+        case Binary::Type::Mul:
+            value = l * r;
+            break;
+        case Binary::Type::Div:
+            if (r == 0)
+            {
+                return;
+            }
+            value = l / r;
+            break;
+        case Binary::Type::Mod:
+            if (r == 0)
+            {
+                return;
+            }
+            value = l % r;
+            if (value < 0)
+            {
+                value += llabs(r);
+            }
+            break;
+        case Binary::Type::Add:
+            value = l + r;
+            break;
+        case Binary::Type::Sub:
+            value = l - r;
+            break;
+        case Binary::Type::And:
+            value = l & r;
+            break;
+        case Binary::Type::Or:
+            value = l | r;
+            break;
+        case Binary::Type::LT:
+            value = l < r;
+            break;
+        case Binary::Type::LEQ:
+            value = l <= r;
+            break;
+        case Binary::Type::GT:
+            value = l > r;
+            break;
+        case Binary::Type::GEQ:
+            value = l >= r;
+            break;
+        case Binary::Type::EQ:
+            value = l == r;
+            break;
+        case Binary::Type::NEQ:
+            value = l != r;
+            break;
+        default:
+            return;
+    }
+
+    if (replace(binary, value))
+    {
+        NodePool::unit().free(lhs->getIndex());
+        NodePool::unit().free(rhs->getIndex());
+        NodePool::unit().free(binary->getIndex());
+        m_foldedCount++;
+    }
+}
+
+void Optimizer::fold(Unary *unary)
+{
+    // ? is different every time, the size of an array parameter is only known when called
+    Node *child = unary->getChild();
+    long long value = 0;
+    switch (unary->getType())
+    {
+        case Unary::Type::Chsign:
+            if (!isValue(child))
+            {
+                return;
+            }
+            value = -valueOf((Const *)child);
+            break;
+        case Unary::Type::Not:
+            if (!isValue(child))
+            {
+                return;
+            }
+            value = valueOf((Const *)child) ^ 1;
+            break;
+        case Unary::Type::Sizeof:
+        {
+            Decl *decl = isId(child) ? ((Id *)child)->getDecl() : nullptr;
+            if (!isVar(decl) || !decl->getData()->getIsArray())
+            {
+                return;
+            }
+            value = decl->getMemSize() - 1;
+            break;
+        }
+        default:
+            return;
+    }
+
+    if (replace(unary, value))
+    {
+        NodePool::unit().free(child->getIndex());
+        NodePool::unit().free(unary->getIndex());
+        m_foldedCount++;
+    }
+}
+
+void Optimizer::assign(Asgn *asgn)
+{
+    // Its right side is already folded, anything but a plain assignment of a constant leaves the value unknown
+    Node *lhs = asgn->getChild();
+    if (!isId(lhs))
+    {
+        return;
+    }
+
+    const Decl *decl = ((Id *)lhs)->getDecl();
+    Node *rhs = asgn->getChild(1);
+    if (asgn->getType() == Asgn::Type::Asgn && isTracked(decl) && isValue(rhs))
+    {
+        m_values[decl] = {((Const *)rhs)->getType(), (int)valueOf((Const *)rhs)};
+    }
+    else
+    {
+        m_values.erase(decl);
+    }
+}
+
+void Optimizer::initialize(Var *var)
+{
+    // A local declared without a value holds whatever its memory did
+    Node *value = var->getChild();
+    if (isTracked(var) && isValue(value))
+    {
+        m_values[var] = {((Const *)value)->getType(), (int)valueOf((Const *)value)};
+    }
+    else
+    {
+        m_values.erase(var);
+    }
+}
+
+bool Optimizer::replace(Exp *exp, const long long value)
+{
+    // LDC only loads an int
+    if (value < INT_MIN || value > INT_MAX)
+    {
+        return false;
+    }
+
+    Const::Type type;
+    switch (exp->getData()->getType())
+    {
+        case Data::Type::Int:
+            type = Const::Type::Int;
+            break;
+        case Data::Type::Bool:
+            type = Const::Type::Bool;
+            break;
+        case Data::Type::Char:
+            type = Const::Type::Char;
+            break;
+        default:
+            return false;
+    }
+    exp->replaceWith(new Const(exp->getLineNum(), type, (int)value));
+    return true;
+}
+
+bool Optimizer::isTracked(const Decl *decl)
+{
+    // Only a function's own scalars cannot change behind its back
+    if (decl == nullptr || decl->getData()->getIsArray() || decl->getData()->getIsStatic())
+    {
+        return false;
+    }
+    Node::MemScope memScope = decl->getMemScope();
+    return memScope == Node::MemScope::Local || memScope == Node::MemScope::Parameter;
+}
+
+bool Optimizer::isValue(const Node *node)
+{
+    return isConst(node) && ((const Const *)node)->getType() != Const::Type::String;
+}
+
+long long Optimizer::valueOf(const Const *constN)
+{
+    // As LDC loads it
+    switch (constN->getType())
+    {
+        case Const::Type::Int:
+            return constN->getIntValue();
+        case Const::Type::Bool:
+            return constN->getBoolValue();
+        case Const::Type::Char:
+            return (int)(constN->getCharValue());
+        default:
+            throw std::runtime_error("Optimizer::valueOf() - A string has no value");
+    }
+}
+
+Optimizer::Values Optimizer::intersect(const Values &a, const Values &b)
+{
+    Values values;
+    for (const auto &[decl, value] : a)
+    {
+        auto other = b.find(decl);
+        if (other != b.end() && other->second.type == value.type && other->second.value == value.value)
+        {
+            values[decl] = value;
+        }
+    }
+    return values;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../Semantics/Is.hpp"
+#include "../Tree/Traverse.hpp"
+#include "../Tree/Tree.hpp"
+
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+// Rewrites analyzed function bodies before code generation. An operator
+// whose operands are int, bool or char constants is replaced by the constant
+// TM would compute, unless TM would stop on it or the result does not fit in
+// a load. A local or parameter holds a known constant from the assignment
+// that gave it one until it is assigned again; a use of it on the way is
+// replaced by that constant. What is known flows through an if along both
+// branches and keeps only what they agree on, a loop forgets everything its
+// body or header assigns.
+class Optimizer
+{
+    public:
+        Optimizer();
+
+        // Getters
+        unsigned getFoldedCount() const { return m_foldedCount; }
+        unsigned getPropagatedCount() const { return m_propagatedCount; }
+
+        // Helpers
+        void optimize(Node *node);                  // Every function of node and its siblings
+
+        // Print
+        void printReport(std::ostream &out=std::cout) const;
+
+    private:
+        struct Value
+        {
+            Const::Type type;
+            int value;
+        };
+        typedef std::unordered_map<const Decl *, Value> Values;
+
+        // The values known on entry to an if's branch or a loop
+        struct Frame
+        {
+            Node *node;
+            Values values;
+            Values thenValues;                      // Once an if's else is reached
+            bool hasElse;
+        };
+
+        void optimizeFunc(Func *func);
+        bool enter(Node *node);
+        void leave(Node *node);
+        void forget(Node *loop);
+        void propagate(Id *id);
+        void fold(Binary *binary);
+        void fold(Unary *unary);
+        void assign(Asgn *asgn);
+        void initialize(Var *var);
+        bool replace(Exp *exp, const long long value);     // False if the value cannot be a constant of exp's type
+
+        // Static
+        static bool isTracked(const Decl *decl);
+        static bool isValue(const Node *node);
+        static long long valueOf(const Const *constN);
+        static Values intersect(const Values &a, const Values &b);
+
+        Values m_values;
+        std::vector<Frame> m_frames;
+        unsigned m_foldedCount;
+        unsigned m_propagatedCount;
+};
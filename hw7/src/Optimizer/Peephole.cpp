@@ -0,0 +1,273 @@
+#include "Peephole.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+const Peephole::Rule Peephole::s_rules[] =
+{
+    {"jump to the next instruction", &Peephole::matchJumpToNext},
+    {"copy of a register to itself", &Peephole::matchSelfCopy},
+    {"load of what was just stored", &Peephole::matchReloadAfterStore},
+    {"load of a constant already loaded", &Peephole::matchKnownConstant},
+    {"copy or constant never read", &Peephole::matchDeadCopy},
+};
+
+void Peephole::optimize(EmitCode &code, std::vector<std::pair<int, std::string>> funcs, const int end)
+{
+    // Functions are laid out one after another, each round removes what it can from all of them at once
+    std::sort(funcs.begin(), funcs.end());
+    std::vector<std::pair<int, int>> ranges;
+    size_t first = m_funcs.size();
+    for (size_t i = 0; i < funcs.size(); i++)
+    {
+        int next = (i + 1 < funcs.size()) ? funcs[i + 1].first : end;
+        ranges.push_back({funcs[i].first, next});
+        m_funcs.push_back({funcs[i].second, next - funcs[i].first, next - funcs[i].first});
+    }
+
+    while (true)
+    {
+        std::vector<bool> removed(code.emitWhereAmI(), false);
+        std::vector<int> counts(ranges.size());
+        int total = 0;
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            counts[i] = removeRound(code, ranges[i].first, ranges[i].second, removed);
+            total += counts[i];
+        }
+        if (total == 0)
+        {
+            break;
+        }
+
+        code.removeInstructions(removed);
+        int shift = 0;
+        for (size_t i = 0; i < ranges.size(); i++)
+        {
+            ranges[i].first -= shift;
+            shift += counts[i];
+            ranges[i].second -= shift;
+            m_funcs[first + i].after -= counts[i];
+        }
+    }
+    m_code = nullptr;
+}
+
+void Peephole::printReport(std::ostream &out) const
+{
+    int before = 0;
+    int after = 0;
+    for (const Func &func : m_funcs)
+    {
+        out << "Peephole " << std::left << std::setw(16) << func.name << std::right << std::setw(6) << func.before << " -> " << std::setw(6) << func.after << " instructions" << std::endl;
+        before += func.before;
+        after += func.after;
+    }
+    out << "Peephole removed " << before - after << " of " << before << " instructions" << std::endl;
+}
+
+int Peephole::removeRound(EmitCode &code, const int begin, const int end, std::vector<bool> &removed)
+{
+    // Only a call enters a function from outside, and only at its start
+    m_code = &code;
+    m_begin = begin;
+    m_end = end;
+    m_isTarget.assign(end - begin, false);
+    m_isTarget[0] = true;
+    for (int loc = begin; loc < end; loc++)
+    {
+        const Instruction &instruction = code.getInstruction(loc);
+        if (instruction.format == Instruction::Format::RM && instruction.t == PC && instruction.op != "LDC")
+        {
+            long long int target = loc + 1 + instruction.s;
+            if (target >= begin && target < end)
+            {
+                m_isTarget[target - begin] = true;
+            }
+        }
+    }
+
+    // A match may not look at anything an earlier match this round looked at
+    int count = 0;
+    int fence = begin - 1;
+    for (int loc = begin; loc < end; loc++)
+    {
+        for (const Rule &rule : s_rules)
+        {
+            Match match;
+            if ((this->*rule.match)(loc, match) && match.first > fence)
+            {
+                removed[match.removed] = true;
+                fence = std::max(match.last, match.removed);
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+bool Peephole::matchJumpToNext(const int loc, Match &match) const
+{
+    if (!isJumpToNext(m_code->getInstruction(loc)))
+    {
+        return false;
+    }
+    match = {loc, loc, loc};
+    return true;
+}
+
+bool Peephole::matchSelfCopy(const int loc, Match &match) const
+{
+    const Instruction &instruction = m_code->getInstruction(loc);
+    if (instruction.op != "LDA" || instruction.s != 0 || instruction.t != instruction.r || instruction.r == PC)
+    {
+        return false;
+    }
+    match = {loc, loc, loc};
+    return true;
+}
+
+bool Peephole::matchReloadAfterStore(const int loc, Match &match) const
+{
+    // The register still holds what went to memory, unless another path leads to the load
+    if (loc == m_begin || m_isTarget[loc - m_begin])
+    {
+        return false;
+    }
+    const Instruction &store = m_code->getInstruction(loc - 1);
+    const Instruction &load = m_code->getInstruction(loc);
+    if (store.op != "ST" || load.op != "LD" || store.r != load.r || store.s != load.s || store.t != load.t || load.t == PC || load.r == PC)
+    {
+        return false;
+    }
+    match = {loc - 1, loc, loc};
+    return true;
+}
+
+bool Peephole::matchKnownConstant(const int loc, Match &match) const
+{
+    // Back through the run that ends here to the last write of the register
+    const Instruction &load = m_code->getInstruction(loc);
+    if (load.op != "LDC" || load.r == PC || m_isTarget[loc - m_begin])
+    {
+        return false;
+    }
+    for (int at = loc - 1; at >= std::max(m_begin, loc - s_window); at--)
+    {
+        const Instruction &instruction = m_code->getInstruction(at);
+        Effect effect = effectOf(instruction);
+        if (effect.jumps)
+        {
+            return false;
+        }
+        if (effect.writes & (1u << load.r))
+        {
+            if (instruction.op != "LDC" || instruction.s != load.s)
+            {
+                return false;
+            }
+            match = {at, loc, loc};
+            return true;
+        }
+        if (m_isTarget[at - m_begin])
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool Peephole::matchDeadCopy(const int loc, Match &match) const
+{
+    // Forward to whatever replaces the value, every path from here goes the same way until a jump
+    const Instruction &copy = m_code->getInstruction(loc);
+    if ((copy.op != "LDA" && copy.op != "LDC") || copy.r == PC)
+    {
+        return false;
+    }
+    for (int at = loc + 1; at < std::min(m_end, loc + 1 + s_window); at++)
+    {
+        Effect effect = effectOf(m_code->getInstruction(at));
+        if (effect.reads & (1u << copy.r))
+        {
+            return false;
+        }
+        if (effect.writes & (1u << copy.r))
+        {
+            match = {loc, at, loc};
+            return true;
+        }
+        if (effect.jumps)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+Peephole::Effect Peephole::effectOf(const Instruction &instruction)
+{
+    // Anything not listed may do anything
+    static const char *operators[] = {"ADD", "SUB", "MUL", "DIV", "MOD", "AND", "OR", "XOR", "TLT", "TLE", "TGT", "TGE", "TEQ", "TNE"};
+    const unsigned all = ~0u;
+    unsigned r = 1u << instruction.r;
+    const std::string &op = instruction.op;
+    Effect effect = {all, all, true};
+    if (instruction.format == Instruction::Format::RM)
+    {
+        unsigned base = 1u << instruction.t;
+        if (op == "LDC")
+        {
+            effect = {0, r, false};
+        }
+        else if (op == "LD" || op == "LDA")
+        {
+            effect = {base, r, instruction.r == PC};
+        }
+        else if (op == "ST")
+        {
+            effect = {r | base, 0, false};
+        }
+        else if (op == "JMP" || op == "JZR" || op == "JNZ")
+        {
+            effect = {r | base, 0, true};
+        }
+    }
+    else if (instruction.format == Instruction::Format::RO)
+    {
+        unsigned s = 1u << instruction.s;
+        unsigned t = 1u << instruction.t;
+        if (std::find_if(std::begin(operators), std::end(operators), [&op](const char *each) { return op == each; }) != std::end(operators))
+        {
+            effect = {s | t, r, instruction.r == PC};
+        }
+        else if (op == "NEG" || op == "NOT")
+        {
+            effect = {s, r, instruction.r == PC};
+        }
+        else if (op == "IN" || op == "INB" || op == "INC")
+        {
+            effect = {0, r, instruction.r == PC};
+        }
+        else if (op == "OUT" || op == "OUTB" || op == "OUTC")
+        {
+            effect = {r, 0, false};
+        }
+        else if (op == "OUTNL")
+        {
+            effect = {0, 0, false};
+        }
+    }
+    return effect;
+}
+
+bool Peephole::isJumpToNext(const Instruction &instruction)
+{
+    // Taken or not, it goes on to the next instruction
+    if (instruction.format != Instruction::Format::RM || instruction.t != PC || instruction.s != 0)
+    {
+        return false;
+    }
+    return instruction.op == "JMP" || instruction.op == "JZR" || instruction.op == "JNZ" || (instruction.op == "LDA" && instruction.r == PC);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "../CodeGen/EmitCode/EmitCode.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Removes TM instructions that cannot change what a program does, looking
+// at a few instructions at a time. Each rule of the table names one such
+// instruction; rules are applied to every function until none matches, and
+// every pc-relative jump is then pointed at where its target moved. An
+// instruction another one jumps to starts a new run, a rule never reasons
+// about what came before it.
+class Peephole
+{
+    public:
+        struct Func
+        {
+            std::string name;
+            int before;                             // Its number of instructions
+            int after;
+        };
+
+        // Getters
+        const std::vector<Func> & getFuncs() const { return m_funcs; }
+
+        // Helpers
+        void optimize(EmitCode &code, std::vector<std::pair<int, std::string>> funcs, const int end);  // Each function runs from its location to the next one's, the last one to end
+
+        // Print
+        void printReport(std::ostream &out=std::cout) const;
+
+    private:
+        // The instructions a rule looked at, the one it removes among them
+        struct Match
+        {
+            int first;
+            int last;
+            int removed;
+        };
+
+        // What an instruction does to the registers, as bit masks
+        struct Effect
+        {
+            unsigned reads;
+            unsigned writes;
+            bool jumps;                             // Control may not reach the next instruction
+        };
+
+        struct Rule
+        {
+            const char *name;
+            bool (Peephole::*match)(const int loc, Match &match) const;
+        };
+
+        int removeRound(EmitCode &code, const int begin, const int end, std::vector<bool> &removed);   // How many of the function's instructions it marked
+        bool matchJumpToNext(const int loc, Match &match) const;
+        bool matchSelfCopy(const int loc, Match &match) const;
+        bool matchReloadAfterStore(const int loc, Match &match) const;
+        bool matchKnownConstant(const int loc, Match &match) const;
+        bool matchDeadCopy(const int loc, Match &match) const;
+
+        // Static
+        static Effect effectOf(const Instruction &instruction);
+        static bool isJumpToNext(const Instruction &instruction);
+
+        const EmitCode *m_code = nullptr;
+        std::vector<bool> m_isTarget;
+        int m_begin = 0;
+        int m_end = 0;
+        std::vector<Func> m_funcs;
+
+        static const Rule s_rules[];
+        static const int s_window = 32;            // How far a rule looks for what makes an instruction redundant
+};
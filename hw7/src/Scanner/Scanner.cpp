@@ -0,0 +1,438 @@
+#include "Scanner.hpp"
+#include "../TokenData.hpp"
+#include "../Compilation/Compilation.hpp"
+#include "../Tree/Tree.hpp"
+#include "../c-.tab.h"
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    struct Keyword
+    {
+        const char *text;
+        int tokenClass;
+    };
+
+    // Every keyword lands in its own slot of (first * 7 + second * 2 + length) % 32
+    Keyword keywordTable[32];
+
+    int keywordSlot(const std::string_view text)
+    {
+        return ((unsigned char)text[0] * 7 + (unsigned char)text[1] * 2 + text.size()) & 31;
+    }
+
+    bool fillKeywordTable()
+    {
+        const Keyword keywords[] = {
+            {"int", INT}, {"bool", BOOL}, {"char", CHAR}, {"static", STATIC},
+            {"if", IF}, {"then", THEN}, {"else", ELSE}, {"while", WHILE},
+            {"for", FOR}, {"to", TO}, {"by", BY}, {"do", DO},
+            {"return", RETURN}, {"break", BREAK}, {"and", AND}, {"or", OR},
+            {"not", NOT}, {"true", BOOLCONST}, {"false", BOOLCONST}
+        };
+        for (const Keyword &keyword : keywords)
+        {
+            keywordTable[keywordSlot(keyword.text)] = keyword;
+        }
+        return true;
+    }
+
+    const bool keywordTableFilled = fillKeywordTable();
+
+    bool isAlpha(const char c)
+    {
+        return (unsigned char)((c | 0x20) - 'a') < 26;
+    }
+
+    bool isDigit(const char c)
+    {
+        return (unsigned char)(c - '0') < 10;
+    }
+
+#if defined(__AVX2__)
+    typedef __m256i Vector;
+    const size_t vectorSize = 32;
+    Vector load(const char *p) { return _mm256_loadu_si256((const Vector *)p); }
+    Vector splat(const char c) { return _mm256_set1_epi8(c); }
+    Vector equal(const Vector a, const Vector b) { return _mm256_cmpeq_epi8(a, b); }
+    Vector greater(const Vector a, const Vector b) { return _mm256_cmpgt_epi8(a, b); }
+    Vector both(const Vector a, const Vector b) { return _mm256_and_si256(a, b); }
+    Vector either(const Vector a, const Vector b) { return _mm256_or_si256(a, b); }
+    uint32_t mask(const Vector a) { return (uint32_t)_mm256_movemask_epi8(a); }
+#elif defined(__SSE2__)
+    typedef __m128i Vector;
+    const size_t vectorSize = 16;
+    Vector load(const char *p) { return _mm_loadu_si128((const Vector *)p); }
+    Vector splat(const char c) { return _mm_set1_epi8(c); }
+    Vector equal(const Vector a, const Vector b) { return _mm_cmpeq_epi8(a, b); }
+    Vector greater(const Vector a, const Vector b) { return _mm_cmpgt_epi8(a, b); }
+    Vector both(const Vector a, const Vector b) { return _mm_and_si128(a, b); }
+    Vector either(const Vector a, const Vector b) { return _mm_or_si128(a, b); }
+    uint32_t mask(const Vector a) { return (uint32_t)_mm_movemask_epi8(a) | 0xffff0000u; }
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    // Bytes in [low, high], the comparisons are signed so both must be ASCII
+    Vector inRange(const Vector v, const char low, const char high)
+    {
+        return both(greater(v, splat(low - 1)), greater(splat(high + 1), v));
+    }
+
+    // Index of the first byte of a mask that is not set, vectorSize if all are
+    size_t firstClear(const uint32_t set)
+    {
+        return (~set == 0) ? vectorSize : __builtin_ctz(~set);
+    }
+#endif
+}
+
+Scanner::Scanner(Compilation *compilation) : m_compilation(compilation), m_base(nullptr), m_size(0), m_pos(0) {}
+
+TokenData * Scanner::makeToken(Compilation *compilation, const int tokenClass, const std::string_view text)
+{
+    // Tokens live in the arena, a buffer scanned in place outlives the tree so they can point into it
+    TokenData *tokenData = new TokenData;
+    tokenData->lineNum = compilation->getLineCount();
+    tokenData->tokenContent = std::string_view();
+    tokenData->name = Intern::None;
+    if (tokenClass == ID)
+    {
+        tokenData->name = Intern::handle(text);
+    }
+    else if (compilation->getScanningInPlace())
+    {
+        tokenData->tokenContent = text;
+    }
+    else
+    {
+        tokenData->tokenContent = std::string_view(Arena::unit().copy(text), text.size());
+    }
+
+    // A streamed buffer is reused, so the last token is kept from the copy
+    if (compilation->getScanningInPlace())
+    {
+        compilation->setLastToken(text);
+    }
+    else
+    {
+        compilation->setLastToken(tokenClass == ID ? Intern::view(tokenData->name) : tokenData->tokenContent);
+    }
+
+    if (tokenClass == CHARCONST)
+    {
+        std::string chars = Const::removeFirstAndLastChar(std::string(text));
+        if (chars.length() > 1 && chars[0] != '\\')
+        {
+            std::stringstream msg;
+            msg << "character is " << chars.length() << " characters long and not a single character: '" << text << "'.  The first char will be used.";
+            Emit::warn(compilation->getLineCount(), msg.str());
+        }
+    }
+
+    return tokenData;
+}
+
+void Scanner::scanInPlace(const char *base, const size_t size)
+{
+    m_base = base;
+    m_size = size - 2;
+    m_pos = 0;
+}
+
+int Scanner::next(TokenData *&tokenData)
+{
+    const char *s = m_base;
+    while (true)
+    {
+        m_pos = skipBlanks(m_pos);
+        if (m_pos >= m_size)
+        {
+            return 0;
+        }
+
+        const size_t start = m_pos;
+        const char c = s[start];
+        if (c == '\n')
+        {
+            m_compilation->incLineCount();
+            m_pos++;
+            continue;
+        }
+
+        // A comment runs through its newline, without one the slashes are operators
+        if (c == '/' && s[start + 1] == '/')
+        {
+            size_t newline = findNewline(start + 2);
+            if (newline < m_size)
+            {
+                m_compilation->incLineCount();
+                m_pos = newline + 1;
+                continue;
+            }
+        }
+
+        size_t end = 0;
+        int tokenClass = 0;
+        if (isAlpha(c))
+        {
+            end = skipAlnum(start + 1);
+            tokenClass = matchKeyword(std::string_view(s + start, end - start));
+            if (tokenClass == INT || tokenClass == BOOL || tokenClass == CHAR)
+            {
+                m_pos = end;
+                return tokenClass;
+            }
+            if (tokenClass == 0)
+            {
+                tokenClass = ID;
+            }
+        }
+        else if (isDigit(c))
+        {
+            end = skipDigits(start + 1);
+            tokenClass = NUMCONST;
+        }
+        else if (c == '"')
+        {
+            end = matchString(start);
+            tokenClass = (end != 0) ? STRINGCONST : 0;
+        }
+        else if (c == '\'')
+        {
+            if (s[start + 1] == '\'')
+            {
+                Emit::error(m_compilation->getLineCount(), "Empty character ''.  Characters ignored.");
+                m_pos = start + 2;
+                continue;
+            }
+            end = matchChar(start);
+            tokenClass = (end != 0) ? CHARCONST : 0;
+        }
+        else
+        {
+            size_t length = 0;
+            tokenClass = matchOperator(start, length);
+            end = start + length;
+        }
+
+        if (tokenClass == 0)
+        {
+            std::stringstream msg;
+            msg << "Invalid or misplaced input character: '" << c << "'. Character Ignored.";
+            Emit::error(m_compilation->getLineCount(), msg.str(), true);
+            m_pos = start + 1;
+            continue;
+        }
+
+        m_pos = end;
+        tokenData = makeToken(m_compilation, tokenClass, std::string_view(s + start, end - start));
+        return tokenClass;
+    }
+}
+
+size_t Scanner::skipBlanks(size_t pos) const
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (pos + vectorSize <= m_size)
+    {
+        Vector v = load(m_base + pos);
+        size_t skip = firstClear(mask(either(equal(v, splat(' ')), equal(v, splat('\t')))));
+        pos += skip;
+        if (skip < vectorSize)
+        {
+            return pos;
+        }
+    }
+#endif
+    while (pos < m_size && (m_base[pos] == ' ' || m_base[pos] == '\t'))
+    {
+        pos++;
+    }
+    return pos;
+}
+
+size_t Scanner::findNewline(size_t pos) const
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (pos + vectorSize <= m_size)
+    {
+        uint32_t newlines = mask(equal(load(m_base + pos), splat('\n')));
+        if (vectorSize == 16)
+        {
+            newlines &= 0xffff;
+        }
+        if (newlines != 0)
+        {
+            return pos + __builtin_ctz(newlines);
+        }
+        pos += vectorSize;
+    }
+#endif
+    while (pos < m_size && m_base[pos] != '\n')
+    {
+        pos++;
+    }
+    return pos;
+}
+
+size_t Scanner::skipAlnum(size_t pos) const
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (pos + vectorSize <= m_size)
+    {
+        Vector v = load(m_base + pos);
+        Vector lower = either(v, splat(0x20));
+        size_t skip = firstClear(mask(either(inRange(lower, 'a', 'z'), inRange(v, '0', '9'))));
+        pos += skip;
+        if (skip < vectorSize)
+        {
+            return pos;
+        }
+    }
+#endif
+    while (pos < m_size && (isAlpha(m_base[pos]) || isDigit(m_base[pos])))
+    {
+        pos++;
+    }
+    return pos;
+}
+
+size_t Scanner::skipDigits(size_t pos) const
+{
+#if defined(__AVX2__) || defined(__SSE2__)
+    while (pos + vectorSize <= m_size)
+    {
+        size_t skip = firstClear(mask(inRange(load(m_base + pos), '0', '9')));
+        pos += skip;
+        if (skip < vectorSize)
+        {
+            return pos;
+        }
+    }
+#endif
+    while (pos < m_size && isDigit(m_base[pos]))
+    {
+        pos++;
+    }
+    return pos;
+}
+
+// \"([^\\"\n]|\\.)*\"
+size_t Scanner::matchString(const size_t pos) const
+{
+    size_t end = pos + 1;
+    while (end < m_size)
+    {
+        const char c = m_base[end];
+        if (c == '"')
+        {
+            return end + 1;
+        }
+        if (c == '\n')
+        {
+            return 0;
+        }
+        if (c == '\\')
+        {
+            if (end + 1 >= m_size || m_base[end + 1] == '\n')
+            {
+                return 0;
+            }
+            end++;
+        }
+        end++;
+    }
+    return 0;
+}
+
+// \'((\\\')|([^\n\']))*\' taking the longest match like flex. A backslash
+// quote may be an escape or a backslash then the closing quote, so the body
+// can be reached at two positions at once; track whether each is reachable.
+size_t Scanner::matchChar(const size_t pos) const
+{
+    size_t longest = 0;
+    bool before = false;                // the body reaches end - 1
+    bool here = true;                   // the body reaches end
+    for (size_t end = pos + 1; end < m_size && (here || before); end++)
+    {
+        const char c = m_base[end];
+        const char previous = m_base[end - 1];
+        bool after = (here && c != '\n' && c != '\'') || (before && previous == '\\' && c == '\'');
+        if (here && c == '\'')
+        {
+            longest = end + 1;
+        }
+        before = here;
+        here = after;
+    }
+    return longest;
+}
+
+int Scanner::matchKeyword(const std::string_view text) const
+{
+    if (text.size() < 2 || text.size() > 6)
+    {
+        return 0;
+    }
+    const Keyword &keyword = keywordTable[keywordSlot(text)];
+    if (keyword.text == nullptr || strlen(keyword.text) != text.size() || memcmp(keyword.text, text.data(), text.size()) != 0)
+    {
+        return 0;
+    }
+    return keyword.tokenClass;
+}
+
+int Scanner::matchOperator(const size_t pos, size_t &length) const
+{
+    const char next = m_base[pos + 1];
+    length = 1;
+    switch (m_base[pos])
+    {
+        case '{': return LCURLY;
+        case '}': return RCURLY;
+        case '(': return LPAREN;
+        case ')': return RPAREN;
+        case '[': return LBRACK;
+        case ']': return RBRACK;
+        case '%': return MOD;
+        case ';': return SEMICOLON;
+        case ':': return COLON;
+        case ',': return COMMA;
+        case '?': return QUESTION;
+        case '+':
+            length = (next == '+' || next == '=') ? 2 : 1;
+            return (next == '+') ? INC : (next == '=') ? ADDASGN : ADD;
+        case '-':
+            length = (next == '-' || next == '=') ? 2 : 1;
+            return (next == '-') ? DEC : (next == '=') ? SUBASGN : SUB;
+        case '*':
+            length = (next == '=') ? 2 : 1;
+            return (next == '=') ? MULASGN : MUL;
+        case '/':
+            length = (next == '=') ? 2 : 1;
+            return (next == '=') ? DIVASGN : DIV;
+        case '=':
+            length = (next == '=') ? 2 : 1;
+            return (next == '=') ? EQ : ASGN;
+        case '<':
+            length = (next == '=') ? 2 : 1;
+            return (next == '=') ? LEQ : LT;
+        case '>':
+            length = (next == '=') ? 2 : 1;
+            return (next == '=') ? GEQ : GT;
+        case '!':
+            length = 2;
+            return (next == '=') ? NEQ : 0;
+    }
+    return 0;
+}
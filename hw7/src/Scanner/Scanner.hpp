@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+class Compilation;
+struct TokenData;
+
+// Hand-written stand-in for the flex scanner in c-.l, producing the same
+// tokens, line numbers and diagnostics. It scans a NUL padded buffer in
+// place, skipping blanks and comments and measuring identifier and number
+// runs 16 or 32 bytes at a time where SSE2 or AVX2 is available, and finds
+// keywords with a perfect hash instead of a DFA.
+class Scanner
+{
+    public:
+        Scanner(Compilation *compilation);
+
+        // Static
+        static TokenData * makeToken(Compilation *compilation, const int tokenClass, const std::string_view text); // Shared with c-.l
+
+        // Helpers
+        void scanInPlace(const char *base, const size_t size);     // The last two of size bytes must be NUL
+        bool getIsLoaded() const { return m_base != nullptr; }
+        int next(TokenData *&tokenData);                            // The next token class, 0 at the end of input
+
+    private:
+        size_t skipBlanks(size_t pos) const;
+        size_t findNewline(size_t pos) const;
+        size_t skipAlnum(size_t pos) const;
+        size_t skipDigits(size_t pos) const;
+        size_t matchString(const size_t pos) const;                 // End of the literal starting at pos, 0 if none
+        size_t matchChar(const size_t pos) const;
+        int matchKeyword(const std::string_view text) const;        // 0 if text is an identifier
+        int matchOperator(const size_t pos, size_t &length) const;  // 0 if no operator starts at pos
+
+        Compilation *m_compilation;
+        const char *m_base;
+        size_t m_size;                                              // Excluding the two NULs
+        size_t m_pos;
+};
@@ -1,64 +1,207 @@
 #include "Emit.hpp"
 
+#include <cstdio>
+
+Emit::Emit(std::ostream &out, const Emit *scanned) : m_out(&out), m_scanned(scanned), m_errorCount(0), m_warnCount(0), m_verbose(true), m_buffered(true), m_format(Format::Text) {}
+
+Emit & Emit::unit()
+{
+    static thread_local Emit fallback;
+    return (s_unit != nullptr) ? *s_unit : fallback;
+}
+
+Emit * Emit::setUnit(Emit *emit)
+{
+    Emit *previous = s_unit;
+    s_unit = emit;
+    return previous;
+}
+
 void Emit::error(const std::string type, const std::string msg)
 {
-    if (s_verbose)
+    Emit &emit = unit();
+    emit.report(Severity::Error, 0, type, msg);
+    emit.m_errorCount++;
+}
+
+void Emit::error(const int lineNum, const std::string msg, const bool isMisplaceChar)
+{
+    Emit &emit = unit();
+    if (isMisplaceChar)
     {
-        std::cout << "ERROR(" << type << "): " << msg << std::endl;
+        emit.m_misplacedChars.insert(lineNum);
     }
-    s_errorCount++;
+    emit.report(Severity::Error, lineNum, "", msg);
+    emit.m_errorCount++;
 }
 
-void Emit::error(const int lineNum, const std::string msg, const bool isMisplaceChar)
+void Emit::incErrorCount(unsigned count)
 {
-    if (isMisplaceChar && !std::count(s_misplacedChars.begin(), s_misplacedChars.end(), lineNum))
+    unit().m_errorCount += count;
+}
+
+void Emit::warn(const std::string type, const std::string msg)
+{
+    Emit &emit = unit();
+    emit.report(Severity::Warning, 0, type, msg);
+    emit.m_warnCount++;
+}
+
+void Emit::warn(const int lineNum, const std::string msg)
+{
+    // Warnings on a line with a misplaced character are dropped
+    Emit &emit = unit();
+    if (!emit.isMisplaced(lineNum))
+    {
+        emit.report(Severity::Warning, lineNum, "", msg);
+        emit.m_warnCount++;
+    }
+}
+
+void Emit::incWarnCount(unsigned count)
+{
+    unit().m_warnCount += count;
+}
+
+void Emit::flush()
+{
+    Emit &emit = unit();
+    if (emit.m_diagnostics.empty())
     {
-        s_misplacedChars.push_back(lineNum);
+        return;
     }
 
-    if (s_verbose)
+    for (const Diagnostic &diagnostic : emit.m_diagnostics)
     {
-        std::cout << "ERROR(" << lineNum << "): " << msg << std::endl;
+        emit.render(diagnostic);
     }
-    s_errorCount++;
+    std::vector<Diagnostic>().swap(emit.m_diagnostics);
+    emit.m_out->flush();
 }
 
-void Emit::incErrorCount(unsigned count)
+void Emit::count()
 {
-    s_errorCount += count;
+    flush();
+
+    Emit &emit = unit();
+    if (!emit.m_verbose)
+    {
+        return;
+    }
+    if (emit.m_format == Format::Json)
+    {
+        *emit.m_out << "{\"warnings\":" << emit.m_warnCount << ",\"errors\":" << emit.m_errorCount << "}" << std::endl;
+        return;
+    }
+    *emit.m_out << "Number of warnings: " << emit.m_warnCount << "\n";
+    *emit.m_out << "Number of errors: " << emit.m_errorCount << std::endl;
 }
 
-void Emit::warn(const std::string type, const std::string msg)
+void Emit::append(Emit &emit)
 {
-    if (s_verbose)
+    if (m_diagnostics.empty())
+    {
+        m_diagnostics.swap(emit.m_diagnostics);
+    }
+    else
     {
-        std::cout << "WARNING(" << type << "): " << msg << std::endl;
+        m_diagnostics.insert(m_diagnostics.end(), std::make_move_iterator(emit.m_diagnostics.begin()), std::make_move_iterator(emit.m_diagnostics.end()));
+        emit.m_diagnostics.clear();
     }
-    s_warnCount++;
+    m_errorCount += emit.m_errorCount;
+    m_warnCount += emit.m_warnCount;
 }
 
-void Emit::warn(const int lineNum, const std::string msg)
+void Emit::report(const Severity severity, const int lineNum, const std::string &tag, const std::string &msg)
+{
+    if (!m_verbose)
+    {
+        return;
+    }
+
+    Diagnostic diagnostic = {severity, lineNum, tag, msg};
+    if (m_buffered)
+    {
+        m_diagnostics.push_back(std::move(diagnostic));
+    }
+    else
+    {
+        render(diagnostic);
+    }
+}
+
+void Emit::render(const Diagnostic &diagnostic) const
 {
-    if (!std::count(s_misplacedChars.begin(), s_misplacedChars.end(), lineNum))
+    std::ostream &out = *m_out;
+    bool isError = diagnostic.severity == Severity::Error;
+    if (m_format == Format::Json)
     {
-        if (s_verbose)
+        out << "{\"severity\":\"" << (isError ? "error" : "warning") << "\",";
+        if (diagnostic.lineNum != 0)
+        {
+            out << "\"line\":" << diagnostic.lineNum;
+        }
+        else
         {
-            std::cout << "WARNING(" << lineNum << "): " << msg << std::endl;
+            out << "\"tag\":\"" << escape(diagnostic.tag) << "\"";
         }
-        s_warnCount++;
+        out << ",\"message\":\"" << escape(diagnostic.msg) << "\"}\n";
+        return;
+    }
+
+    out << (isError ? "ERROR(" : "WARNING(");
+    if (diagnostic.lineNum != 0)
+    {
+        out << diagnostic.lineNum;
     }
+    else
+    {
+        out << diagnostic.tag;
+    }
+    out << "): " << diagnostic.msg << "\n";
 }
 
-void Emit::incWarnCount(unsigned count)
+bool Emit::isMisplaced(const int lineNum) const
 {
-    s_warnCount += count;
+    if (m_misplacedChars.count(lineNum))
+    {
+        return true;
+    }
+    return m_scanned != nullptr && m_scanned->isMisplaced(lineNum);
 }
 
-void Emit::count()
+std::string Emit::escape(const std::string &text)
 {
-    if (s_verbose)
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (const char c : text)
     {
-        std::cout << "Number of warnings: " << s_warnCount << std::endl;
-        std::cout << "Number of errors: " << s_errorCount << std::endl;
+        switch (c)
+        {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if ((unsigned char)c < 0x20)
+                {
+                    char code[7];
+                    snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                }
+                else
+                {
+                    escaped += c;
+                }
+        }
     }
+    return escaped;
 }
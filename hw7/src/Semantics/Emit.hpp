@@ -1,27 +1,73 @@
 #pragma once
 
-#include <algorithm>
 #include <iostream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
+// Diagnostics of a compilation. The static interface reports to the unit
+// of the compilation running on the calling thread, see Compilation.
+// Diagnostics are kept as records and rendered together by flush(), as
+// text or as one JSON object per line, instead of being written and
+// flushed one at a time. A compilation flushes at the end of each phase so
+// they come out in the same place as ever.
 class Emit
 {
     public:
-        static unsigned getErrorCount() { return s_errorCount; }
-        static unsigned getWarnCount() { return s_warnCount; }
+        enum class Severity { Error, Warning };
+        enum class Format { Text, Json };
+
+        struct Diagnostic
+        {
+            Severity severity;
+            int lineNum;                            // 0 if the diagnostic has a tag instead
+            std::string tag;                        // Such as LINKER, for diagnostics about no line in particular
+            std::string msg;
+        };
+
+        Emit(std::ostream &out=std::cout, const Emit *scanned=nullptr);     // Warnings on lines with a misplaced character in scanned are dropped too
+
+        // Static
+        static Emit & unit();                       // The diagnostics of the compilation running on this thread
+        static Emit * setUnit(Emit *emit);          // Returns the unit it replaces, nullptr restores this thread's default
+        static unsigned getErrorCount() { return unit().m_errorCount; }
+        static unsigned getWarnCount() { return unit().m_warnCount; }
+        static std::ostream & out() { return *unit().m_out; }
         static void error(const std::string type, const std::string msg);
         static void error(const int lineNum, const std::string msg, const bool isMisplaceChar=false);
         static void incErrorCount(unsigned count=1);
         static void warn(const std::string type, const std::string msg);
         static void warn(const int lineNum, const std::string msg);
         static void incWarnCount(unsigned count=1);
+        static void flush();                        // Render the diagnostics reported since the last flush
         static void count();
-        static void setVerbose(bool verbose) { s_verbose = verbose; }
+        static void setVerbose(bool verbose) { unit().m_verbose = verbose; }
+        static void setBuffered(bool buffered) { unit().m_buffered = buffered; }   // Unbuffered diagnostics interleave with other output
+        static void setFormat(Format format) { unit().m_format = format; }
+
+        // Getters
+        const std::vector<Diagnostic> & getDiagnostics() const { return m_diagnostics; }    // Reported since the last flush
+
+        // Helpers
+        void append(Emit &emit);                    // Takes over the unflushed diagnostics and the counts of emit
 
     private:
-        inline static unsigned s_errorCount = 0;
-        inline static unsigned s_warnCount = 0;
-        inline static bool s_verbose = true;
-        inline static std::vector<int> s_misplacedChars;
+        void report(const Severity severity, const int lineNum, const std::string &tag, const std::string &msg);
+        void render(const Diagnostic &diagnostic) const;
+        bool isMisplaced(const int lineNum) const;
+
+        // Static
+        static std::string escape(const std::string &text);
+
+        std::ostream *m_out;
+        const Emit *m_scanned;
+        unsigned m_errorCount;
+        unsigned m_warnCount;
+        bool m_verbose;
+        bool m_buffered;
+        Format m_format;
+        std::vector<Diagnostic> m_diagnostics;      // Reported since the last flush
+        std::unordered_set<int> m_misplacedChars;
+
+        inline static thread_local Emit *s_unit = nullptr;
 };
@@ -1,24 +1,62 @@
 #include "Semantics.hpp"
+#include "../Tree/NodePool.hpp"
 
-Semantics::Semantics(SymTable *symTable, const bool verbose) : m_symTable(symTable), m_mainExists(false), m_ioRoot(nullptr)
+#include <atomic>
+#include <deque>
+#include <thread>
+
+Semantics::Semantics(SymTable *symTable, const bool verbose) : m_symTable(symTable), m_mainExists(false), m_ioRoot(nullptr), m_goffset(0), m_threadCount(1)
 {
     Emit::setVerbose(verbose);
 }
 
 void Semantics::analyze(Node *node)
+{
+    begin();
+    if (m_threadCount > 1)
+    {
+        symTableInitialize(node);
+        analyzeParallel(node);
+    }
+    else
+    {
+        analyzeDecl(node);
+    }
+    end(node);
+}
+
+void Semantics::begin()
 {
     symTableInitializeIOTree();
+    Node::evaluateAttributes(m_ioRoot);
     symTableInjectIOTree(m_ioRoot);
+}
 
-    // Initialize the symbol table
-    symTableSimpleEnterScope("Symbol table initialization");
-    symTableInitialize(node);
-    symTableSimpleLeaveScope();
+void Semantics::analyzeDecl(Node *decl)
+{
+    // Names are resolved once, the checks only follow the Decl each Id and Call was bound to
+    symTableInitialize(decl);
+    analyzeTree(decl);
+}
 
-    analyzeTree(node);
-    checkUnusedWarns();
+void Semantics::analyzeSignature(Func *func)
+{
+    // What analyzeDecl() does for a function before and after its body, the parameters are resolved but not checked
+    symTableInitializeNode(func);
+    symTableInitialize(func->getChild());
+    symTableFinalizeNode(func);
+    analyzeNode(func);
+}
 
-    if (node && !m_mainExists)
+void Semantics::end(Node *root)
+{
+    // The global scope is never left, its unused symbols are reported last
+    std::vector<Decl *> decls;
+    addScopeDecls(m_ioRoot, decls);
+    addScopeDecls(root, decls);
+    checkUnusedWarns(decls);
+
+    if (root && !m_mainExists)
     {
         Emit::error("LINKER", "A function named 'main' with no parameters must be defined.");
     }
@@ -26,10 +64,98 @@ void Semantics::analyze(Node *node)
 
 void Semantics::analyzeTree(Node *node)
 {
-    if (node == nullptr || node->getIsAnalyzed())
+    traverse(node, [this](Node *node)
     {
-        return;
+        // Handlers analyze some children early, those and their siblings are already done
+        if (node->getIsAnalyzed())
+        {
+            return false;
+        }
+        analyzeNode(node);
+        return true;
+    },
+    [this](Node *node)
+    {
+        analyzeScopeEnd(node);
+    });
+}
+
+void Semantics::analyzeParallel(Node *root)
+{
+    // Globals and signatures are checked in order first, the bodies then only read them and their own locals
+    // Each declaration reports to its own diagnostics, merged in order so the output is the same as analyzeTree()'s
+    Emit &emit = Emit::unit();
+    std::ostream &out = Emit::out();
+    std::deque<Emit> emits;
+    std::vector<std::pair<Func *, Emit *>> bodies;
+    for (Node *decl = root; decl != nullptr; decl = decl->getSibling())
+    {
+        emits.emplace_back(out, &emit);
+        Emit::setUnit(&emits.back());
+        analyzeNode(decl);
+        if (isFunc(decl))
+        {
+            bodies.push_back({(Func *)decl, &emits.back()});
+        }
     }
+    Emit::setUnit(&emit);
+
+    // Names and types are all resolved, so the workers only read this thread's tree, names and types
+    // The only types they ask for are the plain ones, made here so they are only looked up
+    for (Data::Type type : {Data::Type::Undefined, Data::Type::Int, Data::Type::Bool, Data::Type::Char, Data::Type::String, Data::Type::Void})
+    {
+        Data::get(type);
+    }
+    NodePool *pool = &NodePool::unit();
+    Intern::Table *names = &Intern::table();
+    Data::Table *types = &Data::table();
+    std::atomic<size_t> next(0);
+    auto work = [&]()
+    {
+        NodePool *previousPool = NodePool::setUnit(pool);
+        Intern::Table *previousNames = Intern::setTable(names);
+        Data::Table *previousTypes = Data::setTable(types);
+        for (size_t i = next++; i < bodies.size(); i = next++)
+        {
+            Emit *previousEmit = Emit::setUnit(bodies[i].second);
+            analyzeBody(bodies[i].first);
+            Emit::setUnit(previousEmit);
+        }
+        NodePool::setUnit(previousPool);
+        Intern::setTable(previousNames);
+        Data::setTable(previousTypes);
+    };
+
+    unsigned threadCount = std::min<size_t>(m_threadCount, bodies.size());
+    std::vector<std::thread> threads;
+    for (unsigned worker = 1; worker < threadCount; worker++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (Emit &declEmit : emits)
+    {
+        emit.append(declEmit);
+    }
+}
+
+void Semantics::analyzeBody(Func *func)
+{
+    // What analyzeTree() does below a Func it has already analyzed
+    for (unsigned i = 0; i < func->getChildCount(); i++)
+    {
+        analyzeTree(func->getChild(i));
+    }
+    analyzeScopeEnd(func);
+}
+
+void Semantics::analyzeNode(Node *node)
+{
     node->makeAnalyzed();
 
     switch (node->getNodeKind())
@@ -86,20 +212,8 @@ void Semantics::analyzeTree(Node *node)
             analyzeWhile((While *)node);
             break;
         default:
-            throw std::runtime_error("Semantics::analyzeTree() - Invalid Node");
-    }
-
-    // Analyze children
-    symTableEnterScope(node);
-    std::vector<Node *> children = node->getChildren();
-    for (int i = 0; i < children.size(); i++)
-    {
-        analyzeTree(children[i]);
+            throw std::runtime_error("Semantics::analyzeNode() - Invalid Node");
     }
-    symTableLeaveScope(node);
-
-    // Analyze sibling
-    analyzeTree(node->getSibling());
 }
 
 void Semantics::analyzeFunc(Func *func)
@@ -109,7 +223,7 @@ void Semantics::analyzeFunc(Func *func)
         throw std::runtime_error("Semantics::analyzeFunc() - Invalid Func");
     }
 
-    symTableInsert(func);
+    checkRedeclared(func);
 
     if (isMainFunc(func))
     {
@@ -124,7 +238,7 @@ void Semantics::analyzeParm(Parm *parm)
         throw std::runtime_error("Semantics::analyzeParm() - Invalid Parm");
     }
 
-    symTableInsert(parm);
+    checkRedeclared(parm);
 }
 
 void Semantics::analyzeVar(Var *var)
@@ -135,7 +249,7 @@ void Semantics::analyzeVar(Var *var)
     }
 
     // Global vars are always initialized
-    if (m_symTable->depth() == 1 || var->getData()->getIsStatic())
+    if (var->getMemScope() == Node::MemScope::Global || var->getData()->getIsStatic())
     {
         var->makeInitialized();
         var->setIsGlobal(true);
@@ -151,8 +265,8 @@ void Semantics::analyzeVar(Var *var)
         Exp *exp = (Exp *)(var->getChild());
         analyzeTree(exp);
 
-        Data *expData = exp->getData();
-        Data *varData = var->getData();
+        const Data *expData = exp->getData();
+        const Data *varData = var->getData();
         Data::Type expType = expData->getType();
         Data::Type varType = varData->getType();
         if (varType != Data::Type::Undefined && expType != Data::Type::Undefined)
@@ -175,13 +289,13 @@ void Semantics::analyzeVar(Var *var)
             }
         }
 
-        if (hasNonConstantRelative(exp)) // if not a constant exp
+        if (!exp->getIsConstant())
         {
             Emit::error(var->getLineNum(), "Initializer for variable '" + var->getName() + "' is not a constant expression.");
         }
     }
 
-    symTableInsert(var);
+    checkRedeclared(var);
 }
 
 void Semantics::analyzeAsgn(const Asgn *asgn)
@@ -197,24 +311,21 @@ void Semantics::analyzeAsgn(const Asgn *asgn)
 
     analyzeTree(rhs);
 
+    // Globals are initialized already and may be shared with bodies analyzed at the same time, so they are not written
+    Var *lhsVar;
     if (isId(lhs))
     {
-        Id *lhsId = (Id *)(lhs);
-        Var *prevDeclLhsVar = (Var *)(symTableGet(lhsId->getName()));
-        if (isVar(prevDeclLhsVar))
-        {
-            prevDeclLhsVar->makeInitialized();
-        }
+        lhsVar = (Var *)(((Id *)lhs)->getDecl());
     }
     else
     {
         Binary *lhsBinary = (Binary *)(lhs);
         Id *arrayId = (Id *)(lhsBinary->getChild());
-        Var *arrayDecl = (Var *)(symTableGet(arrayId->getName()));
-        if (arrayDecl != nullptr)
-        {
-            arrayDecl->makeInitialized();
-        }
+        lhsVar = (Var *)(arrayId->getDecl());
+    }
+    if (isVar(lhsVar) && !lhsVar->getIsInitialized())
+    {
+        lhsVar->makeInitialized();
     }
 
     switch (asgn->getType())
@@ -282,7 +393,7 @@ void Semantics::analyzeCall(const Call *call) const
         throw std::runtime_error("Semantics::analyzeCall() - Invalid Call");
     }
 
-    Decl *decl = (Decl *)(symTableGet(call->getName()));
+    Decl *decl = call->getDecl();
 
     // If the function name is not in the symbol table
     if (decl == nullptr)
@@ -319,8 +430,8 @@ void Semantics::analyzeCall(const Call *call) const
         unsigned parmCount = 1;
         while (callParm != nullptr && funcParm != nullptr)
         {
-            Data *callParmData = callParm->getData();
-            Data *funcParmData = funcParm->getData();
+            const Data *callParmData = callParm->getData();
+            const Data *funcParmData = funcParm->getData();
             Data::Type callParmType = callParmData->getType();
             Data::Type funcParmType = funcParmData->getType();
             if (callParmType != Data::Type::Undefined && funcParmType != Data::Type::Undefined && callParmType != funcParmType)
@@ -375,7 +486,7 @@ void Semantics::analyzeId(Id *id) const
         throw std::runtime_error("Semantics::analyzeId() - Invalid Id");
     }
 
-    Decl *idDecl = (Decl *)(symTableGet(id->getName()));
+    Decl *idDecl = id->getDecl();
     if (idDecl == nullptr)
     {
         Emit::error(id->getLineNum(), "Symbol '" + id->getName() + "' is not declared.");
@@ -394,7 +505,7 @@ void Semantics::analyzeId(Id *id) const
         // Don't warn if the uninitialized id is an array index (see hw4/test/lhs.c-)
         if (!varDecl->getIsInitialized() && varDecl->getShowErrors())
         {
-            if (!hasAsgnRelative((Exp *)id))
+            if (!id->getIsInAsgnTarget())
             {
                 Emit::warn(id->getLineNum(), "Variable '" + id->getName() + "' may be uninitialized when used here.");
                 varDecl->setShowErrors(false);
@@ -562,18 +673,18 @@ void Semantics::analyzeRange(const Range *range) const
         throw std::runtime_error("Semantics::analyzeRange() - Invalid Range");
     }
 
-    std::vector<Node *> children = range->getChildren();
-    for (int i = 0; i < children.size(); i++)
+    for (int i = 0; i < range->getChildCount(); i++)
     {
-        if (children[i] == nullptr)
+        Node *child = range->getChild(i);
+        if (child == nullptr)
         {
             continue;
         }
 
         bool isArray = false;
-        if (isId(children[i]))
+        if (isId(child))
         {
-            Id *id = (Id *)(children[i]);
+            Id *id = (Id *)(child);
             if (id->getData()->getIsArray())
             {
                 isArray = true;
@@ -583,10 +694,10 @@ void Semantics::analyzeRange(const Range *range) const
         {
             std::stringstream msg;
             msg << "Cannot use array in position " << i + 1 << " in range of for statement.";
-            Emit::error(children[i]->getLineNum(), msg.str());
+            Emit::error(child->getLineNum(), msg.str());
         }
 
-        Exp *exp = (Exp *)(children[i]);
+        Exp *exp = (Exp *)(child);
         if (isExp(exp) && exp->getData()->getType() != Data::Type::Undefined && exp->getData()->getType() != Data::Type::Int)
         {
             std::stringstream msg;
@@ -652,7 +763,7 @@ void Semantics::analyzeWhile(const While *whileN) const
         return;
     }
 
-    Data *testData = testExp->getData();
+    const Data *testData = testExp->getData();
     if (testData->getType() != Data::Type::Undefined)
     {
         if (testData->getType() != Data::Type::Bool)
@@ -667,6 +778,45 @@ void Semantics::analyzeWhile(const While *whileN) const
     }
 }
 
+void Semantics::analyzeScopeEnd(const Node *node) const
+{
+    if (!isScope(node))
+    {
+        return;
+    }
+
+    // A For or Func body shares the scope of its For or Func
+    std::vector<Decl *> decls;
+    switch (node->getNodeKind())
+    {
+        case Node::Kind::Func:
+        {
+            Func *func = (Func *)node;
+            if (func->getData()->getType() != Data::Type::Undefined && func->getData()->getType() != Data::Type::Void && !func->getHasReturn())
+            {
+                Emit::warn(func->getLineNum(), "Expecting to return type " + func->getData()->stringify() + " but function '" + func->getName() + "' has no return statement.");
+            }
+            addScopeDecls(func->getChild(), decls);
+            if (isCompound(func->getChild(1)))
+            {
+                addScopeDecls(func->getChild(1)->getChild(), decls);
+            }
+            break;
+        }
+        case Node::Kind::For:
+            addScopeDecls(node->getChild(), decls);
+            if (isCompound(node->getChild(2)))
+            {
+                addScopeDecls(node->getChild(2)->getChild(), decls);
+            }
+            break;
+        default:
+            addScopeDecls(node->getChild(), decls);
+            break;
+    }
+    checkUnusedWarns(decls);
+}
+
 void Semantics::checkOperandsOfSameType(Exp *exp) const
 {
     if (!isExp(exp))
@@ -678,10 +828,16 @@ void Semantics::checkOperandsOfSameType(Exp *exp) const
         throw std::runtime_error("Semantics::checkOperandsOfSameType() - LHS and RHS Exp operands must exist");
     }
 
-    std::string sym = getExpSym(exp);
     Exp *lhs = (Exp *)(exp->getChild());
     Exp *rhs = (Exp *)(exp->getChild(1));
 
+    // Types are canonical, so the same pointer is the same type and array-ness
+    if (lhs->getData() == rhs->getData())
+    {
+        return;
+    }
+    std::string sym = getExpSym(exp);
+
     // Ignore cases where the LHS has no type
     if (lhs->getData()->getType() == Data::Type::Undefined || rhs->getData()->getType() == Data::Type::Undefined)
     {
@@ -739,7 +895,7 @@ void Semantics::checkOperandsOfType(Exp *exp, const Data::Type type, const bool
         if (isId(lhs))
         {
             Id *lhsId = (Id *)lhs;
-            Decl *prevDecl = symTableGet(lhsId->getName());
+            Decl *prevDecl = lhsId->getDecl();
             if ((prevDecl != nullptr && prevDecl->getData()->getIsArray()))
             {
                 Emit::error(binary->getLineNum(), "The operation '" + binary->getSym() + "' does not work with arrays.");
@@ -749,7 +905,7 @@ void Semantics::checkOperandsOfType(Exp *exp, const Data::Type type, const bool
         if (isId(rhs))
         {
             Id *rhsId = (Id *)rhs;
-            Decl *prevDecl = symTableGet(rhsId->getName());
+            Decl *prevDecl = rhsId->getDecl();
             if ((prevDecl != nullptr && prevDecl->getData()->getIsArray()))
             {
                 Emit::error(binary->getLineNum(), "The operation '" + binary->getSym() + "' does not work with arrays.");
@@ -770,7 +926,7 @@ void Semantics::checkOperandsOfType(Exp *exp, const Data::Type type, const bool
                 if (isId(lhs))
                 {
                     Id *lhsId = (Id *)lhs;
-                    Decl *prevDecl = symTableGet(lhsId->getName());
+                    Decl *prevDecl = lhsId->getDecl();
                     if ((prevDecl != nullptr && prevDecl->getData()->getIsArray()))
                     {
                         Emit::error(asgn->getLineNum(), "The operation '" + asgn->getSym() + "' does not work with arrays.");
@@ -780,7 +936,7 @@ void Semantics::checkOperandsOfType(Exp *exp, const Data::Type type, const bool
                 if (isId(rhs))
                 {
                     Id *rhsId = (Id *)rhs;
-                    Decl *prevDecl = symTableGet(rhsId->getName());
+                    Decl *prevDecl = rhsId->getDecl();
                     if ((prevDecl != nullptr && prevDecl->getData()->getIsArray()))
                     {
                         Emit::error(asgn->getLineNum(), "The operation '" + asgn->getSym() + "' does not work with arrays.");
@@ -803,7 +959,7 @@ void Semantics::checkIndex(const Binary *binary) const
     Id *arrayId = (Id *)(binary->getChild());
     Exp *indexExp = (Exp *)(binary->getChild(1));
 
-    Decl *arrayDecl = (Decl *)(symTableGet(arrayId->getName()));
+    Decl *arrayDecl = arrayId->getDecl();
     if (arrayDecl == nullptr || !arrayDecl->getData()->getIsArray())
     {
         Emit::error(binary->getLineNum(), "Cannot index nonarray '" + arrayId->getName() + "'.");
@@ -817,7 +973,7 @@ void Semantics::checkIndex(const Binary *binary) const
     if (isId(indexExp))
     {
         Id *indexId = (Id *)indexExp;
-        Decl *indexDecl = (Decl *)(symTableGet(indexId->getName()));
+        Decl *indexDecl = indexId->getDecl();
         if (isDecl(indexDecl) && indexDecl->getData()->getIsArray())
         {
             Emit::error(binary->getLineNum(), "Array index is the unindexed array '" + indexId->getName() + "'.");
@@ -825,12 +981,27 @@ void Semantics::checkIndex(const Binary *binary) const
     }
 }
 
-void Semantics::checkUnusedWarns() const
+void Semantics::checkRedeclared(const Decl *decl) const
 {
-    std::map<std::string, void *> syms = m_symTable->getSyms();
-    for (auto const& [name, currNode] : syms)
+    Decl *prevDecl = decl->getPrevDecl();
+    if (prevDecl != nullptr)
+    {
+        std::stringstream msg;
+        msg << "Symbol '" << decl->getName() << "' is already declared at line " << prevDecl->getLineNum() << ".";
+        Emit::error(decl->getLineNum(), msg.str());
+    }
+}
+
+void Semantics::checkUnusedWarns(std::vector<Decl *> &decls) const
+{
+    // In the order of the symbol table's listing of the scope
+    std::sort(decls.begin(), decls.end(), [](const Decl *lhs, const Decl *rhs)
+    {
+        return lhs->getName() < rhs->getName();
+    });
+
+    for (const Decl *decl : decls)
     {
-        Decl *decl = (Decl *)currNode;
         if (isVar(decl) && !decl->getIsUsed())
         {
             Emit::warn(decl->getLineNum(), "The variable '" + decl->getName() + "' seems not to be used.");
@@ -867,16 +1038,16 @@ bool Semantics::symTableInsert(const Decl *decl, const bool global, const bool s
     bool inserted = false;
     if (global)
     {
-        inserted = m_symTable->insertGlobal(decl->getName(), (void *)decl);
+        inserted = m_symTable->insertGlobal(decl->getNameHandle(), (void *)decl);
     }
     else
     {
-        inserted = m_symTable->insert(decl->getName(), (void *)decl);
+        inserted = m_symTable->insert(decl->getNameHandle(), (void *)decl);
     }
 
     if (!inserted && showWarns)
     {
-        Decl *prevDecl = (Decl *)(symTableGet(decl->getName()));
+        Decl *prevDecl = (Decl *)(symTableGet(decl->getNameHandle()));
         if (prevDecl == nullptr)
         {
             throw std::runtime_error("Semantics::symTableInsert() - Failed to insert Decl");
@@ -889,9 +1060,9 @@ bool Semantics::symTableInsert(const Decl *decl, const bool global, const bool s
     return inserted;
 }
 
-Decl * Semantics::symTableGet(const std::string name) const
+Decl * Semantics::symTableGet(const Intern::Handle name) const
 {
-    if (name.length() == 0)
+    if (name == Intern::None)
     {
         throw std::runtime_error("Semantics::symTableGet() - Invalid name");
     }
@@ -902,11 +1073,21 @@ Decl * Semantics::symTableGet(const std::string name) const
 
 void Semantics::symTableInitialize(Node *node)
 {
-    if (node == nullptr)
+    traverse(node, [this](Node *node)
     {
-        return;
-    }
+        symTableInitializeNode(node);
 
+        // A Var's only child is its initializer which was handled first
+        return !isVar(node);
+    },
+    [this](Node *node)
+    {
+        symTableFinalizeNode(node);
+    });
+}
+
+void Semantics::symTableInitializeNode(Node *node)
+{
     if (isDecl(node))
     {
         if (isVar(node))
@@ -914,18 +1095,20 @@ void Semantics::symTableInitialize(Node *node)
             symTableInitialize(node->getChild());
         }
 
-        symTableInsert((Decl *)node, false, false);
+        Decl *decl = (Decl *)node;
+        if (!symTableInsert(decl, false, false))
+        {
+            decl->setPrevDecl(symTableGet(decl->getNameHandle()));
+        }
         if (isFunc(node))
         {
-            s_foffsets.push_back(-2);
+            m_foffsets.push_back(-2);
         }
     }
 
-    symTableSetType(node);
-
-    if (m_symTable->depth() == 2)
+    if (m_symTable->depth() == 1)
     {
-        node->setMemScope("Global");
+        node->setMemScope(Node::MemScope::Global);
     }
     else
     {
@@ -934,45 +1117,44 @@ void Semantics::symTableInitialize(Node *node)
             Var *var = (Var *)node;
             if (var->getData()->getIsStatic())
             {
-                var->setMemScope("LocalStatic");
+                var->setMemScope(Node::MemScope::LocalStatic);
             }
             else
             {
-                var->setMemScope("Local");
+                var->setMemScope(Node::MemScope::Local);
             }
         }
         else if (isParm(node))
         {
-            node->setMemScope("Parameter");
+            node->setMemScope(Node::MemScope::Parameter);
         }
     }
 
-    bool hasScope = symTableEnterScope(node);
-    if (hasScope)
+    if (symTableEnterScope(node))
     {
         if (isFunc(node))
         {
-            s_foffsets.push_back(-2);
+            m_foffsets.push_back(-2);
         }
         else
         {
-            s_foffsets.push_back(s_foffsets.back());
+            m_foffsets.push_back(m_foffsets.back());
         }
     }
 
-    if (node->getMemScope() == "Global" || node->getMemScope() == "LocalStatic")
+    if (node->getMemScope() == Node::MemScope::Global || node->getMemScope() == Node::MemScope::LocalStatic)
     {
         if (isConst(node))
         {
             Const *constN = (Const *)node;
             if (constN->getType() == Const::Type::String)
             {
-                constN->setMemLoc(s_goffset - 1);
-                s_goffset -= node->getMemSize(); 
+                constN->setMemLoc(m_goffset - 1);
+                m_goffset -= node->getMemSize(); 
             }
             else
             {
-                constN->setMemLoc(s_goffset);
+                constN->setMemLoc(m_goffset);
             }
         }
         else if (isVar(node))
@@ -980,48 +1162,45 @@ void Semantics::symTableInitialize(Node *node)
             Var *var = (Var *)node;
             if (var->getData()->getIsArray())
             {
-                var->setMemLoc(s_goffset - 1);
+                var->setMemLoc(m_goffset - 1);
             }
             else
             {
-                var->setMemLoc(s_goffset);
+                var->setMemLoc(m_goffset);
             }
-            s_goffset -= node->getMemSize();
+            m_goffset -= node->getMemSize();
         }
     }
-    else if (node->getMemScope() == "Local")
+    else if (node->getMemScope() == Node::MemScope::Local)
     {
         if (isVar(node))
         {
             Var *var = (Var *)node;
             if (var->getData()->getIsArray())
             {
-                var->setMemLoc(s_foffsets.back() - 1);
+                var->setMemLoc(m_foffsets.back() - 1);
             }
             else
             {
-                var->setMemLoc(s_foffsets.back());
+                var->setMemLoc(m_foffsets.back());
             }
-            s_foffsets.back() -= node->getMemSize();
+            m_foffsets.back() -= node->getMemSize();
         }
     }
-    else if (node->getMemScope() == "Parameter")
+    else if (node->getMemScope() == Node::MemScope::Parameter)
     {
         if (isParm(node))
         {
-            node->setMemLoc(s_foffsets.back());
-            s_foffsets.back() -= node->getMemSize();
+            node->setMemLoc(m_foffsets.back());
+            m_foffsets.back() -= node->getMemSize();
         }
     }
 
-    if (!isVar(node))
-    {
-        std::vector<Node *> children = node->getChildren();
-        for (int i = 0; i < children.size(); i++)
-        {
-            symTableInitialize(children[i]);
-        }
-    }
+}
+
+void Semantics::symTableFinalizeNode(Node *node)
+{
+    symTableSetType(node);
 
     switch (node->getNodeKind())
     {
@@ -1033,64 +1212,61 @@ void Semantics::symTableInitialize(Node *node)
         }
         case Node::Kind::Compound:
         case Node::Kind::For:
-            if (s_foffsets.size() > 0)
+            if (m_foffsets.size() > 0)
             {
-                node->setMemSize(s_foffsets.back());
+                node->setMemSize(m_foffsets.back());
             }
             break;
     }
 
-    symTableLeaveScope(node, false);
-    if (hasScope)
+    if (symTableLeaveScope(node))
     {
-        s_foffsets.pop_back();
+        m_foffsets.pop_back();
         if (isFor(node))
         {
-            node->setMemSize(s_foffsets.back() - 1);
+            node->setMemSize(m_foffsets.back() - 1);
         }
     }
-
-    symTableInitialize(node->getSibling());
 }
 
-Data * Semantics::symTableSetType(Node *node)
+void Semantics::symTableSetType(Node *node)
 {
+    // Children are typed first, an operand that is missing or not an expression counts as undefined
     if (!isExp(node))
     {
-        return new Data(Data::Type::Undefined, false, false);
+        return;
     }
 
     Exp *exp = (Exp *)node;
+    const Data *undefined = Data::get(Data::Type::Undefined, false, false);
+    const Data *lhs = isExp(exp->getChild()) ? ((Exp *)exp->getChild())->getData() : undefined;
+    const Data *rhs = isExp(exp->getChild(1)) ? ((Exp *)exp->getChild(1))->getData() : undefined;
     switch (exp->getNodeKind())
     {
         case Node::Kind::Asgn:
-        {
-            Asgn *asgn = (Asgn *)exp;
-            if (asgn->getType() == Asgn::Type::Asgn)
+            if (((Asgn *)exp)->getType() == Asgn::Type::Asgn)
             {
-                exp->setData(symTableSetType(asgn->getChild()));
+                exp->setData(lhs);
             }
-            else if (symTableSetType(asgn->getChild())->getType() == Data::Type::Undefined && symTableSetType(asgn->getChild(1))->getType() == Data::Type::Undefined)
+            if (lhs->getType() == Data::Type::Undefined && rhs->getType() == Data::Type::Undefined)
             {
-                exp->setData(new Data(Data::Type::Undefined, false, false));
+                exp->setData(undefined);
             }
-        }
+            break;
         case Node::Kind::Binary:
-        {
-            Binary *binary = (Binary *)exp;
-            if (binary->getType() == Binary::Type::Index)
+            if (((Binary *)exp)->getType() == Binary::Type::Index)
             {
-                exp->setData(symTableSetType(binary->getChild())->getNextData());
+                exp->setData(lhs->getNextData());
             }
-            else if (symTableSetType(binary->getChild())->getType() == Data::Type::Undefined && symTableSetType(binary->getChild(1))->getType() == Data::Type::Undefined)
+            else if (lhs->getType() == Data::Type::Undefined && rhs->getType() == Data::Type::Undefined)
             {
-                exp->setData(new Data(Data::Type::Undefined, false, false));
+                exp->setData(undefined);
             }
             break;
-        }
         case Node::Kind::Call:
         {
-            Decl *decl = symTableGet(((Call *)node)->getName());
+            Decl *decl = symTableGet(((Call *)node)->getNameHandle());
+            ((Call *)node)->setDecl(decl);
             if (isFunc(decl))
             {
                 exp->setData(decl->getData());
@@ -1099,27 +1275,21 @@ Data * Semantics::symTableSetType(Node *node)
         }
         case Node::Kind::Id:
         {
-            Decl *decl = symTableGet(((Id *)node)->getName());
+            Decl *decl = symTableGet(((Id *)node)->getNameHandle());
+            ((Id *)node)->setDecl(decl);
             if (isVar(decl) || isParm(decl))
             {
                 exp->setData(decl->getData());
             }
-            // exp->setMemSize(decl->getMemSize());
-            // exp->setMemLoc(decl->getMemLoc());
-            // exp->setMemScope(decl->getMemScope());
             break;
         }
         case Node::Kind::Unary:
-        {
-            Unary *unary = (Unary *)exp;
-            if (symTableSetType(unary->getChild())->getType() == Data::Type::Undefined)
+            if (lhs->getType() == Data::Type::Undefined)
             {
-                exp->setData(new Data(Data::Type::Undefined, false, false));
+                exp->setData(undefined);
             }
             break;
-        }
     }
-    return exp->getData();
 }
 
 void Semantics::symTableSimpleEnterScope(const std::string name)
@@ -1132,12 +1302,8 @@ void Semantics::symTableSimpleEnterScope(const std::string name)
     m_symTable->enter(name);
 }
 
-void Semantics::symTableSimpleLeaveScope(const bool showWarns)
+void Semantics::symTableSimpleLeaveScope()
 {
-    if (showWarns)
-    {
-        checkUnusedWarns();
-    }
     m_symTable->leave();
 }
 
@@ -1172,84 +1338,49 @@ bool Semantics::symTableEnterScope(const Node *node)
     return false;
 }
 
-bool Semantics::symTableLeaveScope(const Node *node, const bool showWarns)
+bool Semantics::symTableLeaveScope(const Node *node)
 {
-    Node::Kind nodeKind = node->getNodeKind();
-    if (nodeKind == Node::Kind::For)
+    if (!isScope(node))
     {
-        symTableSimpleLeaveScope(showWarns);
-        return true;
-    }
-    else if (nodeKind == Node::Kind::Func)
-    {
-        Func *func = (Func *)node;
-        if (showWarns && func->getData()->getType() != Data::Type::Undefined && func->getData()->getType() != Data::Type::Void && !func->getHasReturn())
-        {
-            Emit::warn(func->getLineNum(), "Expecting to return type " + func->getData()->stringify() + " but function '" + func->getName() + "' has no return statement.");
-        }
-        symTableSimpleLeaveScope(showWarns);
-        return true;
-    }
-
-    if (node->getParent() != nullptr)
-    {
-        Node::Kind parentKind = node->getParent()->getNodeKind();
-        if (nodeKind == Node::Kind::Compound && (parentKind != Node::Kind::For && parentKind != Node::Kind::Func))
-        {
-            // Func *func = (Func *)node;
-            // if (showWarns && isFunc(func) && !func->getHasReturn())
-            // {
-            //     Emit::error(func->getLineNum(), "Expecting to return type " + func->getData()->stringify() + " but function '" + func->getName() + "' has no return statement.");
-            // }
-            symTableSimpleLeaveScope(showWarns);
-            return true;
-        }
-    }
-    else
-    {
-        if (nodeKind == Node::Kind::Compound)
-        {
-            symTableSimpleLeaveScope(showWarns);
-            return true;
-        }
+        return false;
     }
-
-    return false;
+    symTableSimpleLeaveScope();
+    return true;
 }
 
 void Semantics::symTableInitializeIOTree()
 {
-    Func *outputFunc = new Func(-1, "output", new Data(Data::Type::Void, false, false));
-    Parm *outputParm = new Parm(-1, "*dummy1*", new Data(Data::Type::Int, false, false));
+    Func *outputFunc = new Func(-1, Intern::handle("output"), Data::get(Data::Type::Void, false, false));
+    Parm *outputParm = new Parm(-1, Intern::handle("*dummy1*"), Data::get(Data::Type::Int, false, false));
     outputFunc->makeUsed();
     outputParm->makeUsed();
     outputFunc->addChild(outputParm);
 
-    Func *outputbFunc = new Func(-1, "outputb", new Data(Data::Type::Void, false, false));
-    Parm *outputbParm = new Parm(-1, "*dummy2*", new Data(Data::Type::Bool, false, false));
+    Func *outputbFunc = new Func(-1, Intern::handle("outputb"), Data::get(Data::Type::Void, false, false));
+    Parm *outputbParm = new Parm(-1, Intern::handle("*dummy2*"), Data::get(Data::Type::Bool, false, false));
     outputbFunc->makeUsed();
     outputbParm->makeUsed();
     outputbFunc->addChild(outputbParm);
 
-    Func *outputcFunc = new Func(-1, "outputc", new Data(Data::Type::Void, false, false));
-    Parm *outputcParm = new Parm(-1, "*dummy3*", new Data(Data::Type::Char, false, false));
+    Func *outputcFunc = new Func(-1, Intern::handle("outputc"), Data::get(Data::Type::Void, false, false));
+    Parm *outputcParm = new Parm(-1, Intern::handle("*dummy3*"), Data::get(Data::Type::Char, false, false));
     outputcFunc->makeUsed();
     outputcParm->makeUsed();
     outputcFunc->addChild(outputcParm);
 
-    Func *inputFunc = new Func(-1, "input", new Data(Data::Type::Int, false, false));
+    Func *inputFunc = new Func(-1, Intern::handle("input"), Data::get(Data::Type::Int, false, false));
     inputFunc->makeUsed();
     inputFunc->makeHasReturn();
 
-    Func *inputbFunc = new Func(-1, "inputb", new Data(Data::Type::Bool, false, false));
+    Func *inputbFunc = new Func(-1, Intern::handle("inputb"), Data::get(Data::Type::Bool, false, false));
     inputbFunc->makeUsed();
     inputbFunc->makeHasReturn();
 
-    Func *inputcFunc = new Func(-1, "inputc", new Data(Data::Type::Char, false, false));
+    Func *inputcFunc = new Func(-1, Intern::handle("inputc"), Data::get(Data::Type::Char, false, false));
     inputcFunc->makeUsed();
     inputcFunc->makeHasReturn();
 
-    Func *outnlFunc = new Func(-1, "outnl", new Data(Data::Type::Void, false, false));
+    Func *outnlFunc = new Func(-1, Intern::handle("outnl"), Data::get(Data::Type::Void, false, false));
     outnlFunc->makeUsed();
 
     outputFunc->addSibling(outputbFunc);
@@ -1264,22 +1395,14 @@ void Semantics::symTableInitializeIOTree()
 
 void Semantics::symTableInjectIOTree(Node *node)
 {
-    if (node == nullptr)
-    {
-        return;
-    }
-
-    if (isDecl(node))
+    traverse(node, [this](Node *node)
     {
-        symTableInsert((Decl *)node, false);
-    }
-
-    std::vector<Node *> children = node->getChildren();
-    for (int i = 0; i < children.size(); i++)
-    {
-        symTableInjectIOTree(children[i]);
-    }
-    symTableInjectIOTree(node->getSibling());
+        if (isDecl(node))
+        {
+            symTableInsert((Decl *)node, false);
+        }
+        return true;
+    });
 }
 
 bool Semantics::isMainFunc(const Func *func) const
@@ -1290,7 +1413,7 @@ bool Semantics::isMainFunc(const Func *func) const
     }
 
     // Function name must be main and in global scope
-    if (func->getName() != "main" || m_symTable->depth() != 1)
+    if (func->getName() != "main" || func->getMemScope() != Node::MemScope::Global)
     {
         return false;
     }
@@ -1302,14 +1425,42 @@ bool Semantics::isMainFunc(const Func *func) const
     }
 
     // If main is previously defined as a variable
-    Decl *decl = symTableGet(func->getName());
-    if (isVar(decl))
+    if (isVar(func->getPrevDecl()))
     {
         return false;
     }
     return true;
 }
 
+bool Semantics::isScope(const Node *node) const
+{
+    switch (node->getNodeKind())
+    {
+        case Node::Kind::For:
+        case Node::Kind::Func:
+            return true;
+        case Node::Kind::Compound:
+        {
+            Node *parent = node->getParent();
+            return parent == nullptr || (parent->getNodeKind() != Node::Kind::For && parent->getNodeKind() != Node::Kind::Func);
+        }
+        default:
+            return false;
+    }
+}
+
+void Semantics::addScopeDecls(Node *node, std::vector<Decl *> &decls) const
+{
+    // Redeclarations never made it into the scope
+    for (; node != nullptr; node = node->getSibling())
+    {
+        if (isDecl(node) && ((Decl *)node)->getPrevDecl() == nullptr)
+        {
+            decls.push_back((Decl *)node);
+        }
+    }
+}
+
 bool Semantics::expOperandsExist(const Exp *exp) const
 {
     if (!isExp(exp))
@@ -1317,12 +1468,11 @@ bool Semantics::expOperandsExist(const Exp *exp) const
         throw std::runtime_error("Semantics::expOperandsExist() - Invalid Exp");
     }
 
-    std::vector<Node *> children = exp->getChildren();
-    if (children.size() < 2 || children[0] == nullptr || children[1] == nullptr)
+    if (exp->getChildCount() < 2 || exp->getChild() == nullptr || exp->getChild(1) == nullptr)
     {
         return false;
     }
-    if (!isExp(children[0]) || !isExp(children[1]))
+    if (!isExp(exp->getChild()) || !isExp(exp->getChild(1)))
     {
         return false;
     }
@@ -1336,9 +1486,8 @@ bool Semantics::lhsExists(const Exp *exp) const
         throw std::runtime_error("Semantics::lhsExists() - Invalid Exp");
     }
 
-    std::vector<Node *> children = exp->getChildren();
-    Exp *lhsExp = (Exp *)(children[0]);
-    if (children.size() == 0 || lhsExp == nullptr)
+    Exp *lhsExp = (Exp *)(exp->getChild());
+    if (lhsExp == nullptr)
     {
         return false;
     }
@@ -1367,112 +1516,3 @@ std::string Semantics::getExpSym(const Exp *exp) const
         throw std::runtime_error("Semantics::getExpSym() - Exp is not an operation");
     }
 }
-
-bool Semantics::hasIndexRelative(const Exp *exp) const
-{
-    if (!isExp(exp))
-    {
-        throw std::runtime_error("Semantics::hasIndexRelative() - Invalid Exp");
-    }
-
-    Node *lastParent = (Node *)exp;
-    Node *parent = exp->getParent();
-    while (parent != nullptr)
-    {
-        if (isBinary(parent))
-        {
-            Binary *binary = (Binary *)parent;
-            if (binary->getType() == Binary::Type::Index)
-            {
-                // On the right side
-                if (binary->getChild(1) == lastParent)
-                {
-                    return true;
-                }
-            }
-        }
-        lastParent = parent;
-        parent = parent->getParent();
-    }
-    return false;
-}
-
-bool Semantics::hasAsgnRelative(const Exp *exp) const
-{
-    if (!isExp(exp))
-    {
-        throw std::runtime_error("Semantics::hasAsgnRelative() - Invalid Exp");
-    }
-
-    Node *lastParent = (Node *)exp;
-    Node *parent = exp->getParent();
-    while (parent != nullptr)
-    {
-        if (isAsgn(parent))
-        {
-            Asgn *asgn = (Asgn *)parent;
-            if (asgn->getType() == Asgn::Type::Asgn)
-            {
-                // On the left side
-                if (asgn->getChild() == lastParent)
-                {
-                    return true;
-                }
-            }
-        }
-        lastParent = parent;
-        parent = parent->getParent();
-    }
-    return false;
-}
-
-bool Semantics::hasNonConstantRelative(const Exp *exp) const
-{
-    if (!isExp(exp))
-    {
-        throw std::runtime_error("Semantics::hasNonConstantRelative() - Invalid Exp");
-    }
-
-    if (isUnary(exp))
-    {
-        Unary *unary = (Unary *)(exp);
-        if (unary->getType() == Unary::Type::Question)
-        {
-            return true;
-        }
-    }
-    else if (isCall(exp) || isId(exp))
-    {
-        return true;
-    }
-
-    std::vector<Node *> children = exp->getChildren();
-    for (int i = 0; i < children.size(); i++)
-    {
-        if (hasNonConstantRelative((Exp *)children[i]))
-        {
-            return true;
-        }
-    }
-
-    // Node *child = (Node *)exp;
-    // while (child != nullptr)
-    // {
-    //     Emit::error(child->getLineNum(), child->stringifyWithType());
-    //     if (isUnary(child))
-    //     {
-    //         Unary *unary = (Unary *)child;
-    //         if (unary->getType() == Unary::Type::Question)
-    //         {
-    //             return true;
-    //         }
-    //     }
-    //     else if (isCall(child) || isId(child))
-    //     {
-    //         return true;
-    //     }
-    //     child = child->getChild();
-    // }
-
-    return false;
-}
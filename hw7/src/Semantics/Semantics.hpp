@@ -3,6 +3,7 @@
 #include "Emit.hpp"
 #include "Is.hpp"
 #include "SymTable.hpp"
+#include "../Tree/Traverse.hpp"
 #include "../Tree/Tree.hpp"
 
 #include <algorithm>
@@ -14,15 +15,32 @@ class Semantics
     public:
         Semantics(SymTable *symTable, const bool verbose);
 
-        // Static
-        static void printGoffset() { std::cout << "Offset for end of global space: " << s_goffset << std::endl; }
+        // Getters
+        int getGoffset() const { return m_goffset; }
+
+        // Setters
+        void setGoffset(const int goffset) { m_goffset = goffset; }
+        void setThreadCount(const unsigned threadCount) { m_threadCount = threadCount; }   // Function bodies analyze() checks at once, 1 checks them in order
+
+        // Print
+        void printGoffset() const { std::cout << "Offset for end of global space: " << m_goffset << std::endl; }
 
         // Helpers
         void analyze(Node *node);
 
+        // A program analyzed a declaration at a time as it is parsed, with the same results as analyze()
+        void begin();
+        void analyzeDecl(Node *decl);
+        void analyzeSignature(Func *func);         // Declare and check a function without its body, see Incremental
+        Decl * lookup(const Intern::Handle name) const { return symTableGet(name); }
+        void end(Node *root);
+
     private:
         // Analyze
         void analyzeTree(Node *node);
+        void analyzeParallel(Node *root);
+        void analyzeBody(Func *func);
+        void analyzeNode(Node *node);
         void analyzeFunc(Func *func);
         void analyzeParm(Parm *parm);
         void analyzeVar(Var *var);
@@ -40,39 +58,41 @@ class Semantics
         void analyzeRange(const Range *range) const;
         void analyzeReturn(const Return *returnN) const;
         void analyzeWhile(const While *whileN) const;
+        void analyzeScopeEnd(const Node *node) const;
 
         // Checks
         void checkOperandsOfSameType(Exp *exp) const;
         void checkOperandsOfType(Exp *exp, const Data::Type type, const bool isMath=true) const;
         void checkIndex(const Binary *binary) const;
-        void checkUnusedWarns() const;
+        void checkRedeclared(const Decl *decl) const;
+        void checkUnusedWarns(std::vector<Decl *> &decls) const;
 
         // Symbol table
         bool symTableInsert(const Decl *decl, const bool global=false, const bool showWarns=true);
-        Decl * symTableGet(const std::string name) const;
+        Decl * symTableGet(const Intern::Handle name) const;
         void symTableInitialize(Node *node);
-        Data * symTableSetType(Node *node);
+        void symTableInitializeNode(Node *node);
+        void symTableFinalizeNode(Node *node);
+        void symTableSetType(Node *node);
         void symTableSimpleEnterScope(const std::string name);
-        void symTableSimpleLeaveScope(const bool showWarns=false);
+        void symTableSimpleLeaveScope();
         bool symTableEnterScope(const Node *node);
-        bool symTableLeaveScope(const Node *node, const bool showWarns=true);
+        bool symTableLeaveScope(const Node *node);
         void symTableInitializeIOTree();
         void symTableInjectIOTree(Node *node);
 
         // Helpers
         bool isMainFunc(const Func *func) const;
+        bool isScope(const Node *node) const;
+        void addScopeDecls(Node *node, std::vector<Decl *> &decls) const;
         bool expOperandsExist(const Exp *exp) const;
         bool lhsExists(const Exp *exp) const;
         std::string getExpSym(const Exp *exp) const;
-        bool hasIndexRelative(const Exp *exp) const;
-        bool hasAsgnRelative(const Exp *exp) const;
-        bool hasNonConstantRelative(const Exp *exp) const;
-
-        // Static
-        inline static int s_goffset;
-        inline static std::vector<int> s_foffsets;
 
-        SymTable *m_symTable;
+        SymTable *m_symTable;           // Only used while resolving names
         bool m_mainExists;
         Node *m_ioRoot;
+        int m_goffset;
+        std::vector<int> m_foffsets;
+        unsigned m_threadCount;
 };
@@ -3,9 +3,7 @@
 // Introduction
 //
 // This symbol table library supplies basic insert and lookup for
-// symbols linked to void * pointers of data. The is expected to use
-// ONLY the SymTable class and NOT the Scope class. The Scope class
-// is used by SymTable in its implementation.
+// symbols linked to void * pointers of data.
 //
 // Plenty of room for improvement inlcuding: better debugging setup,
 // passing of refs rather than values and purpose built char *
@@ -46,120 +44,6 @@ void pointerPrintStr(void *data)
 
 // // // // // // // // // // // // // // // // // // // //
 //
-// Class: Scope
-//
-// Helper class for SymTable
-//
-class SymTable::Scope
-{
-    public:
-        Scope(std::string newname);
-        ~Scope();
-        std::map<std::string, void *> getSyms() { return symbols; }  // Symbols getter
-        std::string scopeName();                                    // returns name of scope
-        void debug(bool state);                                     // sets the debug flag to state
-        void print(void (*printData)(void *));                      // prints the table using the supplied function to print the void *
-        void applyToAll(void (*action)(std::string, void *));       // applies func to all symbol/data pairs
-        bool insert(std::string sym, void *ptr);                    // inserts a new ptr associated with symbol sym, false if already defined
-        void *lookup(std::string sym);                              // returns the ptr associated with sym, NULL if symbol not found
-
-    private:
-        static bool debugFlg;                     // turn on tedious debugging
-        std::string name;                           // name of scope
-        std::map<std::string, void *> symbols;      // use an ordered map (not as fast as unordered)
-
-};
-
-SymTable::Scope::Scope(std::string newname)
-{
-    name = newname;
-    debugFlg = false;
-}
-
-SymTable::Scope::~Scope()
-{
-}
-
-// Returns char *name of scope
-std::string SymTable::Scope::scopeName()
-{
-    return name;
-}
-
-// Set scope debugging
-void SymTable::Scope::debug(bool state)
-{
-    debugFlg = state;
-}
-
-// Print the scope
-void SymTable::Scope::print(void (*printData)(void *))
-{
-    printf("Scope: %-15s -----------------\n", name.c_str());
-    for (std::map<std::string, void *>::iterator it=symbols.begin(); it!=symbols.end(); it++)
-    {
-        printf("%20s: ", (it->first).c_str());
-        printData(it->second);
-        printf("\n");
-    }
-}
-
-// Apply the function to each symbol in this scope
-void SymTable::Scope::applyToAll(void (*action)(std::string, void *))
-{
-    for (std::map<std::string, void *>::iterator it=symbols.begin(); it!=symbols.end(); it++)
-    {
-        action(it->first, it->second);
-    }
-}
-
-// Returns true if insert was successful and false if symbol already in this scope
-bool SymTable::Scope::insert(std::string sym, void *ptr)
-{
-    if (symbols.find(sym) == symbols.end())
-    {
-        if (debugFlg) printf("DEBUG(Scope): insert in \"%s\" the symbol \"%s\".\n", name.c_str(), sym.c_str());
-        if (ptr==NULL)
-        {
-            printf("ERROR(SymTable): Attempting to save a NULL pointer for the symbol '%s'.\n", sym.c_str());
-        }
-        symbols[sym] = ptr;
-        return true;
-    }
-    else
-    {
-        if (debugFlg)
-        {
-            printf("DEBUG(Scope): insert in \"%s\" the symbol \"%s\" but symbol already there!\n", name.c_str(), sym.c_str());
-        }
-        return false;
-    }
-}
-
-void *SymTable::Scope::lookup(std::string sym)
-{
-    if (symbols.find(sym) != symbols.end())
-    {
-        if (debugFlg)
-        {
-            printf("DEBUG(Scope): lookup in \"%s\" for the symbol \"%s\" and found it.\n", name.c_str(), sym.c_str());
-        }
-        return symbols[sym];
-    }
-    else
-    {
-        if (debugFlg)
-        {
-            printf("DEBUG(Scope): lookup in \"%s\" for the symbol \"%s\" and did NOT find it.\n", name.c_str(), sym.c_str());
-        }
-        return NULL;
-    }
-}
-
-bool SymTable::Scope::debugFlg;
-
-// // // // // // // // // // // // // // // // // // // // 
-//
 // Class: SymTable
 //
 //  This is a stack of scopes that represents a symbol table
@@ -172,7 +56,7 @@ SymTable::SymTable()
 
 std::map<std::string, void*> SymTable::getSyms()
 {
-    return (stack.back())->getSyms();
+    return scopeSyms(stack.size() - 1);
 }
 
 void SymTable::debug(bool state)
@@ -190,9 +74,16 @@ int SymTable::depth()
 void SymTable::print(void (*printData)(void *))
 {
     printf("===========  Symbol Table  ===========\n");
-    for (std::vector<Scope *>::iterator it=stack.begin(); it!=stack.end(); it++)
+    for (int scope = 0; scope < stack.size(); scope++)
     {
-        (*it)->print(printData);
+        printf("Scope: %-15s -----------------\n", stack[scope].name.c_str());
+        std::map<std::string, void *> syms = scopeSyms(scope);
+        for (std::map<std::string, void *>::iterator it=syms.begin(); it!=syms.end(); it++)
+        {
+            printf("%20s: ", (it->first).c_str());
+            printData(it->second);
+            printf("\n");
+        }
     }
     printf("===========  ============  ===========\n");
 }
@@ -204,7 +95,7 @@ void SymTable::enter(std::string name)
     {
         printf("DEBUG(SymTable): enter scope \"%s\".\n", name.c_str());
     }
-    stack.push_back(new Scope(name));
+    stack.push_back({name, (int)bindings.size()});
 }
 
 // Leave a scope (not allowed to leave global)
@@ -212,11 +103,16 @@ void SymTable::leave()
 {
     if (debugFlg)
     {
-        printf("DEBUG(SymTable): leave scope \"%s\".\n", (stack.back()->scopeName()).c_str());
+        printf("DEBUG(SymTable): leave scope \"%s\".\n", stack.back().name.c_str());
     }
     if (stack.size() > 1)
     {
-        delete stack.back();
+        // Unwind only the bindings this scope declared, uncovering whatever they shadowed
+        while (bindings.size() > stack.back().firstBinding)
+        {
+            symbols[bindings.back().symbol].binding = bindings.back().shadowed;
+            bindings.pop_back();
+        }
         stack.pop_back();
     }
     else
@@ -228,24 +124,24 @@ void SymTable::leave()
 // Lookup a symbol anywhere in the stack of scopes, NULL if symbol not found, otherwise it returns the stored void * associated with the symbol
 void * SymTable::lookup(std::string sym)
 {
-    void *data;
-    std::string name;
-
-    data = NULL;    // Set even though the scope stack should never be empty
+    return lookup(Intern::handle(sym));
+}
 
-    for (std::vector<Scope *>::reverse_iterator it=stack.rbegin(); it!=stack.rend(); it++)
+void * SymTable::lookup(Intern::Handle sym)
+{
+    void *data = NULL;
+    Symbol *symbol = find(sym);
+    if (symbol != NULL)
     {
-        data = (*it)->lookup(sym);
-        name = (*it)->scopeName();
-        if (data!=NULL) break;
+        data = (symbol->binding >= 0) ? bindings[symbol->binding].ptr : symbol->global;
     }
 
     if (debugFlg)
     {
-        printf("DEBUG(SymTable): lookup the symbol \"%s\" and ", sym.c_str());
+        printf("DEBUG(SymTable): lookup the symbol \"%s\" and ", Intern::string(sym).c_str());
         if (data)
         {
-            printf("found it in the scope named \"%s\".\n", name.c_str());
+            printf("found it.\n");
         }
         else
         {
@@ -260,12 +156,21 @@ void * SymTable::lookup(std::string sym)
 // Lookup a symbol in the global scope, NULL if symbol not found, otherwise it returns the stored void * associated with the symbol
 void * SymTable::lookupGlobal(std::string sym)
 {
-    void *data;
+    return lookupGlobal(Intern::handle(sym));
+}
+
+void * SymTable::lookupGlobal(Intern::Handle sym)
+{
+    void *data = NULL;
+    Symbol *symbol = find(sym);
+    if (symbol != NULL)
+    {
+        data = symbol->global;
+    }
 
-    data = stack[0]->lookup(sym);
     if (debugFlg)
     {
-        printf("DEBUG(SymTable): lookup the symbol \"%s\" in the Globals and %s.\n", sym.c_str(), (data ? "found it" : "did NOT find it"));
+        printf("DEBUG(SymTable): lookup the symbol \"%s\" in the Globals and %s.\n", Intern::string(sym).c_str(), (data ? "found it" : "did NOT find it"));
     }
     return data;
 }
@@ -273,10 +178,15 @@ void * SymTable::lookupGlobal(std::string sym)
 
 // Insert a symbol into the most recent scope, true if insert was successful and false if symbol already in the most recent scope
 bool SymTable::insert(std::string sym, void *ptr)
+{
+    return insert(Intern::handle(sym), ptr);
+}
+
+bool SymTable::insert(Intern::Handle sym, void *ptr)
 {
     if (debugFlg)
     {
-        printf("DEBUG(symbolTable): insert in scope \"%s\" the symbol \"%s\"", (stack.back()->scopeName()).c_str(), sym.c_str());
+        printf("DEBUG(symbolTable): insert in scope \"%s\" the symbol \"%s\"", stack.back().name.c_str(), Intern::string(sym).c_str());
         if(ptr==NULL)
         {
             printf(" WARNING: The inserted pointer is NULL!!");
@@ -284,17 +194,22 @@ bool SymTable::insert(std::string sym, void *ptr)
         printf("\n");
     }
 
-    return (stack.back())->insert(sym, ptr);
+    return bind(sym, ptr, stack.size() == 1);
 }
 
 
 // Insert a symbol into the global scope
 // Returns true is insert was successful and false if symbol already in the global scope
 bool SymTable::insertGlobal(std::string sym, void *ptr)
+{
+    return insertGlobal(Intern::handle(sym), ptr);
+}
+
+bool SymTable::insertGlobal(Intern::Handle sym, void *ptr)
 {
     if (debugFlg)
     {
-        printf("DEBUG(Scope): insert the global symbol \"%s\"", sym.c_str());
+        printf("DEBUG(Scope): insert the global symbol \"%s\"", Intern::string(sym).c_str());
         if(ptr == NULL)
         {
             printf(" WARNING: The inserted pointer is NULL!!");
@@ -302,7 +217,7 @@ bool SymTable::insertGlobal(std::string sym, void *ptr)
         printf("\n");
     }
 
-    return stack[0]->insert(sym, ptr);
+    return bind(sym, ptr, true);
 }
 
 
@@ -310,7 +225,11 @@ bool SymTable::insertGlobal(std::string sym, void *ptr)
 // string and the associated pointer.
 void SymTable::applyToAll(void (*action)(std::string, void *))
 {
-    stack[stack.size()-1]->applyToAll(action);
+    std::map<std::string, void *> syms = getSyms();
+    for (std::map<std::string, void *>::iterator it=syms.begin(); it!=syms.end(); it++)
+    {
+        action(it->first, it->second);
+    }
 }
 
 
@@ -318,7 +237,76 @@ void SymTable::applyToAll(void (*action)(std::string, void *))
 // string and the associated pointer.
 void SymTable::applyToAllGlobal(void (*action)(std::string, void *))
 {
-    stack[0]->applyToAll(action);
+    std::map<std::string, void *> syms = scopeSyms(0);
+    for (std::map<std::string, void *>::iterator it=syms.begin(); it!=syms.end(); it++)
+    {
+        action(it->first, it->second);
+    }
+}
+
+
+// Declare sym in the current scope or the global scope, false if that scope already has it
+bool SymTable::bind(Intern::Handle sym, void *ptr, bool global)
+{
+    if (sym >= symbols.size())
+    {
+        symbols.resize(Intern::count(), {-1, false, NULL});
+    }
+
+    Symbol &symbol = symbols[sym];
+    if (global ? symbol.isGlobal : symbol.binding >= stack.back().firstBinding)
+    {
+        return false;
+    }
+
+    if (ptr==NULL)
+    {
+        printf("ERROR(SymTable): Attempting to save a NULL pointer for the symbol '%s'.\n", Intern::string(sym).c_str());
+    }
+
+    if (global)
+    {
+        symbol.isGlobal = true;
+        symbol.global = ptr;
+        globals.push_back(sym);
+    }
+    else
+    {
+        bindings.push_back({sym, ptr, symbol.binding});
+        symbol.binding = bindings.size() - 1;
+    }
+    return true;
+}
+
+
+SymTable::Symbol * SymTable::find(Intern::Handle sym)
+{
+    if (sym < 0 || sym >= symbols.size())
+    {
+        return NULL;
+    }
+    return &symbols[sym];
+}
+
+
+std::map<std::string, void*> SymTable::scopeSyms(int scope)
+{
+    std::map<std::string, void *> syms;
+    if (scope == 0)
+    {
+        for (Intern::Handle sym : globals)
+        {
+            syms[Intern::string(sym)] = symbols[sym].global;
+        }
+        return syms;
+    }
+
+    int last = (scope + 1 < stack.size()) ? stack[scope + 1].firstBinding : bindings.size();
+    for (int binding = stack[scope].firstBinding; binding < last; binding++)
+    {
+        syms[Intern::string(bindings[binding].symbol)] = bindings[binding].ptr;
+    }
+    return syms;
 }
 
 
@@ -347,7 +335,7 @@ void countSymbols(std::string sym, void *ptr)
 
 bool SymTable::test()
 {
-    Scope s("global");
+    SymTable s;
 
     s.debug(true);
     s.insert("dog", (char *)"woof");
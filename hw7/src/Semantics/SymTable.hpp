@@ -1,4 +1,4 @@
-// // // // // // // // // // // // // // // // // // // // 
+// // // // // // // // // // // // // // // // // // // //
 //
 // Introduction
 //
@@ -19,6 +19,8 @@
 //
 #pragma once
 
+#include "../Intern/Intern.hpp"
+
 #include <map>
 #include <vector>
 #include <string>
@@ -30,7 +32,7 @@ void pointerPrintAddr(void *data);
 void pointerPrintLongInteger(void *data);
 void pointerPrintStr(void *data);
 
-// // // // // // // // // // // // // // // // // // // // 
+// // // // // // // // // // // // // // // // // // // //
 //
 // Class: SymTable
 //
@@ -38,6 +40,11 @@ void pointerPrintStr(void *data);
 // is constructed and remains for the lifetime of the object instance.
 // SymTable manages nested scopes as a result.
 //
+// Symbols are indexed directly by their Intern handle. A symbol points at
+// its innermost local binding, each binding points at the one it shadows,
+// and the bindings form an undo log so leaving a scope only touches the
+// symbols that scope declared.
+//
 class SymTable
 {
     public:
@@ -50,14 +57,44 @@ class SymTable
         void enter(std::string name);                                   // Enter a scope with given name
         void leave();                                                   // Leave a scope (not allowed to leave global)
         void * lookup(std::string sym);                                 // Returns ptr associated with sym anywhere in symbol table, NULL if symbol not found
+        void * lookup(Intern::Handle sym);
         void * lookupGlobal(std::string sym);                           // Returns ptr associated with sym in globals, NULL if symbol not found
+        void * lookupGlobal(Intern::Handle sym);
         bool insert(std::string sym, void *ptr);                        // Inserts new ptr associated with symbol sym in current scope, false if already defined
+        bool insert(Intern::Handle sym, void *ptr);
         bool insertGlobal(std::string sym, void *ptr);                  // Inserts a new ptr associated with symbol sym, false if already defined
+        bool insertGlobal(Intern::Handle sym, void *ptr);
         void applyToAll(void (*action)(std::string , void *));          // Apply func to all symbol/data pairs in local scope
         void applyToAllGlobal(void (*action)(std::string , void *));    // Apply func to all symbol/data pairs in global scope
 
     private:
-        class Scope;
-        std::vector<Scope *> stack;
+        struct Symbol
+        {
+            int binding;        // innermost local binding, -1 if none
+            bool isGlobal;      // declared in the global scope
+            void *global;
+        };
+
+        struct Binding
+        {
+            Intern::Handle symbol;
+            void *ptr;
+            int shadowed;       // binding this one hides, -1 if none
+        };
+
+        struct Scope
+        {
+            std::string name;
+            int firstBinding;   // bindings from here on belong to this scope
+        };
+
+        bool bind(Intern::Handle sym, void *ptr, bool global);          // Declare sym in the current or global scope, false if already there
+        Symbol * find(Intern::Handle sym);                              // The entry for sym, NULL if it was never declared
+        std::map<std::string, void*> scopeSyms(int scope);              // Symbols declared in a scope ordered by name
+
+        std::vector<Symbol> symbols;            // indexed by Intern handle
+        std::vector<Binding> bindings;          // undo log of local declarations, innermost last
+        std::vector<Intern::Handle> globals;    // symbols declared in the global scope
+        std::vector<Scope> stack;
         bool debugFlg;
 };
@@ -0,0 +1,129 @@
+#include "SourceFile.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SourceFile::SourceFile() : m_buffer(nullptr), m_size(0), m_mapSize(0) {}
+
+SourceFile::~SourceFile()
+{
+    release();
+}
+
+bool SourceFile::map(const std::string &path)
+{
+    release();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+
+    // Reserve zeroed pages for the file and its two NULs, then map the file over the front.
+    // The tail of the file's last page reads as zeros, and so do the reserved pages after it.
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t size = info.st_size;
+    size_t mapSize = (size + 2 + pageSize - 1) / pageSize * pageSize;
+    void *buffer = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+    if (size > 0 && mmap(buffer, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(buffer, mapSize);
+        close(fd);
+        return false;
+    }
+    close(fd);
+
+    madvise(buffer, mapSize, MADV_SEQUENTIAL);
+    m_buffer = (char *)buffer;
+    m_size = size;
+    m_mapSize = mapSize;
+    return true;
+}
+
+bool SourceFile::load(const std::string &path)
+{
+    release();
+
+    FILE *file = fopen(path.c_str(), "r");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fileno(file), &info) != 0 || !S_ISREG(info.st_mode))
+    {
+        fclose(file);
+        return false;
+    }
+
+    // Whatever the file holds once read is the source, it may have shrunk since its size was taken
+    size_t size = info.st_size;
+    char *buffer = new char[size + 2];
+    size_t count = 0;
+    while (count < size)
+    {
+        size_t chunk = read(file, buffer + count, size - count);
+        if (chunk == 0)
+        {
+            break;
+        }
+        count += chunk;
+    }
+    fclose(file);
+
+    buffer[count] = '\0';
+    buffer[count + 1] = '\0';
+    m_buffer = buffer;
+    m_size = count;
+    m_mapSize = 0;
+    return true;
+}
+
+void SourceFile::release()
+{
+    if (m_buffer != nullptr && m_mapSize > 0)
+    {
+        munmap(m_buffer, m_mapSize);
+    }
+    else
+    {
+        delete[] m_buffer;
+    }
+    m_buffer = nullptr;
+    m_size = 0;
+    m_mapSize = 0;
+}
+
+size_t SourceFile::read(FILE *file, char *buffer, const size_t size)
+{
+    // Unlike fread() this returns as soon as a pipe has anything, so a slow writer is never waited on for a full buffer
+    while (true)
+    {
+        ssize_t count = ::read(fileno(file), buffer, size);
+        if (count >= 0)
+        {
+            return count;
+        }
+        if (errno != EINTR)
+        {
+            return 0;
+        }
+    }
+}
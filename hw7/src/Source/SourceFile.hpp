@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <stdio.h>
+#include <string>
+
+// A source file mapped into memory so the scanner can read it in place.
+// The buffer ends with the two NUL bytes flex requires of a scan buffer and
+// stays valid until release(), so tokens can keep spans into it instead of
+// copies. Pages are mapped private, the scanner's writes never reach the file.
+// A file that may be cut short while it is scanned is loaded instead, read
+// into a buffer of its own, since a mapped page past the new end faults.
+class SourceFile
+{
+    public:
+        SourceFile();
+        SourceFile(const SourceFile &) = delete;
+        SourceFile & operator=(const SourceFile &) = delete;
+        ~SourceFile();
+
+        // Getters
+        char * getBuffer() const { return m_buffer; }
+        size_t getBufferSize() const { return m_size + 2; }     // Including the two NULs
+        size_t getSize() const { return m_size; }
+
+        // Helpers
+        bool map(const std::string &path);                      // False if path is not a regular file that can be mapped
+        bool load(const std::string &path);                     // False if path is not a regular file that can be read
+        void release();
+
+        // Static
+        static size_t read(FILE *file, char *buffer, const size_t size);  // What the stream has ready, up to size bytes, 0 at its end
+
+    private:
+        char *m_buffer;
+        size_t m_size;
+        size_t m_mapSize;                                       // 0 if the buffer was loaded
+};
@@ -1,121 +1,173 @@
 // Based on yyerror.cpp by Michael Wilder (see materials directory)
 #include "SyntaxError.hpp"
 
-static std::map<std::string , char *> niceTokenNameMap;
+#include <algorithm>
+#include <mutex>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unordered_map>
+#include <vector>
 
-int SyntaxError::split(char *s, char *strs[], char breakchar)
+static std::unordered_map<std::string_view, std::string_view> niceTokenNameMap;
+
+void SyntaxError::initErrorProcessing()
 {
-    int num;
+    // The table is shared by every compilation, fill it once
+    static std::once_flag filled;
+    std::call_once(filled, []()
+    {
+        niceTokenNameMap["ADDASGN"] = "\"+=\"";
+        niceTokenNameMap["AND"] = "\"and\"";
+        niceTokenNameMap["ASGN"] = "'='";
+        niceTokenNameMap["Begin"] = "\"begin\"";
+        niceTokenNameMap["BOOL"] = "\"bool\"";
+        niceTokenNameMap["BOOLCONST"] = "Boolean constant";
+        niceTokenNameMap["BREAK"] = "\"break\"";
+        niceTokenNameMap["BY"] = "\"by\"";
+        niceTokenNameMap["CHAR"] = "\"char\"";
+        niceTokenNameMap["CHARCONST"] = "character constant";
+        niceTokenNameMap["CHSIGN"] = "-";
+        niceTokenNameMap["DEC"] = "\"--\"";
+        niceTokenNameMap["DIVASGN"] = "\"/=\"";
+        niceTokenNameMap["DO"] = "\"do\"";
+        niceTokenNameMap["ELSE"] = "\"else\"";
+        niceTokenNameMap["End"] = "\"end\"";
+        niceTokenNameMap["FOR"] = "\"for\"";
+        niceTokenNameMap["GEQ"] = "\">=\"";
+        niceTokenNameMap["ID"] = "identifier";
+        niceTokenNameMap["IF"] = "\"if\"";
+        niceTokenNameMap["INC"] = "\"++\"";
+        niceTokenNameMap["INT"] = "\"int\"";
+        niceTokenNameMap["LEQ"] = "\"<=\"";
+        niceTokenNameMap["MULASGN"] = "\"*=\"";
+        niceTokenNameMap["NEQ"] = "\"!=\"";
+        niceTokenNameMap["NOT"] = "\"not\"";
+        niceTokenNameMap["NUMCONST"] = "numeric constant";
+        niceTokenNameMap["OR"] = "\"or\"";
+        niceTokenNameMap["RETURN"] = "\"return\"";
+        niceTokenNameMap["SIZEOF"] = "\"*\"";
+        niceTokenNameMap["QUESTION"] = "'?'";
+        niceTokenNameMap["STATIC"] = "\"static\"";
+        niceTokenNameMap["STRINGCONST"] = "string constant";
+        niceTokenNameMap["SUBASGN"] = "\"-=\"";
+        niceTokenNameMap["THEN"] = "\"then\"";
+        niceTokenNameMap["TO"] = "\"to\"";
+        niceTokenNameMap["WHILE"] = "\"while\"";
+        niceTokenNameMap["LPAREN"] = "'('";
+        niceTokenNameMap["RPAREN"] = "')'";
+        niceTokenNameMap["MOD"] = "'%'";
+        niceTokenNameMap["LCURLY"] = "'{'";
+        niceTokenNameMap["RCURLY"] = "'}'";
+        niceTokenNameMap["LBRACK"] = "'['";
+        niceTokenNameMap["RBRACK"] = "']'";
+        niceTokenNameMap["COLON"] = "':'";
+        niceTokenNameMap["SEMICOLON"] = "';'";
+        niceTokenNameMap["COMMA"] = "','";
+        niceTokenNameMap["GT"] = "'>'";
+        niceTokenNameMap["LT"] = "'<'";
+        niceTokenNameMap["EQ"] = "\"==\"";
+        niceTokenNameMap["MUL"] = "'*'";
+        niceTokenNameMap["DIV"] = "'/'";
+        niceTokenNameMap["ADD"] = "'+'";
+        niceTokenNameMap["SUB"] = "'-'";
+        niceTokenNameMap["$end"] = "end of input";
+        niceTokenNameMap["end of file"] = "end of input";
+        niceTokenNameMap["invalid token"] = "invalid token";
+    });
+}
 
-    strs[0] = s;
-    num = 1;
-    for (char *p = s; *p; p++)
+std::string SyntaxError::message(const std::string_view msg, const std::string_view lastToken)
+{
+    // "syntax error, unexpected X, expecting A or B", the expected tokens are listed sorted
+    static const std::string_view phrases[] = {"end of file", "invalid token"};
+    std::vector<std::string_view> words;
+    size_t start = 0;
+    while (true)
     {
-        if (*p == breakchar)
+        // Bison's names for the end of input and unknown tokens are the only ones with spaces
+        size_t end = start;
+        for (const std::string_view phrase : phrases)
         {
-            strs[num++] = p + 1;
-            *p = '\0';
+            if (msg.compare(start, phrase.size(), phrase) == 0)
+            {
+                end = start + phrase.size();
+            }
+        }
+        size_t space = msg.find(' ', end);
+        if (space == std::string_view::npos)
+        {
+            words.push_back(msg.substr(start));
+            break;
         }
+        words.push_back(msg.substr(start, space - start));
+        start = space + 1;
+    }
+    if (words.size() < 4)
+    {
+        return std::string(msg);
     }
-    strs[num] = NULL;
 
-    return num;
-}
+    if (words.size() > 4)
+    {
+        words[3].remove_suffix(1);
+    }
+    for (size_t i = 3; i < words.size(); i += 2)
+    {
+        words[i] = niceTokenStr(words[i]);
+    }
 
-void SyntaxError::trim(char *s)
-{
-    s[strlen(s)-1] = '\0';
-}
+    std::string report = "Syntax error, unexpected " + std::string(words[3]);
+    if (elaborate(words[3]))
+    {
+        if (!lastToken.empty() && (lastToken[0] == '\'' || lastToken[0] == '"'))
+        {
+            report += " " + std::string(lastToken);
+        }
+        else
+        {
+            report += " \"" + std::string(lastToken) + "\"";
+        }
+    }
 
-void SyntaxError::initErrorProcessing()
-{
-    niceTokenNameMap["ADDASGN"] = (char *)"\"+=\"";
-    niceTokenNameMap["AND"] = (char *)"\"and\"";
-    niceTokenNameMap["ASGN"] = (char *)"'='";
-    niceTokenNameMap["Begin"] = (char *)"\"begin\"";
-    niceTokenNameMap["BOOL"] = (char *)"\"bool\"";
-    niceTokenNameMap["BOOLCONST"] = (char *)"Boolean constant";
-    niceTokenNameMap["BREAK"] = (char *)"\"break\"";
-    niceTokenNameMap["BY"] = (char *)"\"by\"";
-    niceTokenNameMap["CHAR"] = (char *)"\"char\"";
-    niceTokenNameMap["CHARCONST"] = (char *)"character constant";
-    niceTokenNameMap["CHSIGN"] = (char *)"-";
-    niceTokenNameMap["DEC"] = (char *)"\"--\"";
-    niceTokenNameMap["DIVASGN"] = (char *)"\"/=\"";
-    niceTokenNameMap["DO"] = (char *)"\"do\"";
-    niceTokenNameMap["ELSE"] = (char *)"\"else\"";
-    niceTokenNameMap["End"] = (char *)"\"end\"";
-    niceTokenNameMap["FOR"] = (char *)"\"for\"";
-    niceTokenNameMap["GEQ"] = (char *)"\">=\"";
-    niceTokenNameMap["ID"] = (char *)"identifier";
-    niceTokenNameMap["IF"] = (char *)"\"if\"";
-    niceTokenNameMap["INC"] = (char *)"\"++\"";
-    niceTokenNameMap["INT"] = (char *)"\"int\"";
-    niceTokenNameMap["LEQ"] = (char *)"\"<=\"";
-    niceTokenNameMap["MULASGN"] = (char *)"\"*=\"";
-    niceTokenNameMap["NEQ"] = (char *)"\"!=\"";
-    niceTokenNameMap["NOT"] = (char *)"\"not\"";
-    niceTokenNameMap["NUMCONST"] = (char *)"numeric constant";
-    niceTokenNameMap["OR"] = (char *)"\"or\"";
-    niceTokenNameMap["RETURN"] = (char *)"\"return\"";
-    niceTokenNameMap["SIZEOF"] = (char *)"\"*\"";
-    niceTokenNameMap["STATIC"] = (char *)"\"static\"";
-    niceTokenNameMap["STRINGCONST"] = (char *)"string constant";
-    niceTokenNameMap["SUBASGN"] = (char *)"\"-=\"";
-    niceTokenNameMap["THEN"] = (char *)"\"then\"";
-    niceTokenNameMap["TO"] = (char *)"\"to\"";
-    niceTokenNameMap["WHILE"] = (char *)"\"while\"";
-    niceTokenNameMap["LPAREN"] = (char *)"'('";
-    niceTokenNameMap["RPAREN"] = (char *)"')'";
-    niceTokenNameMap["MOD"] = (char *)"'%'";
-    niceTokenNameMap["LCURLY"] = (char *)"'{'";
-    niceTokenNameMap["RCURLY"] = (char *)"'}'";
-    niceTokenNameMap["LBRACK"] = (char *)"'['";
-    niceTokenNameMap["RBRACK"] = (char *)"']'";
-    niceTokenNameMap["COLON"] = (char *)"':'";
-    niceTokenNameMap["SEMICOLON"] = (char *)"';'";
-    niceTokenNameMap["COMMA"] = (char *)"','";
-    niceTokenNameMap["GT"] = (char *)"'>'";
-    niceTokenNameMap["LT"] = (char *)"'<'";
-    niceTokenNameMap["EQ"] = (char *)"\"==\"";
-    niceTokenNameMap["MUL"] = (char *)"'*'";
-    niceTokenNameMap["DIV"] = (char *)"'/'";
-    niceTokenNameMap["ADD"] = (char *)"'+'";
-    niceTokenNameMap["SUB"] = (char *)"'-'";
-    niceTokenNameMap["$end"] = (char *)"end of input";
+    if (words.size() > 4)
+    {
+        report += ",";
+    }
+
+    std::vector<std::string_view> expected;
+    for (size_t i = 5; i < words.size(); i += 2)
+    {
+        expected.push_back(words[i]);
+    }
+    std::sort(expected.begin(), expected.end());
+    for (size_t i = 5; i < words.size(); i += 2)
+    {
+        words[i] = expected[(i - 5) / 2];
+    }
+    for (size_t i = 4; i < words.size(); i++)
+    {
+        report += " " + std::string(words[i]);
+    }
+    return report + ".";
 }
 
-char * SyntaxError::niceTokenStr(char *tokenName)
+std::string_view SyntaxError::niceTokenStr(const std::string_view tokenName)
 {
     if (tokenName[0] == '\'')
     {
         return tokenName;
     }
-    if (niceTokenNameMap.find(tokenName) == niceTokenNameMap.end())
+    auto it = niceTokenNameMap.find(tokenName);
+    if (it == niceTokenNameMap.end())
     {
-        printf("ERROR(SYSTEM): niceTokenStr fails to find string '%s'\n", tokenName);
+        printf("ERROR(SYSTEM): niceTokenStr fails to find string '%.*s'\n", (int)tokenName.size(), tokenName.data());
         fflush(stdout);
         exit(1);
     }
-    return niceTokenNameMap[tokenName];
-}
-
-bool SyntaxError::elaborate(char *s)
-{
-    return (strstr(s, "constant") || strstr(s, "identifier"));
+    return it->second;
 }
 
-void SyntaxError::tinySort(char *base[], int num, int step, bool up)
+bool SyntaxError::elaborate(const std::string_view s)
 {
-    for (int i = step; i < num; i += step)
-    {
-        for (int j = 0; j < i; j += step)
-        {
-            if (up ^ (strcmp(base[i], base[j]) > 0))
-            {
-                char *tmp;
-                tmp = base[i]; base[i] = base[j]; base[j] = tmp;
-            }
-        }
-    }
+    return s.find("constant") != std::string_view::npos || s.find("identifier") != std::string_view::npos;
 }
@@ -1,10 +1,19 @@
 // Based on CS445 - Calculator Example Program by Robert Heckendorn
 #pragma once
 
+#include "Arena/Arena.hpp"
+#include "Intern/Intern.hpp"
+
 #include <string>
+#include <string_view>
 
 struct TokenData
 {
-    int lineNum;                // Line number of token occurrence
-    std::string tokenContent;   // The string that was read
+    int lineNum;                    // Line number of token occurrence
+    std::string_view tokenContent;  // The text that was read, a span of the source buffer or an arena copy, empty for identifiers
+    Intern::Handle name;            // The interned identifier, Intern::None for other tokens
+
+    // Tokens live in the compilation unit's arena alongside the tree
+    static void * operator new(size_t size) { return Arena::unit().allocate(size); }
+    static void operator delete(void *ptr) {}
 };
@@ -1,17 +1,40 @@
 #include "Data.hpp"
 
-Data::Data(Data::Type type, bool isArray, bool isStatic) : m_isArray(isArray), m_isStatic(isStatic), m_arraySize(-1)
+Data::Data(const Data::Type type, const bool isArray, const bool isStatic, const int arraySize) : m_isArray(isArray), m_isStatic(isStatic), m_arraySize(arraySize), m_type(type) {}
+
+thread_local Data::Table Data::s_own;
+
+const Data * Data::get(const Data::Type type, const bool isArray, const bool isStatic, const int arraySize)
 {
-    m_next = nullptr;
-    if (isArray)
-    {
-        m_next = new Data(type, false, false);
-        m_type = Data::Type::Undefined;
-    }
-    else
+    Table &table = Data::table();
+    uint64_t key = ((uint64_t)(uint32_t)arraySize << 8) | ((uint64_t)type << 2) | ((uint64_t)isArray << 1) | (uint64_t)isStatic;
+    auto found = table.slots.find(key);
+    if (found != table.slots.end())
     {
-        m_type = type;
+        return found->second;
     }
+
+    table.types.push_back(Data(type, isArray, isStatic, arraySize));
+    const Data *data = &table.types.back();
+    table.slots.emplace(key, data);
+    return data;
+}
+
+size_t Data::getCount()
+{
+    return table().types.size();
+}
+
+Data::Table * Data::setTable(Table *table)
+{
+    Table *previous = s_table;
+    s_table = table;
+    return previous;
+}
+
+void Data::reset()
+{
+    s_own = Table();
 }
 
 std::string Data::typeToString(Data::Type type)
@@ -44,33 +67,6 @@ std::string Data::typeToString(Data::Type type)
     return stringy;
 }
 
-Data::Type Data::getNextType() const
-{
-    if (m_next == nullptr)
-    {
-        return m_type;
-    }
-    return m_next->getNextType();
-}
-
-Data * Data::getNextData() const
-{
-    if (m_next == nullptr)
-    {
-        return new Data(m_type, false, false);
-    }
-    return m_next->getNextData();
-}
-
-void Data::setType(const Data::Type type)
-{
-    m_type = type;
-    if (m_next != nullptr)
-    {
-        m_next->setType(type);
-    }
-}
-
 std::string Data::stringify() const
 {
     return typeToString(m_type);
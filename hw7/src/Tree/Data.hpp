@@ -1,15 +1,28 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
 #include <iostream>
+#include <unordered_map>
 
+// Types are hash-consed: every distinct combination of type, array-ness,
+// staticness and array size is stored once in a per-thread table and shared
+// by every node that has it, so two types are equal exactly when their
+// pointers are. Data is immutable; the with*() helpers return the canonical variant.
+// Like Intern's, a thread's own table is emptied once its last compilation
+// ends, and a thread can borrow another's while it is not growing.
 class Data
 {
     public:
         enum class Type { Undefined, Int, Bool, Char, String, Void };
-
-        Data(Data::Type type, bool isArray, bool isStatic);
+        struct Table;
 
         // Static
+        static const Data * get(const Data::Type type, const bool isArray=false, const bool isStatic=false, const int arraySize=-1);
+        static size_t getCount();
+        static Table & table();                                     // The table types are made in on this thread
+        static Table * setTable(Table *table);                      // Returns the table it replaces, nullptr restores this thread's own
+        static void reset();                                        // Empties this thread's own table
         static std::string typeToString(Data::Type type);
 
         // Getters
@@ -17,23 +30,37 @@ class Data
         bool getIsStatic() const { return m_isStatic; }
         int getArraySize() const { return m_arraySize; }
         Type getType() const { return m_type; }
-        Data::Type getNextType() const;
-        Data * getNextData() const;
+        Data::Type getNextType() const { return m_type; }               // Element type of an array, the type itself otherwise
+        const Data * getNextData() const { return get(m_type); }
 
-        // Setters
-        void setIsArray(const bool isArray) { m_isArray = isArray; }
-        void setIsStatic(const bool isStatic) { m_isStatic = isStatic; }
-        void setArraySize(const int arraySize) { m_arraySize = arraySize; }
-        void setType(const Data::Type type);
-        void setCopyOf(const std::string copyOf);
+        // Variants
+        const Data * withType(const Data::Type type) const { return get(type, m_isArray, m_isStatic, m_arraySize); }
+        const Data * withIsArray(const bool isArray) const { return get(m_type, isArray, m_isStatic, m_arraySize); }
+        const Data * withIsStatic(const bool isStatic) const { return get(m_type, m_isArray, isStatic, m_arraySize); }
+        const Data * withArraySize(const int arraySize) const { return get(m_type, m_isArray, m_isStatic, arraySize); }
 
         // Print
         std::string stringify() const;
 
     private:
+        Data(const Data::Type type, const bool isArray, const bool isStatic, const int arraySize);
+
         bool m_isArray;
         bool m_isStatic;
         int m_arraySize;
         Data::Type m_type;
-        Data *m_next;
+
+        static thread_local Table s_own;
+        inline static thread_local Table *s_table = nullptr;
+};
+
+struct Data::Table
+{
+    std::deque<Data> types;                         // A deque so canonical pointers stay valid as it grows
+    std::unordered_map<uint64_t, const Data *> slots;
 };
+
+inline Data::Table & Data::table()
+{
+    return (s_table != nullptr) ? *s_table : s_own;
+}
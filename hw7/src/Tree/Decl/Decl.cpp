@@ -1,16 +1,16 @@
 #include "Decl.hpp"
 
-Decl::Decl(const int lineNum, const std::string name, Data *data) : Node::Node(lineNum), m_name(name), m_data(data), m_showErrors(true), m_isUsed(false)
+Decl::Decl(const Node::Kind kind, const int lineNum, const Intern::Handle name, const Data *data) : Node::Node(kind, lineNum), m_name(name), m_data(data), m_prevDecl(NodePool::None), m_showErrors(true), m_isUsed(false)
 {
     setMemExists(true);
 }
 
 void Decl::setType(const Data::Type type)
 {
-    m_data->setType(type);
-    if (m_sibling != nullptr)
+    Decl *node = this;
+    while (node != nullptr)
     {
-        Decl *node = (Decl *)m_sibling;
-        node->setType(type);
+        node->m_data = node->m_data->withType(type);
+        node = (Decl *)(node->getSibling());
     }
 }
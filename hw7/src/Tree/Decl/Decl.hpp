@@ -2,28 +2,35 @@
 
 #include "../Data.hpp"
 #include "../Node.hpp"
+#include "../../Intern/Intern.hpp"
+
+#include <atomic>
 
 class Decl : public Node
 {
     public:
-        Decl(const int lineNum, const std::string name, Data *data);
+        Decl(const Node::Kind kind, const int lineNum, const Intern::Handle name, const Data *data);
 
         // Getters
-        std::string getName() const { return m_name; }
-        Data * getData() const { return m_data; }
+        const std::string & getName() const { return Intern::string(m_name); }
+        Intern::Handle getNameHandle() const { return m_name; }
+        const Data * getData() const { return m_data; }
         bool getShowErrors() const { return m_showErrors; }
-        bool getIsUsed() const { return m_isUsed; }
+        bool getIsUsed() const { return m_isUsed.load(std::memory_order_relaxed); }
+        Decl * getPrevDecl() const { return (Decl *)at(m_prevDecl); }  // The declaration in the same scope this one redeclares, nullptr if none
 
         // Setters
         void setShowErrors(const bool showErrors) { m_showErrors = showErrors; }
         void setType(const Data::Type type);
-        void makeUsed() { m_isUsed = true; }
+        void makeUsed() { m_isUsed.store(true, std::memory_order_relaxed); }    // Bodies analyzed at once may use the same global
+        void setPrevDecl(const Decl *prevDecl) { m_prevDecl = (prevDecl != nullptr) ? prevDecl->getIndex() : NodePool::None; }
 
     protected:
-        const std::string m_name;
-        Data *m_data;
+        const Intern::Handle m_name;
+        const Data *m_data;
 
     private:
+        Index m_prevDecl;
         bool m_showErrors;
-        bool m_isUsed;
+        std::atomic<bool> m_isUsed;
 };
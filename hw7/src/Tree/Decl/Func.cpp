@@ -1,10 +1,10 @@
 #include "Func.hpp"
 
-Func::Func(const int lineNum, const std::string funcName, Data *data) : Decl::Decl(lineNum, funcName, data), m_hasReturn(false) {}
+Func::Func(const int lineNum, const Intern::Handle funcName, const Data *data) : Decl::Decl(Node::Kind::Func, lineNum, funcName, data), m_hasReturn(false) {}
 
 std::string Func::stringify() const
 {
-    return "Func: " + m_name + " returns type " + m_data->stringify();
+    return "Func: " + getName() + " returns type " + m_data->stringify();
 }
 
 unsigned Func::getParmCount() const
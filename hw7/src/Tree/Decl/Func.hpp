@@ -5,10 +5,9 @@
 class Func : public Decl
 {
     public:
-        Func(const int lineNum, const std::string funcName, Data *data);
+        Func(const int lineNum, const Intern::Handle funcName, const Data *data);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Func; }
         std::string stringify() const override;
 
         // Getters
@@ -1,6 +1,6 @@
 #include "Parm.hpp"
 
-Parm::Parm(const int lineNum, const std::string parmName, Data *data) : Decl::Decl(lineNum, parmName, data) {}
+Parm::Parm(const int lineNum, const Intern::Handle parmName, const Data *data) : Decl::Decl(Node::Kind::Parm, lineNum, parmName, data) {}
 
 std::string Parm::stringify() const
 {
@@ -9,7 +9,7 @@ std::string Parm::stringify() const
         throw std::runtime_error("Parm::stringify() - Data must exist");
     }
 
-    std::string stringWithType = "Parm: " + m_name + " of ";
+    std::string stringWithType = "Parm: " + getName() + " of ";
     if (m_data->getIsStatic() && m_data->getIsArray())
     {
         stringWithType += "static array of ";
@@ -5,9 +5,8 @@
 class Parm : public Decl
 {
     public:
-        Parm(const int lineNum, const std::string parmName, Data *data);
+        Parm(const int lineNum, const Intern::Handle parmName, const Data *data);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Parm; }
         std::string stringify() const override;
 };
@@ -1,6 +1,6 @@
 #include "Var.hpp"
 
-Var::Var(const int lineNum, const std::string isVarame, Data *data) : Decl::Decl(lineNum, isVarame, data), m_isInitialized(false), m_isGlobal(false) {}
+Var::Var(const int lineNum, const Intern::Handle isVarame, const Data *data) : Decl::Decl(Node::Kind::Var, lineNum, isVarame, data), m_isInitialized(false), m_isGlobal(false) {}
 
 std::string Var::stringify() const
 {
@@ -9,7 +9,7 @@ std::string Var::stringify() const
         throw std::runtime_error("Var::stringify() - Data must exist");
     }
 
-    std::string stringWithType = "Var: " + m_name + " of ";
+    std::string stringWithType = "Var: " + getName() + " of ";
     if (m_data->getIsStatic() && m_data->getIsArray())
     {
         stringWithType += "static array of ";
@@ -28,9 +28,10 @@ std::string Var::stringify() const
 
 void Var::makeStatic()
 {
-    if (m_sibling != nullptr)
+    Var *var = this;
+    while (var != nullptr)
     {
-        ((Var* )m_sibling)->makeStatic();
+        var->m_data = var->m_data->withIsStatic(true);
+        var = (Var *)(var->getSibling());
     }
-    m_data->setIsStatic(true);
 }
@@ -5,10 +5,9 @@
 class Var : public Decl
 {
     public:
-        Var(const int lineNum, const std::string isVarame, Data *data);
+        Var(const int lineNum, const Intern::Handle isVarame, const Data *data);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Var; }
         std::string stringify() const override;
 
         // Getters
@@ -1,6 +1,6 @@
 #include "Asgn.hpp"
 
-Asgn::Asgn(const int lineNum, const Asgn::Type type) : Exp::Exp(lineNum, new Data(Data::Type::Undefined, false, false)), m_type(type)
+Asgn::Asgn(const int lineNum, const Asgn::Type type) : Exp::Exp(Node::Kind::Asgn, lineNum, Data::get(Data::Type::Undefined, false, false)), m_type(type)
 {
     switch (m_type)
     {
@@ -10,7 +10,7 @@ Asgn::Asgn(const int lineNum, const Asgn::Type type) : Exp::Exp(lineNum, new Dat
         case Asgn::Type::SubAsgn:
         case Asgn::Type::DivAsgn:
         case Asgn::Type::MulAsgn:
-            m_data->setType(Data::Type::Int);
+            m_data = m_data->withType(Data::Type::Int);
             break;
         default:
             throw std::runtime_error("Asgn::Asgn() - Unknown type");
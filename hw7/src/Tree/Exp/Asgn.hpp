@@ -10,7 +10,6 @@ class Asgn : public Exp
         Asgn(const int lineNum, const Asgn::Type type);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Asgn; }
         std::string stringify() const override;
 
         // Getters
@@ -1,6 +1,6 @@
 #include "Binary.hpp"
 
-Binary::Binary(const int lineNum, const Binary::Type type) : Exp::Exp(lineNum, new Data(Data::Type::Undefined, false, false)), m_type(type)
+Binary::Binary(const int lineNum, const Binary::Type type) : Exp::Exp(Node::Kind::Binary, lineNum, Data::get(Data::Type::Undefined, false, false)), m_type(type)
 {
     switch (m_type)
     {
@@ -9,7 +9,7 @@ Binary::Binary(const int lineNum, const Binary::Type type) : Exp::Exp(lineNum, n
         case Binary::Type::Mod:
         case Binary::Type::Add:
         case Binary::Type::Sub:
-           m_data->setType(Data::Type::Int);
+           m_data = m_data->withType(Data::Type::Int);
            break;
         case Binary::Type::Index:
             break;
@@ -21,7 +21,7 @@ Binary::Binary(const int lineNum, const Binary::Type type) : Exp::Exp(lineNum, n
         case Binary::Type::GEQ:
         case Binary::Type::EQ:
         case Binary::Type::NEQ:
-            m_data->setType(Data::Type::Bool);
+            m_data = m_data->withType(Data::Type::Bool);
             break;
         default:
             throw std::runtime_error("Binary::Binary() - Unknown type");
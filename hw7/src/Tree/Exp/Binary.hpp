@@ -10,7 +10,6 @@ class Binary : public Exp
         Binary(const int lineNum, const Binary::Type type);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Binary; }
         std::string stringify() const override;
 
         // Getters
@@ -1,10 +1,16 @@
 #include "Call.hpp"
+#include "../Decl/Decl.hpp"
 
-Call::Call(const int lineNum, const std::string funcName) : Exp::Exp(lineNum, new Data(Data::Type::Undefined, false, false)), m_name(funcName) {}
+Call::Call(const int lineNum, const Intern::Handle funcName) : Exp::Exp(Node::Kind::Call, lineNum, Data::get(Data::Type::Undefined, false, false)), m_name(funcName), m_decl(NodePool::None) {}
+
+void Call::setDecl(const Decl *decl)
+{
+    m_decl = (decl != nullptr) ? decl->getIndex() : NodePool::None;
+}
 
 std::string Call::stringify() const
 {
-    return "Call: " + m_name;
+    return "Call: " + getName();
 }
 
 unsigned Call::getParmCount() const
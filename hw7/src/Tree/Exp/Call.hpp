@@ -1,21 +1,29 @@
 #pragma once
 
 #include "Exp.hpp"
+#include "../../Intern/Intern.hpp"
+
+class Decl;
 
 class Call : public Exp
 {
     public:
-        Call(const int lineNum, const std::string funcName);
+        Call(const int lineNum, const Intern::Handle funcName);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Call; }
         std::string stringify() const override;
 
         // Getters
-        std::string getName() const { return m_name; }
+        const std::string & getName() const { return Intern::string(m_name); }
+        Intern::Handle getNameHandle() const { return m_name; }
         unsigned getParmCount() const;
         std::vector<Node *> getParms() const;
+        Decl * getDecl() const { return (Decl *)at(m_decl); }      // What the name resolved to, nullptr if it is not declared
+
+        // Setters
+        void setDecl(const Decl *decl);
 
     private:
-        const std::string m_name;
+        const Intern::Handle m_name;
+        Index m_decl;
 };
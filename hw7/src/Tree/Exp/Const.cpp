@@ -1,41 +1,79 @@
 #include "Const.hpp"
 
-Const::Const(const int lineNum, const Const::Type type, const std::string constValue) : Exp::Exp(lineNum, new Data(Data::Type::Undefined, false, false)), m_type(type)
+#include <type_traits>
+
+static_assert(std::is_trivially_destructible<Const>::value, "Const must be trivially destructible");
+
+Const::Const(const int lineNum, const Const::Type type, const std::string_view constValue) : Exp::Exp(Node::Kind::Const, lineNum, Data::get(Data::Type::Undefined, false, false)), m_type(type)
 {
     switch (m_type)
     {
         case Const::Type::Int:
-            m_intValue = std::stoi(constValue);
-            m_data->setType(Data::Type::Int);
+            m_intValue = std::stoi(std::string(constValue));
+            m_data = m_data->withType(Data::Type::Int);
             break;
         case Const::Type::Bool:
             m_boolValue = (constValue == "true");
-            m_data->setType(Data::Type::Bool);
+            m_data = m_data->withType(Data::Type::Bool);
             break;
         case Const::Type::Char:
         {
-            std::string chars = removeFirstAndLastChar(constValue);
+            std::string chars = removeFirstAndLastChar(std::string(constValue));
             m_charValue = parseFirstChar(chars);
             if (chars.length() > 1 && chars[0] != '\\')
             {
                 m_longConstValue = constValue;
                 m_charLengthWarning = true;
             }
-            m_data->setType(Data::Type::Char);
+            m_data = m_data->withType(Data::Type::Char);
             break;
         }
         case Const::Type::String:
+        {
+            // Only a string with escapes needs its own copy
             setMemExists(true);
-            m_stringValue = parseChars(removeFirstAndLastChar(constValue));
-            m_data->setType(Data::Type::Char);
-            m_data->setIsArray(true);
+            std::string_view chars = constValue.substr(1, constValue.length() - 2);
+            if (chars.find('\\') == std::string_view::npos)
+            {
+                m_stringValue = chars;
+            }
+            else
+            {
+                std::string parsedChars = parseChars(std::string(chars));
+                m_stringValue = std::string_view(Arena::unit().copy(parsedChars), parsedChars.size());
+            }
+            m_data = m_data->withType(Data::Type::Char);
+            m_data = m_data->withIsArray(true);
             break;
+        }
         default:
             throw std::runtime_error("Const::Const() - Unknown type");
             break;
     }
 }
 
+Const::Const(const int lineNum, const Const::Type type, const int value) : Exp::Exp(Node::Kind::Const, lineNum, Data::get(Data::Type::Undefined, false, false)), m_type(type), m_intValue(0), m_boolValue(false), m_charValue('\0')
+{
+    switch (m_type)
+    {
+        case Const::Type::Int:
+            m_intValue = value;
+            m_data = m_data->withType(Data::Type::Int);
+            break;
+        case Const::Type::Bool:
+            m_boolValue = value != 0;
+            m_data = m_data->withType(Data::Type::Bool);
+            break;
+        case Const::Type::Char:
+            m_charValue = (char)value;
+            m_data = m_data->withType(Data::Type::Char);
+            break;
+        default:
+            throw std::runtime_error("Const::Const() - Only an int, bool or char has a value");
+            break;
+    }
+}
+
 std::string Const::stringify() const
 {
     std::string stringy = "Const ";
@@ -58,7 +96,7 @@ std::string Const::stringify() const
             stringy += "'" + std::string(1, m_charValue) + "'";
             break;
         case Const::Type::String:
-            stringy += "\"" + m_stringValue + "\"";
+            stringy += "\"" + getStringValue() + "\"";
             break;
     }
     return stringy;
@@ -117,19 +155,19 @@ std::string Const::removeFirstAndLastChar(const std::string &str)
 
 std::string Const::parseChars(const std::string &str) const
 {
-    std::string unparsedChars = str;
     std::string parsedChars;
-    while (unparsedChars.length() > 0)
+    size_t i = 0;
+    while (i < str.length())
     {
-        char currChar = unparsedChars[0];
-        parsedChars += parseFirstChar(unparsedChars);
-        if (currChar == '\\' && unparsedChars.length() >= 2)
+        char currChar = str[i];
+        parsedChars += parseFirstChar(str.substr(i, 2));
+        if (currChar == '\\' && str.length() - i >= 2)
         {
-            unparsedChars = unparsedChars.substr(2);
+            i += 2;
         }
         else
         {
-            unparsedChars = unparsedChars.substr(1);
+            i++;
         }
     }
     return parsedChars;
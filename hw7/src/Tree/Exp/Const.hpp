@@ -7,24 +7,24 @@ class Const : public Exp
     public:
         enum class Type { Int, Bool, Char, String };
 
-        Const(const int lineNum, const Const::Type type, const std::string value);
+        Const(const int lineNum, const Const::Type type, const std::string_view value);
+        Const(const int lineNum, const Const::Type type, const int value);      // An int, bool or char worked out by the compiler
 
         // Static
         static std::string removeFirstAndLastChar(const std::string &str);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Const; }
         std::string stringify() const override;
         std::string stringifyWithType() const override;
 
         // Getters
         Const::Type getType() const { return m_type; }
         bool getCharLengthWarning() const { return m_charLengthWarning; }
-        std::string getLongConstValue() const { return m_longConstValue; }
+        std::string getLongConstValue() const { return std::string(m_longConstValue); }
         int getIntValue() const { return m_intValue; }
         bool getBoolValue() const { return m_boolValue; }
         char getCharValue() const { return m_charValue; }
-        std::string getStringValue() const { return m_stringValue; }
+        std::string getStringValue() const { return std::string(m_stringValue); }
 
     private:
         char parseFirstChar(const std::string &str) const;
@@ -35,6 +35,6 @@ class Const : public Exp
         int m_intValue;
         bool m_boolValue;
         char m_charValue;
-        std::string m_stringValue;
-        std::string m_longConstValue;
+        std::string_view m_stringValue;     // Both views point into the source or the arena
+        std::string_view m_longConstValue;
 };
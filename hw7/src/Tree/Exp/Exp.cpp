@@ -1,6 +1,6 @@
 #include "Exp.hpp"
 
-Exp::Exp(const int lineNum, Data *data) : Node::Node(lineNum), m_data(data) {}
+Exp::Exp(const Node::Kind kind, const int lineNum, const Data *data) : Node::Node(kind, lineNum), m_data(data) {}
 
 std::string Exp::stringifyWithType() const
 {
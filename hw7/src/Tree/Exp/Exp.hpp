@@ -6,17 +6,17 @@
 class Exp : public Node
 {
     public:
-        Exp(const int lineNum, Data *m_data);
+        Exp(const Node::Kind kind, const int lineNum, const Data *m_data);
 
         // Getters
-        Data * getData() const { return m_data; }
+        const Data * getData() const { return m_data; }
 
         // Setters
-        void setData(Data *data) { m_data = data; }
+        void setData(const Data *data) { m_data = data; }
     
         // Overridden
         std::string stringifyWithType() const override;
 
     protected:
-        Data *m_data;
+        const Data *m_data;
 };
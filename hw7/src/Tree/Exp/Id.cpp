@@ -1,13 +1,19 @@
 #include "Id.hpp"
+#include "../Decl/Decl.hpp"
 
-Id::Id(const int lineNum, const std::string isIdame) : Exp::Exp(lineNum, new Data(Data::Type::Undefined, false, false)), m_name(isIdame), m_isGlobal(false)
+Id::Id(const int lineNum, const Intern::Handle isIdame) : Exp::Exp(Node::Kind::Id, lineNum, Data::get(Data::Type::Undefined, false, false)), m_name(isIdame), m_decl(NodePool::None), m_isGlobal(false)
 {
     setMemExists(true);
 }
 
+void Id::setDecl(const Decl *decl)
+{
+    m_decl = (decl != nullptr) ? decl->getIndex() : NodePool::None;
+}
+
 std::string Id::stringify() const
 {
-    return "Id: " + m_name;
+    return "Id: " + getName();
 }
 
 std::string Id::stringifyWithType() const
@@ -17,7 +23,7 @@ std::string Id::stringifyWithType() const
         throw std::runtime_error("Id::stringifyWithType() - Data must exist");
     }
 
-    std::string stringWithType = "Id: " + m_name + " of ";
+    std::string stringWithType = "Id: " + getName() + " of ";
     if (m_data->getIsStatic() && m_data->getIsArray())
     {
         stringWithType += "static array of ";
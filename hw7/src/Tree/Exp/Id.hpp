@@ -1,25 +1,31 @@
 #pragma once
 
 #include "Exp.hpp"
+#include "../../Intern/Intern.hpp"
+
+class Decl;
 
 class Id : public Exp
 {
     public:
-        Id(const int lineNum, const std::string isIdame);
+        Id(const int lineNum, const Intern::Handle isIdame);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Id; }
         std::string stringify() const override;
         std::string stringifyWithType() const override;
 
         // Getters
-        std::string getName() const { return m_name; }
+        const std::string & getName() const { return Intern::string(m_name); }
+        Intern::Handle getNameHandle() const { return m_name; }
         bool getIsGlobal() const { return m_isGlobal; }
+        Decl * getDecl() const { return (Decl *)at(m_decl); }      // What the name resolved to, nullptr if it is not declared
 
         // Setters
         void setIsGlobal(bool isGlobal) { m_isGlobal = isGlobal; }
+        void setDecl(const Decl *decl);
 
     private:
-        const std::string m_name;
+        const Intern::Handle m_name;
+        Index m_decl;
         bool m_isGlobal;
 };
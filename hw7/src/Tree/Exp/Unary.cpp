@@ -1,16 +1,16 @@
 #include "Unary.hpp"
 
-Unary::Unary(const int lineNum, const Unary::Type type) : Exp::Exp(lineNum, new Data(Data::Type::Undefined, false, false)), m_type(type)
+Unary::Unary(const int lineNum, const Unary::Type type) : Exp::Exp(Node::Kind::Unary, lineNum, Data::get(Data::Type::Undefined, false, false)), m_type(type)
 {
     switch (m_type)
     {
         case Unary::Type::Chsign:
         case Unary::Type::Sizeof:
         case Unary::Type::Question:
-            m_data->setType(Data::Type::Int);
+            m_data = m_data->withType(Data::Type::Int);
             break;
         case Unary::Type::Not:
-            m_data->setType(Data::Type::Bool);
+            m_data = m_data->withType(Data::Type::Bool);
             break;
         default:
             throw std::runtime_error("Unary::Unary() - Unknown type");
@@ -10,7 +10,6 @@ class Unary : public Exp
         Unary(const int lineNum, const Unary::Type type);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Unary; }
         std::string stringify() const override;
 
         // Getters
@@ -1,6 +1,6 @@
 #include "UnaryAsgn.hpp"
 
-UnaryAsgn::UnaryAsgn(const int lineNum, const UnaryAsgn::Type type) : Exp::Exp(lineNum, new Data(Data::Type::Int, false, false)), m_type(type) {}
+UnaryAsgn::UnaryAsgn(const int lineNum, const UnaryAsgn::Type type) : Exp::Exp(Node::Kind::UnaryAsgn, lineNum, Data::get(Data::Type::Int, false, false)), m_type(type) {}
 
 std::string UnaryAsgn::stringify() const
 {
@@ -10,7 +10,6 @@ class UnaryAsgn : public Exp
         UnaryAsgn(const int lineNum, const UnaryAsgn::Type type);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::UnaryAsgn; }
         std::string stringify() const override;
 
         // Getters
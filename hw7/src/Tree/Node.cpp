@@ -1,97 +1,104 @@
 #include "Node.hpp"
+#include "Traverse.hpp"
+#include "Exp/Asgn.hpp"
+#include "Exp/Binary.hpp"
+#include "Exp/Unary.hpp"
 
-Node::Node(const int lineNum) : m_parent(nullptr), m_sibling(nullptr), m_siblingCount(1), m_lineNum(lineNum), m_isAnalyzed(false), m_memExists(false), m_memScope("None"), m_memLoc(0), m_memSize(1), m_memIsUpdated(false), m_isGenerated(false) {}
+#include <type_traits>
 
-Node::~Node()
+// The arena releases nodes without running destructors
+static_assert(std::is_trivially_destructible<Node>::value, "Node must be trivially destructible");
+
+Node::Node(const Node::Kind kind, const int lineNum) : m_index(NodePool::unit().add(this, (uint8_t)kind, lineNum)), m_parent(NodePool::None), m_sibling(NodePool::None), m_lastSibling(NodePool::None), m_siblingCount(1), m_context(), m_isAnalyzed(false), m_isConstant(false), m_isGenerated(false), m_memExists(false), m_memIsUpdated(false) {}
+
+std::string Node::memScopeToString(const MemScope memScope)
 {
-    if (m_sibling != nullptr)
-    {
-        delete m_sibling;
-    }
-    for (auto &node : m_children)
+    switch (memScope)
     {
-        delete node;
+        case MemScope::Global:
+            return "Global";
+        case MemScope::Local:
+            return "Local";
+        case MemScope::LocalStatic:
+            return "LocalStatic";
+        case MemScope::Parameter:
+            return "Parameter";
+        default:
+            return "None";
     }
 }
 
 Node * Node::getChild(const unsigned index) const
 {
-    if (index > m_children.size() - 1 || m_children.size() == 0)
+    if (index >= getChildCount())
     {
         return nullptr;
     }
-    return m_children[index];
-}
-
-unsigned Node::getChildCount() const
-{
-    return m_children.size();
+    return at(pool().getChild(m_index, index));
 }
 
 Node * Node::getRelative(const Node::Kind nodeKind) const
 {
-    if (m_parent == nullptr)
+    switch (nodeKind)
     {
-        return nullptr;
+        case Node::Kind::Func:
+            return at(m_context.func);
+        case Node::Kind::For:
+            return at(m_context.forLoop);
+        case Node::Kind::While:
+            return at(m_context.whileLoop);
+        case Node::Kind::Compound:
+            return at(m_context.compound);
+        case Node::Kind::Asgn:
+            return at(m_context.asgn);
     }
-    if (m_parent->getNodeKind() == nodeKind)
+
+    // No link is kept for the other kinds
+    Node *parent = getParent();
+    while (parent != nullptr)
     {
-        return m_parent;
+        if (parent->getNodeKind() == nodeKind)
+        {
+            return parent;
+        }
+        parent = parent->getParent();
     }
-    return m_parent->getRelative(nodeKind);
+    return nullptr;
 }
 
 std::string Node::getMemStr() const
 {
     std::stringstream msg;
-    msg << "[mem: " << m_memScope << " loc: " << m_memLoc << " size: " << m_memSize << "]";
+    msg << "[mem: " << memScopeToString(getMemScope()) << " loc: " << getMemLoc() << " size: " << getMemSize() << "]";
     return msg.str();
 }
 
 void Node::printTree(const bool showTypes, const bool showMem) const
 {
-    static unsigned siblingCount = 0, tabCount = 0;
-
-    printNode(showTypes);
-    if (showMem && m_memExists)
+    traverse(const_cast<Node *>(this), [this, showTypes, showMem](Node *node, const TraversePosition &position)
     {
-        std::cout << " " << getMemStr() << " [line: " << m_lineNum << "]" << std::endl;
-    }
-    else
-    {
-        std::cout << " [line: " << m_lineNum << "]" << std::endl;
-    }
-
-    tabCount++;
-
-    // Print the children
-    for (int i = 0; i < m_children.size(); i++)
-    {
-        Node *child = m_children[i];
-        if (child != nullptr)
+        if (position.siblingIndex > 0)
         {
-            printTabs(tabCount);
-            std::cout << "Child: " << i << "  ";
-
-            int tmp = siblingCount;
-            siblingCount = 0;
-            child->printTree(showTypes, showMem);
-            siblingCount = tmp;
+            printTabs(position.depth);
+            std::cout << "Sibling: " + std::to_string(position.siblingIndex) << "  ";
+        }
+        else if (position.depth > 0)
+        {
+            printTabs(position.depth);
+            std::cout << "Child: " << position.childIndex << "  ";
         }
-    }
-
-    tabCount--;
-    siblingCount++;
-
-    // Print the siblings
-    if (m_sibling != nullptr)
-    {
-        printTabs(tabCount);
-        std::cout << "Sibling: " + std::to_string(siblingCount) << "  ";
-        m_sibling->printTree(showTypes, showMem);
-    }
 
-    siblingCount--;
+        node->printNode(showTypes);
+        if (showMem && node->m_memExists)
+        {
+            std::cout << " " << node->getMemStr() << " [line: " << node->getLineNum() << "]" << std::endl;
+        }
+        else
+        {
+            std::cout << " [line: " << node->getLineNum() << "]" << std::endl;
+        }
+        return true;
+    });
 }
 
 void Node::printNode(const bool showTypes) const
@@ -108,76 +115,144 @@ void Node::printNode(const bool showTypes) const
 
 void Node::printNodeInfo() const
 {
-    std::cout << "Node: " << m_lineNum << " " << stringifyWithType() << std::endl;
+    std::cout << "Node: " << getLineNum() << " " << stringifyWithType() << std::endl;
 
-    if (m_parent != nullptr)
+    Node *parent = getParent();
+    if (parent != nullptr)
     {
-        std::cout << "Parent: " << m_parent->getLineNum() << " " << m_parent->stringifyWithType() << std::endl;
+        std::cout << "Parent: " << parent->getLineNum() << " " << parent->stringifyWithType() << std::endl;
 
-        std::vector<Node *> parentChildren = m_parent->getChildren();
-        for (int i = 0; i < parentChildren.size(); i++)
+        for (int i = 0; i < parent->getChildCount(); i++)
         {
-            std::cout << "Parent Child " << i << ": " << parentChildren[i]->getLineNum() << " " << parentChildren[i]->stringifyWithType() << std::endl;
+            Node *child = parent->getChild(i);
+            std::cout << "Parent Child " << i << ": " << child->getLineNum() << " " << child->stringifyWithType() << std::endl;
         }
-        std::cout << "Parent Total children: " << parentChildren.size() << std::endl;
+        std::cout << "Parent Total children: " << parent->getChildCount() << std::endl;
     }
 
-    if (m_sibling != nullptr)
+    Node *sibling = getSibling();
+    if (sibling != nullptr)
     {
-        std::cout << "Sibling: " << m_sibling->getLineNum() << " " << m_sibling->stringifyWithType() << std::endl;
+        std::cout << "Sibling: " << sibling->getLineNum() << " " << sibling->stringifyWithType() << std::endl;
     }
 
-    for (int i = 0; i < m_children.size(); i++)
+    for (int i = 0; i < getChildCount(); i++)
     {
-        std::cout << "Child " << i << ": " << m_children[i]->getLineNum() << " " << m_children[i]->stringifyWithType() << std::endl;
+        Node *child = getChild(i);
+        std::cout << "Child " << i << ": " << child->getLineNum() << " " << child->stringifyWithType() << std::endl;
     }
-    std::cout << "Total children: " << m_children.size() << std::endl;
+    std::cout << "Total children: " << getChildCount() << std::endl;
 }
 
 void Node::addChild(Node *node)
 {
-    m_children.push_back(node);
     if (node == nullptr)
     {
+        pool().addChild(m_index, NodePool::None);
         return;
     }
-    node->m_parent = this;
+    pool().addChild(m_index, node->m_index);
+    node->m_parent = m_index;
     node->setSiblingParents(this);
 }
 
-void Node::addSibling(Node *node)
+void Node::removeChild(const unsigned index)
 {
-    if (this == nullptr)
+    if (index >= getChildCount())
     {
-        return;
+        throw std::runtime_error("Node::removeChild() - Invalid index");
     }
-    if (node == nullptr)
+    pool().setChild(m_index, index, NodePool::None);
+}
+
+Node::Index Node::detachSibling()
+{
+    Index sibling = m_sibling;
+    m_sibling = NodePool::None;
+    return sibling;
+}
+
+void Node::attachSibling(const Index sibling)
+{
+    if (m_sibling != NodePool::None)
     {
-        return;
+        throw std::runtime_error("Node::attachSibling() - Sibling already attached");
     }
-    node->setSiblingParents(this);
-    if (m_sibling == nullptr)
+    m_sibling = sibling;
+}
+
+void Node::replaceWith(Node *node)
+{
+    Node *parent = getParent();
+    if (parent == nullptr || node == nullptr || node->m_sibling != NodePool::None)
     {
-        m_sibling = node;
+        throw std::runtime_error("Node::replaceWith() - Only a lone node can replace one with a parent");
     }
-    else
+
+    node->m_parent = m_parent;
+    node->m_sibling = m_sibling;
+    node->m_context = m_context;
+    for (unsigned i = 0; i < parent->getChildCount(); i++)
     {
-        m_sibling->addSibling(node);
+        Node *sibling = parent->getChild(i);
+        if (sibling == this)
+        {
+            // The first of a list keeps its length and last sibling
+            pool().setChild(parent->m_index, i, node->m_index);
+            node->m_siblingCount = m_siblingCount;
+            node->m_lastSibling = (m_lastSibling == m_index) ? node->m_index : m_lastSibling;
+            return;
+        }
+        while (sibling != nullptr && sibling->m_sibling != m_index)
+        {
+            sibling = sibling->getSibling();
+        }
+        if (sibling != nullptr)
+        {
+            sibling->m_sibling = node->m_index;
+            Node *first = parent->getChild(i);
+            if (first->m_lastSibling == m_index)
+            {
+                first->m_lastSibling = node->m_index;
+            }
+            return;
+        }
     }
-    m_siblingCount++;
+    throw std::runtime_error("Node::replaceWith() - Node is not among its parent's children");
 }
 
-bool Node::hasRelative(const Node *node) const
+void Node::addSibling(Node *node)
 {
-    if (this == node)
+    if (this == nullptr)
     {
-        return true;
+        return;
     }
-    if (m_parent == nullptr)
+    if (node == nullptr)
     {
-        return false;
+        return;
     }
-    return m_parent->hasRelative(node);
+
+    // Appended siblings take the previous last sibling as their parent until addChild() adopts the list
+    Node *lastSibling = getLastSibling();
+    Node *nodeLastSibling = node->getLastSibling();
+    node->setSiblingParents(lastSibling);
+    lastSibling->m_sibling = node->m_index;
+    m_lastSibling = nodeLastSibling->m_index;
+    m_siblingCount += node->m_siblingCount;
+}
+
+bool Node::hasRelative(const Node *node) const
+{
+    const Node *parent = this;
+    while (parent != nullptr)
+    {
+        if (parent == node)
+        {
+            return true;
+        }
+        parent = parent->getParent();
+    }
+    return false;
 }
 
 bool Node::hasRelative(const Node::Kind nodeKind) const
@@ -185,14 +260,76 @@ bool Node::hasRelative(const Node::Kind nodeKind) const
     return (getRelative(nodeKind) != nullptr);
 }
 
+// The attributes the checks ask about, evaluated once per node in one walk.
+// A node's context is inherited, its parent's plus the parent itself, and
+// parents are reached first. Whether it is constant is synthesized from its
+// children, which are finished before it.
+void Node::evaluateAttributes(Node *root)
+{
+    traverse(root, [](Node *node)
+    {
+        Node *parent = node->getParent();
+        if (parent == nullptr)
+        {
+            node->m_context = Context();
+            return true;
+        }
+
+        node->m_context = parent->m_context;
+        switch (parent->getNodeKind())
+        {
+            case Node::Kind::Func:
+                node->m_context.func = parent->m_index;
+                break;
+            case Node::Kind::For:
+                node->m_context.forLoop = parent->m_index;
+                break;
+            case Node::Kind::While:
+                node->m_context.whileLoop = parent->m_index;
+                break;
+            case Node::Kind::Compound:
+                node->m_context.compound = parent->m_index;
+                break;
+            case Node::Kind::Asgn:
+                node->m_context.asgn = parent->m_index;
+                if (((Asgn *)parent)->getType() == Asgn::Type::Asgn && parent->getChild() == node)
+                {
+                    node->m_context.inAsgnTarget = true;
+                }
+                break;
+            case Node::Kind::Binary:
+                if (((Binary *)parent)->getType() == Binary::Type::Index && parent->getChild(1) == node)
+                {
+                    node->m_context.inIndexValue = true;
+                }
+                break;
+        }
+        return true;
+    },
+    [](Node *node)
+    {
+        bool isConstant = node->getNodeKind() != Node::Kind::Id && node->getNodeKind() != Node::Kind::Call;
+        if (node->getNodeKind() == Node::Kind::Unary && ((Unary *)node)->getType() == Unary::Type::Question)
+        {
+            isConstant = false;
+        }
+        for (unsigned i = 0; i < node->getChildCount() && isConstant; i++)
+        {
+            Node *child = node->getChild(i);
+            isConstant = child == nullptr || child->m_isConstant;
+        }
+        node->m_isConstant = isConstant;
+    });
+}
+
 bool Node::parentExists() const
 {
-    return (m_parent != nullptr);
+    return (m_parent != NodePool::None);
 }
 
 std::string Node::stringify() const
 {
-    return " [line: " + std::to_string(m_lineNum) + "]";
+    return " [line: " + std::to_string(getLineNum()) + "]";
 }
 
 void Node::setSiblingParents(Node *node)
@@ -201,11 +338,24 @@ void Node::setSiblingParents(Node *node)
     {
         return;
     }
-    m_parent = node;
-    if (m_sibling != nullptr)
+    Node *currSibling = this;
+    while (currSibling != nullptr)
+    {
+        currSibling->m_parent = node->m_index;
+        currSibling = currSibling->getSibling();
+    }
+}
+
+Node * Node::getLastSibling()
+{
+    // The cached last sibling can only be behind if a list was appended through one of its middle nodes
+    Node *lastSibling = (m_lastSibling != NodePool::None) ? at(m_lastSibling) : this;
+    while (lastSibling->m_sibling != NodePool::None)
     {
-        m_sibling->setSiblingParents(node);
+        lastSibling = at(lastSibling->m_sibling);
     }
+    m_lastSibling = lastSibling->m_index;
+    return lastSibling;
 }
 
 void Node::printTabs(const unsigned tabCount) const
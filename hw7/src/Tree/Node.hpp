@@ -1,5 +1,9 @@
 #pragma once
 
+#include "NodePool.hpp"
+#include "../Arena/Arena.hpp"
+#include "../Intern/Intern.hpp"
+
 #include <iostream>
 #include <vector>
 #include <sstream>
@@ -8,35 +12,47 @@ class Node
 {
     public:
         enum class Kind { Func, Parm, Var, Asgn, Binary, Call, Const, Id, Unary, UnaryAsgn, Break, Compound, For, If, Range, Return, While };
+        enum class MemScope : unsigned char { None, Global, Local, LocalStatic, Parameter };
+        typedef NodePool::Index Index;
+
+        Node(const Node::Kind kind, const int lineNum);
+
+        // Nodes live in the compilation unit's arena and are released with it
+        static void * operator new(size_t size) { return Arena::unit().allocate(size); }
+        static void operator delete(void *ptr) {}
 
-        Node(const int lineNum);
-        ~Node();
+        // Static
+        static std::string memScopeToString(const MemScope memScope);
 
         // Getters
-        int getLineNum() const { return m_lineNum; }
+        Index getIndex() const { return m_index; }
+        Node::Kind getNodeKind() const { return (Node::Kind)pool().getKind(m_index); }
+        int getLineNum() const { return pool().getLineNum(m_index); }
         bool getIsAnalyzed() const { return m_isAnalyzed; }
         bool getIsGenerated() const { return m_isGenerated; }
-        Node * getParent() const { return m_parent; }
-        Node * getSibling() const { return m_sibling; }
+        Node * getParent() const { return at(m_parent); }
+        Node * getSibling() const { return at(m_sibling); }
         unsigned getSiblingCount() const { return m_siblingCount; }
-        std::vector<Node *> getChildren() const { return m_children; }
         bool getMemExists() const { return m_memExists; }
-        std::string getMemScope() const { return m_memScope; }
-        int getMemLoc() const { return m_memLoc; }
-        int getMemSize() const { return m_memSize; }
+        MemScope getMemScope() const { return (MemScope)pool().getMemScope(m_index); }
+        int getMemLoc() const { return pool().getMemLoc(m_index); }
+        int getMemSize() const { return pool().getMemSize(m_index); }
         bool getMemIsUpdated() const { return m_memIsUpdated; }
         Node * getChild(const unsigned index=0) const;
-        unsigned getChildCount() const;
+        unsigned getChildCount() const { return pool().getChildCount(m_index); }
         Node * getRelative(const Node::Kind nodeKind) const;
+        bool getIsInIndexValue() const { return m_context.inIndexValue; }
+        bool getIsInAsgnTarget() const { return m_context.inAsgnTarget; }
+        bool getIsConstant() const { return m_isConstant; }            // Nothing at or below it reads a variable, calls or rolls a '?'
         std::string getMemStr() const;
 
         // Setters
         void makeAnalyzed() { m_isAnalyzed = true; }
         void makeGenerated() { m_isGenerated = true; }
         void setMemExists(const bool memExists) { m_memExists = memExists; }
-        void setMemScope(const std::string scope) { m_memScope = scope; }
-        void setMemLoc(const int loc) { m_memLoc = loc; }
-        void setMemSize(const int size) { m_memSize = size; }
+        void setMemScope(const MemScope memScope) { pool().setMemScope(m_index, (uint8_t)memScope); }
+        void setMemLoc(const int loc) { pool().setMemLoc(m_index, loc); }
+        void setMemSize(const int size) { pool().setMemSize(m_index, size); }
         void setMemIsUpdated(const bool memIsUpdated) { m_memIsUpdated = memIsUpdated; }
 
         // Print
@@ -47,41 +63,62 @@ class Node
         // Helpers
         void addChild(Node *node);
         void addSibling(Node *node);
+        void removeChild(const unsigned index);     // The slot is kept but reads as no child
+        Index detachSibling();                      // Ends the sibling list here, returning what followed for attachSibling()
+        void attachSibling(const Index sibling);
+        void replaceWith(Node *node);               // A lone node takes this one's place, this one keeps its links to walk on from
         bool hasRelative(const Node *node) const;
         bool hasRelative(const Node::Kind nodeKind) const;
         bool parentExists() const;
+        static void evaluateAttributes(Node *root);
 
         // Virtual
         virtual std::string stringify() const;
         virtual std::string stringifyWithType() const { return stringify(); }
-        virtual Node::Kind getNodeKind() const = 0;
 
     protected:
-        Node *m_sibling;
+        // Static
+        static Node * at(const Index index) { return NodePool::unit().get(index); }
+        static NodePool & pool() { return NodePool::unit(); }
 
     private:
+        // Nearest enclosing nodes along the parent chain, inherited in evaluateAttributes()
+        struct Context
+        {
+            Index func;
+            Index forLoop;
+            Index whileLoop;
+            Index compound;
+            Index asgn;
+            bool inIndexValue : 1;      // Below the value side of an array index
+            bool inAsgnTarget : 1;      // Below the left side of a plain assignment
+        };
+
         // Setters
         void setSiblingParents(Node *node);
 
+        // Helpers
+        Node * getLastSibling();
+
         // Print
         void printTabs(const unsigned tabCount) const;
 
-        // Tree
-        Node *m_parent;
-        std::vector<Node *> m_children;
+        // Tree, every link is an index into the unit's NodePool, which also holds the kind, line, memory and children
+        Index m_index;
+        Index m_parent;
+        Index m_sibling;
+        Index m_lastSibling;
         unsigned m_siblingCount;
+        Context m_context;
 
         // Analysis
-        const int m_lineNum;
-        bool m_isAnalyzed;
-
-        // Memory
-        bool m_memExists;
-        std::string m_memScope;
-        int m_memLoc;
-        int m_memSize;
-        bool m_memIsUpdated;
+        bool m_isAnalyzed : 1;
+        bool m_isConstant : 1;          // Synthesized in evaluateAttributes()
 
         // Generation
-        bool m_isGenerated;
+        bool m_isGenerated : 1;
+
+        // Memory
+        bool m_memExists : 1;
+        bool m_memIsUpdated : 1;
 };
@@ -0,0 +1,148 @@
+#include "NodePool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+NodePool::NodePool()
+{
+    release();
+}
+
+NodePool & NodePool::fallback()
+{
+    static thread_local NodePool fallback;
+    return fallback;
+}
+
+NodePool * NodePool::setUnit(NodePool *pool)
+{
+    NodePool *previous = s_unit;
+    s_unit = pool;
+    return previous;
+}
+
+size_t NodePool::getByteCount() const
+{
+    size_t bytes = m_nodes.capacity() * sizeof(Node *) + m_kinds.capacity() + m_lineNums.capacity() * sizeof(int) + m_memScopes.capacity();
+    bytes += (m_memLocs.capacity() + m_memSizes.capacity()) * sizeof(int) + m_childCounts.capacity();
+    bytes += (m_firstChildren.capacity() + m_children.capacity() + m_free.capacity()) * sizeof(Index);
+    for (const std::vector<Index> &runs : m_freeChildren)
+    {
+        bytes += runs.capacity() * sizeof(Index);
+    }
+    return bytes;
+}
+
+NodePool::Index NodePool::add(Node *node, const uint8_t kind, const int lineNum)
+{
+    if (!m_free.empty())
+    {
+        Index index = m_free.back();
+        m_free.pop_back();
+        m_nodes[index] = node;
+        m_kinds[index] = kind;
+        m_lineNums[index] = lineNum;
+        m_memScopes[index] = 0;
+        m_memLocs[index] = 0;
+        m_memSizes[index] = 1;
+        m_firstChildren[index] = 0;
+        m_childCounts[index] = 0;
+        return index;
+    }
+
+    if (m_nodes.size() > UINT32_MAX)
+    {
+        throw std::runtime_error("NodePool::add() - Too many nodes");
+    }
+    m_nodes.push_back(node);
+    m_kinds.push_back(kind);
+    m_lineNums.push_back(lineNum);
+    m_memScopes.push_back(0);
+    m_memLocs.push_back(0);
+    m_memSizes.push_back(1);
+    m_firstChildren.push_back(0);
+    m_childCounts.push_back(0);
+    return (Index)(m_nodes.size() - 1);
+}
+
+void NodePool::addChild(const Index index, const Index child)
+{
+    unsigned count = m_childCounts[index];
+    if (count == s_maxChildren)
+    {
+        throw std::runtime_error("NodePool::addChild() - Too many children");
+    }
+
+    Index first = m_firstChildren[index];
+    if (count > 0 && first + count == m_children.size())
+    {
+        m_children.push_back(child);
+    }
+    else
+    {
+        Index moved = allocateChildren(count + 1);
+        std::copy(m_children.begin() + first, m_children.begin() + first + count, m_children.begin() + moved);
+        m_children[moved + count] = child;
+        freeChildren(first, count);
+        m_firstChildren[index] = moved;
+    }
+    m_childCounts[index]++;
+}
+
+void NodePool::free(const Index index)
+{
+    if (index == None || index >= m_nodes.size())
+    {
+        throw std::runtime_error("NodePool::free() - Invalid index");
+    }
+    m_nodes[index] = nullptr;
+    freeChildren(m_firstChildren[index], m_childCounts[index]);
+    m_firstChildren[index] = 0;
+    m_childCounts[index] = 0;
+    m_free.push_back(index);
+}
+
+void NodePool::release()
+{
+    // Index 0 is no node, it has no children
+    std::vector<Node *>(1, nullptr).swap(m_nodes);
+    std::vector<uint8_t>(1, 0).swap(m_kinds);
+    std::vector<int>(1, 0).swap(m_lineNums);
+    std::vector<uint8_t>(1, 0).swap(m_memScopes);
+    std::vector<int>(1, 0).swap(m_memLocs);
+    std::vector<int>(1, 0).swap(m_memSizes);
+    std::vector<Index>(1, 0).swap(m_firstChildren);
+    std::vector<uint8_t>(1, 0).swap(m_childCounts);
+    std::vector<Index>().swap(m_children);
+    std::vector<Index>().swap(m_free);
+    for (std::vector<Index> &runs : m_freeChildren)
+    {
+        std::vector<Index>().swap(runs);
+    }
+}
+
+NodePool::Index NodePool::allocateChildren(const unsigned count)
+{
+    std::vector<Index> &runs = m_freeChildren[count];
+    if (!runs.empty())
+    {
+        Index first = runs.back();
+        runs.pop_back();
+        return first;
+    }
+
+    if (m_children.size() + count > UINT32_MAX)
+    {
+        throw std::runtime_error("NodePool::allocateChildren() - Too many children");
+    }
+    m_children.resize(m_children.size() + count, None);
+    return (Index)(m_children.size() - count);
+}
+
+void NodePool::freeChildren(const Index first, const unsigned count)
+{
+    if (count > 0)
+    {
+        m_freeChildren[count].push_back(first);
+    }
+}
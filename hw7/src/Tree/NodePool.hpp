@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Node;
+
+// Numbers every node of the compilation unit. Tree links are stored as these
+// 32-bit indices instead of pointers, index 0 standing for no node. Indices
+// of freed nodes are handed out again, so a pool that frees each function
+// once it is compiled only grows to the largest one.
+//
+// The fields the passes read on every node, its kind, line, memory scope,
+// location and size and its children, are kept here in parallel arrays
+// indexed by the node rather than in the node itself. A node's children are
+// a run of indices in one shared array, given by its first and its count.
+// Children are added as the node is reduced, so its run is at the end of the
+// array and grows in place; a run elsewhere is moved there. The runs of
+// freed nodes are kept by length and handed out again.
+class NodePool
+{
+    public:
+        typedef uint32_t Index;
+        inline static const Index None = 0;
+        inline static const unsigned s_maxChildren = 3;
+
+        NodePool();
+        NodePool(const NodePool &) = delete;
+        NodePool & operator=(const NodePool &) = delete;
+
+        // Static
+        static NodePool & unit() { return (s_unit != nullptr) ? *s_unit : fallback(); }     // The pool of the compilation unit being compiled on this thread, read on every node access
+        static NodePool * setUnit(NodePool *pool);   // Returns the unit it replaces, nullptr restores this thread's default
+
+        // Getters
+        Node * get(const Index index) const { return m_nodes[index]; }
+        uint8_t getKind(const Index index) const { return m_kinds[index]; }
+        int getLineNum(const Index index) const { return m_lineNums[index]; }
+        uint8_t getMemScope(const Index index) const { return m_memScopes[index]; }
+        int getMemLoc(const Index index) const { return m_memLocs[index]; }
+        int getMemSize(const Index index) const { return m_memSizes[index]; }
+        unsigned getChildCount(const Index index) const { return m_childCounts[index]; }
+        Index getChild(const Index index, const unsigned child) const { return m_children[m_firstChildren[index] + child]; }
+        size_t getCount() const { return m_nodes.size() - 1; }
+        size_t getByteCount() const;
+
+        // Setters
+        void setMemScope(const Index index, const uint8_t memScope) { m_memScopes[index] = memScope; }
+        void setMemLoc(const Index index, const int loc) { m_memLocs[index] = loc; }
+        void setMemSize(const Index index, const int size) { m_memSizes[index] = size; }
+        void setChild(const Index index, const unsigned child, const Index node) { m_children[m_firstChildren[index] + child] = node; }
+
+        // Helpers
+        Index add(Node *node, const uint8_t kind, const int lineNum);
+        void addChild(const Index index, const Index child);
+        void free(const Index index);               // The node is gone, nothing may link to it anymore
+        void release();
+
+    private:
+        std::vector<Node *> m_nodes;
+        std::vector<uint8_t> m_kinds;               // Node::Kind, which this header cannot see
+        std::vector<int> m_lineNums;
+        std::vector<uint8_t> m_memScopes;           // Node::MemScope
+        std::vector<int> m_memLocs;
+        std::vector<int> m_memSizes;
+        std::vector<Index> m_firstChildren;
+        std::vector<uint8_t> m_childCounts;
+        std::vector<Index> m_children;
+        std::vector<Index> m_free;
+        std::vector<Index> m_freeChildren[s_maxChildren + 1];      // Where the free runs of each length start
+
+        static NodePool & fallback();
+        Index allocateChildren(const unsigned count);
+        void freeChildren(const Index first, const unsigned count);
+        inline static thread_local NodePool *s_unit = nullptr;
+};
@@ -1,6 +1,6 @@
 #include "Break.hpp"
 
-Break::Break(const int lineNum) : Stmt::Stmt(lineNum) {}
+Break::Break(const int lineNum) : Stmt::Stmt(Node::Kind::Break, lineNum) {}
 
 std::string Break::stringify() const
 {
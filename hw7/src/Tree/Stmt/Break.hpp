@@ -8,6 +8,5 @@ class Break : public Stmt
         Break(const int lineNum);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Break; }
         std::string stringify() const override;
 };
@@ -1,6 +1,6 @@
 #include "Compound.hpp"
 
-Compound::Compound(const int lineNum) : Stmt::Stmt(lineNum)
+Compound::Compound(const int lineNum) : Stmt::Stmt(Node::Kind::Compound, lineNum)
 {
     setMemExists(true);
 }
@@ -9,7 +9,6 @@ class Compound : public Stmt
         Compound(const int lineNum);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Compound; }
         std::string stringify() const override;
 
         // Getters
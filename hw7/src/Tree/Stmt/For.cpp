@@ -1,6 +1,6 @@
 #include "For.hpp"
 
-For::For(const int lineNum) : Stmt::Stmt(lineNum)
+For::For(const int lineNum) : Stmt::Stmt(Node::Kind::For, lineNum)
 {
     setMemExists(true);
 }
@@ -8,7 +8,6 @@ class For : public Stmt
         For(const int lineNum);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::For; }
         std::string stringify() const override;
 
         // Getters
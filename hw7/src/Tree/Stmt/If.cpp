@@ -1,6 +1,6 @@
 #include "If.hpp"
 
-If::If(const int lineNum) : Stmt::Stmt(lineNum) {}
+If::If(const int lineNum) : Stmt::Stmt(Node::Kind::If, lineNum) {}
 
 std::string If::stringify() const
 {
@@ -8,6 +8,5 @@ class If : public Stmt
         If(const int lineNum);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::If; }
         std::string stringify() const override;
 };
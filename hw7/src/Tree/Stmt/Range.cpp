@@ -1,6 +1,6 @@
 #include "Range.hpp"
 
-Range::Range(const int lineNum) : Stmt::Stmt(lineNum) {}
+Range::Range(const int lineNum) : Stmt::Stmt(Node::Kind::Range, lineNum) {}
 
 std::string Range::stringify() const
 {
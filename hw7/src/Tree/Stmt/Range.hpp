@@ -8,6 +8,5 @@ class Range : public Stmt
         Range(const int lineNum);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Range; }
         std::string stringify() const override;
 };
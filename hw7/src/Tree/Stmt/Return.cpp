@@ -1,6 +1,6 @@
 #include "Return.hpp"
 
-Return::Return(const int lineNum) : Stmt::Stmt(lineNum) {}
+Return::Return(const int lineNum) : Stmt::Stmt(Node::Kind::Return, lineNum) {}
 
 std::string Return::stringify() const
 {
@@ -8,6 +8,5 @@ class Return : public Stmt
         Return(const int lineNum);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::Return; }
         std::string stringify() const override;
 };
@@ -1,3 +1,3 @@
 #include "Stmt.hpp"
 
-Stmt::Stmt(const int lineNum) : Node::Node(lineNum) {}
+Stmt::Stmt(const Node::Kind kind, const int lineNum) : Node::Node(kind, lineNum) {}
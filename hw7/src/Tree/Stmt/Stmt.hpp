@@ -5,5 +5,5 @@
 class Stmt : public Node
 {
     public:
-        Stmt(const int lineNum);
+        Stmt(const Node::Kind kind, const int lineNum);
 };
@@ -1,6 +1,6 @@
 #include "While.hpp"
 
-While::While(const int lineNum) : Stmt::Stmt(lineNum) {}
+While::While(const int lineNum) : Stmt::Stmt(Node::Kind::While, lineNum) {}
 
 std::string While::stringify() const
 {
@@ -8,6 +8,5 @@ class While : public Stmt
         While(const int lineNum);
 
         // Overridden
-        Node::Kind getNodeKind() const override { return Node::Kind::While; }
         std::string stringify() const override;
 };
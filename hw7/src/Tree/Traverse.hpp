@@ -0,0 +1,114 @@
+#pragma once
+
+#include "Node.hpp"
+
+#include <type_traits>
+#include <vector>
+
+// Where a node was reached during a traversal
+struct TraversePosition
+{
+    unsigned depth;         // Number of enclosing parents, 0 for the starting sibling list
+    unsigned childIndex;    // Which child of its parent began this sibling list
+    unsigned siblingIndex;  // Place in its sibling list, 0 for the first
+};
+
+struct TraverseFrame
+{
+    Node *node;
+    unsigned nextChild;
+    TraversePosition position;
+};
+
+// Every traversal on a thread shares one work stack, nested traversals push
+// above the frames of the one that started them, so walking the tree does
+// not allocate
+inline std::vector<TraverseFrame> & traverseStack()
+{
+    static thread_local std::vector<TraverseFrame> stack;
+    return stack;
+}
+
+//
+// Walk node, its children and its siblings depth first without recursion.
+// pre(node) runs when a node is reached and returns whether to visit its
+// children. post(node) runs once its children are done and is skipped when
+// pre returned false. A sibling replaces its predecessor on the work stack,
+// so the stack grows with nesting depth and not with the length of a list.
+// Either hook may also take the TraversePosition as a second argument.
+//
+template <class Pre, class Post>
+void traverse(Node *node, Pre pre, Post post)
+{
+    std::vector<TraverseFrame> &stack = traverseStack();
+    const size_t base = stack.size();
+    TraversePosition position = {0, 0, 0};
+
+    while (true)
+    {
+        if (node != nullptr)
+        {
+            bool visitChildren;
+            if constexpr (std::is_invocable_v<Pre, Node *, const TraversePosition &>)
+            {
+                visitChildren = pre(node, position);
+            }
+            else
+            {
+                visitChildren = pre(node);
+            }
+
+            if (visitChildren)
+            {
+                stack.push_back({node, 0, position});
+                node = nullptr;
+            }
+            else
+            {
+                node = node->getSibling();
+                position.siblingIndex++;
+                continue;
+            }
+        }
+
+        // Move on to the next unvisited child, or finish the top node and move to its sibling
+        while (node == nullptr)
+        {
+            if (stack.size() == base)
+            {
+                return;
+            }
+
+            TraverseFrame &top = stack.back();
+            if (top.nextChild < top.node->getChildCount())
+            {
+                unsigned childIndex = top.nextChild++;
+                node = top.node->getChild(childIndex);
+                position = {(unsigned)(stack.size() - base), childIndex, 0};
+            }
+            else
+            {
+                TraverseFrame done = top;
+                stack.pop_back();
+                if constexpr (std::is_invocable_v<Post, Node *, const TraversePosition &>)
+                {
+                    post(done.node, done.position);
+                }
+                else
+                {
+                    post(done.node);
+                }
+                node = done.node->getSibling();
+                position = done.position;
+                position.siblingIndex++;
+            }
+        }
+    }
+}
+
+// Traversal with only a pre hook
+template <class Pre>
+void traverse(Node *node, Pre pre)
+{
+    traverse(node, pre, [](Node *) {});
+}
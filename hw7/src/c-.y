@@ -1,6 +1,15 @@
+%code requires
+{
+// The parser is pure, it takes its state and its tokens from the compilation
+class Compilation;
+}
+
 %{
 // Based on CS445 - Calculator Example Program by Robert Heckendorn and yyerror.h by Michael Wilder
 #include "TokenData.hpp"
+#include "Compilation/Batch.hpp"
+#include "Compilation/Incremental.hpp"
+#include "Compilation/Compilation.hpp"
 #include "Flags/Flags.hpp"
 #include "Semantics/Semantics.hpp"
 #include "Semantics/SymTable.hpp"
@@ -8,83 +17,30 @@
 #include "Tree/Tree.hpp"
 #include "CodeGen/CodeGen.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <stdio.h>
 
 // From yacc
-extern int yylex();
 extern int yydebug;
-extern FILE *yyin;
-
-// From c-.l scanner
-extern int lineCount;
-extern char *lastToken;
-
-// AST
-Node *root;
 
-#define YYERROR_VERBOSE
-void yyerror(const char *msg)
+void yyerror(Compilation *compilation, const char *msg)
 {
-    char *space;
-    char *strs[100];
-    int numstrs;
-
-    // Make a copy of msg string
-    space = strdup(msg);
-
-    // Split out components
-    numstrs = SyntaxError::split(space, strs, ' ');
-    if (numstrs > 4)
-    {
-        SyntaxError::trim(strs[3]);
-    }
-
-    // Translate components
-    for (int i = 3; i < numstrs; i += 2)
-    {
-        strs[i] = SyntaxError::niceTokenStr(strs[i]);
-    }
-
-    // Print components
-    if (std::string(strs[3]) != "CHARCONST")
-    {
-        SyntaxError::setHasError(true);
-        printf("ERROR(%d): Syntax error, unexpected %s", lineCount, strs[3]);
-        if (SyntaxError::elaborate(strs[3]))
-        {
-            if (lastToken[0] == '\'' || lastToken[0] == '"')
-            {
-                printf(" %s", lastToken);
-            }
-            else
-            {
-                printf(" \"%s\"", lastToken);
-            }
-        }
-
-        if (numstrs > 4)
-        {
-            printf(",");
-        }
-
-        // Print sorted list of expected
-        SyntaxError::tinySort(strs + 5, numstrs - 5, 2, true);
-        for (int i = 4; i < numstrs; i++)
-        {
-            printf(" %s", strs[i]);
-        }
-        printf(".\n");
-        fflush(stdout);
-        Emit::incErrorCount();
-    }
-    free(space);
+    compilation->setHasSyntaxError(true);
+    Emit::error(compilation->getLineCount(), SyntaxError::message(msg, compilation->getLastToken()));
 }
 
 %}
 
+%define api.pure full
+%define parse.error verbose
+%define api.push-pull both
+%param {Compilation *compilation}
+
 %union
 {
     Data::Type type;
@@ -112,12 +68,20 @@ void yyerror(const char *msg)
 
 %type <type> typeSpec
 
+%code
+{
+static int yylex(YYSTYPE *yylval, Compilation *compilation)
+{
+    return compilation->lex(yylval->tokenData);
+}
+}
+
 %%
 
 program                 : declList
                         {
                             $$ = $1;
-                            root = $$;
+                            compilation->setRoot($$);
                         }
                         ;
 
@@ -125,10 +89,12 @@ declList                : declList decl
                         {
                             $$ = $1;
                             $$->addSibling($2);
+                            compilation->declare($2);
                         }
                         | decl
                         {
                             $$ = $1;
+                            compilation->declare($1);
                         }
                         ;
 
@@ -237,13 +203,12 @@ varDeclInit             : varDeclId
 
 varDeclId               : ID
                         {
-                            $$ = new Var($1->lineNum, $1->tokenContent, new Data(Data::Type::Undefined, false, false));
+                            $$ = new Var($1->lineNum, $1->name, Data::get(Data::Type::Undefined, false, false));
                         }
                         | ID LBRACK NUMCONST RBRACK
                         {
-                            Var *var = new Var($1->lineNum, $1->tokenContent, new Data(Data::Type::Undefined, true, false));
-                            var->getData()->setArraySize(std::stoi($3->tokenContent));
-                            var->setMemSize(std::stoi($3->tokenContent) + 1);
+                            Var *var = new Var($1->lineNum, $1->name, Data::get(Data::Type::Undefined, true, false, std::stoi(std::string($3->tokenContent))));
+                            var->setMemSize(std::stoi(std::string($3->tokenContent)) + 1);
                             $$ = var;
                         }
                         | ID LBRACK error
@@ -273,13 +238,15 @@ typeSpec                : INT
 
 funDecl                 : typeSpec ID LPAREN parms RPAREN compoundStmt
                         {
-                            $$ = new Func($2->lineNum, $2->tokenContent, new Data($1, false, false));
+                            compilation->endBody();
+                            $$ = new Func($2->lineNum, $2->name, Data::get($1, false, false));
                             $$->addChild($4);
                             $$->addChild($6);
                         }
                         | ID LPAREN parms RPAREN compoundStmt
                         {
-                            $$ = new Func($1->lineNum, $1->tokenContent, new Data(Data::Type::Void, false, false));
+                            compilation->endBody();
+                            $$ = new Func($1->lineNum, $1->name, Data::get(Data::Type::Void, false, false));
                             $$->addChild($3);
                             $$->addChild($5);
                         }
@@ -297,6 +264,7 @@ funDecl                 : typeSpec ID LPAREN parms RPAREN compoundStmt
                         }
                         | ID LPAREN parms RPAREN error
                         {
+                            compilation->endBody();
                             $$ = nullptr;
                         }
                         ;
@@ -304,10 +272,12 @@ funDecl                 : typeSpec ID LPAREN parms RPAREN compoundStmt
 parms                   : parmList
                         {
                             $$ = $1;
+                            compilation->beginBody();   // Everything after the parameters belongs to the body
                         }
                         |
                         {
                             $$ = nullptr;
+                            compilation->beginBody();
                         }
                         ;
 
@@ -374,11 +344,11 @@ parmIdList              : parmIdList COMMA parmId
 
 parmId                  : ID
                         {
-                            $$ = new Parm($1->lineNum, $1->tokenContent, new Data(Data::Type::Undefined, false, false));
+                            $$ = new Parm($1->lineNum, $1->name, Data::get(Data::Type::Undefined, false, false));
                         }
                         | ID LBRACK RBRACK
                         {
-                            $$ = new Parm($1->lineNum, $1->tokenContent, new Data(Data::Type::Undefined, true, false));
+                            $$ = new Parm($1->lineNum, $1->name, Data::get(Data::Type::Undefined, true, false));
                         }
                         ;
 
@@ -563,7 +533,7 @@ iterStmtUnmatched       : WHILE simpleExp DO stmtUnmatched
                         | FOR ID ASGN iterRange DO stmtUnmatched
                         {
                             $$ = new For($1->lineNum);
-                            Var *var = new Var($2->lineNum, $2->tokenContent, new Data(Data::Type::Int, false, false));
+                            Var *var = new Var($2->lineNum, $2->name, Data::get(Data::Type::Int, false, false));
                             var->makeInitialized();
                             $$->addChild(var);
                             $$->addChild($4);
@@ -580,7 +550,7 @@ iterStmtMatched         : WHILE simpleExp DO stmtMatched
                         | FOR ID ASGN iterRange DO stmtMatched
                         {
                             $$ = new For($1->lineNum);
-                            Var *var = new Var($2->lineNum, $2->tokenContent, new Data(Data::Type::Int, false, false));
+                            Var *var = new Var($2->lineNum, $2->name, Data::get(Data::Type::Int, false, false));
                             var->makeInitialized();
                             $$->addChild(var);
                             $$->addChild($4);
@@ -907,12 +877,12 @@ factor                  : mutable
 
 mutable                 : ID
                         {
-                            $$ = new Id($1->lineNum, $1->tokenContent);
+                            $$ = new Id($1->lineNum, $1->name);
                         }
                         | ID LBRACK exp RBRACK
                         {
                             $$ = new Binary($1->lineNum, Binary::Type::Index);
-                            Id *id = new Id($1->lineNum, $1->tokenContent);
+                            Id *id = new Id($1->lineNum, $1->name);
                             $$->addChild(id);
                             $$->addChild($3);
                         }
@@ -944,7 +914,7 @@ immutable               : LPAREN exp RPAREN
 
 call                    : ID LPAREN args RPAREN
                         {
-                            $$ = new Call($1->lineNum, $1->tokenContent);
+                            $$ = new Call($1->lineNum, $1->name);
                             $$->addChild($3);
                         }
                         ;
@@ -993,7 +963,7 @@ constant                : NUMCONST
                             if (constN->getMemExists())
                             {
                                 constN->setMemSize(constN->getStringValue().length() + 1);
-                                constN->setMemScope("Global");
+                                constN->setMemScope(Node::MemScope::Global);
                             }
                             $$ = constN;
                         }
@@ -1001,59 +971,163 @@ constant                : NUMCONST
 
 %%
 
-int main(int argc, char *argv[])
+// Scan without parsing, printing every token or how fast the scanner went
+static void scan(Compilation &compilation, const bool printTokens)
 {
-    SyntaxError::initErrorProcessing();
+    auto start = std::chrono::steady_clock::now();
+    size_t tokenCount = 0;
+    TokenData *tokenData = nullptr;
+    int tokenClass;
+    while ((tokenClass = compilation.lex(tokenData)) != 0)
+    {
+        tokenCount++;
+        if (!printTokens)
+        {
+            continue;
+        }
 
+        std::cout << compilation.getLineCount() << " " << yytname[YYTRANSLATE(tokenClass)];
+        if (tokenData != nullptr && tokenData->name != Intern::None)
+        {
+            std::cout << " " << Intern::view(tokenData->name);
+        }
+        else if (tokenData != nullptr)
+        {
+            std::cout << " " << tokenData->tokenContent;
+        }
+        std::cout << std::endl;
+        tokenData = nullptr;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    if (!printTokens)
+    {
+        double seconds = std::max(elapsed.count(), 1e-9);
+        size_t byteCount = compilation.getSourceSize();
+        std::cout << "Scanned " << byteCount << " bytes (" << tokenCount << " tokens) in " << std::fixed << std::setprecision(3) << seconds << "s: ";
+        std::cout << std::setprecision(1) << byteCount / seconds / 1e6 << " MB/s" << std::defaultfloat << std::endl;
+    }
+    Emit::count();
+}
+
+int main(int argc, char *argv[])
+{
     Flags flags(argc, argv);
     yydebug = flags.getDebug();
+    Emit::Format format = flags.getJsonDiagnostics() ? Emit::Format::Json : Emit::Format::Text;
+
+    if (flags.getBatch())
+    {
+        Batch batch(flags.getThreadCount(), flags.getHandScanner());
+        batch.setFormat(format);
+        batch.setOptimize(flags.getOptimize());
+        batch.setPrintReport(flags.getOptimize() && flags.getPrintOptimizerReport());
+        batch.setLowerIR(flags.getLowerIR());
+        batch.setPrintIR(flags.getLowerIR() && flags.getPrintIR());
+        for (const std::string &path : flags.getFilepaths())
+        {
+            batch.add(path);
+        }
+        return batch.compile(std::cout) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (flags.getWatch())
+    {
+        // There is nothing to watch on stdin, and -I turns off the streaming that functions are reused from
+        Emit::setFormat(format);
+        if (flags.getFilepath().empty() || flags.getLowerIR())
+        {
+            Emit::error("ARGLIST", flags.getLowerIR() ? "-w cannot be combined with -I." : "-w needs a source file to watch.");
+            Emit::count();
+            return EXIT_FAILURE;
+        }
+        Incremental incremental(flags.getHandScanner());
+        incremental.setFormat(format);
+        incremental.setOptimize(flags.getOptimize());
+        incremental.setPrintReport(flags.getOptimize() && flags.getPrintOptimizerReport());
+        incremental.watch(flags.getFilepath(), flags.getTmFilename(), std::cout);
+    }
+
+    Compilation compilation;
+    compilation.setUseHandScanner(flags.getHandScanner());
+    compilation.setOptimize(flags.getOptimize());
+    compilation.setLowerIR(flags.getLowerIR());
+    compilation.setPrintIR(flags.getLowerIR() && flags.getPrintIR());
+    // Function bodies are only checked in parallel once the whole program is parsed
+    bool parallel = flags.getThreadCount() > 1;
+    compilation.setStreaming(!flags.getPrintSyntaxTree() && !flags.getPrintSyntaxTreeWithTypes() && !flags.getPrintSyntaxTreeWithMem() && !flags.getSymTableDebug() && !flags.getLowerIR() && !parallel);
+    compilation.getSemantics().setThreadCount(parallel ? flags.getThreadCount() : 1);
+    compilation.getSymTable().debug(flags.getSymTableDebug());
+    Emit::setBuffered(!flags.getSymTableDebug() && !flags.getPrintTokens());     // Their output is interleaved with the diagnostics
+    Emit::setFormat(format);
 
     std::string filename = flags.getFilepath();
-    if (argc > 1 && !(yyin = fopen(filename.c_str(), "r")))
+    if (!filename.empty() && !compilation.open(filename))
     {
         Emit::error("ARGLIST", "source file \"" + filename + "\" could not be opened.");
         Emit::count();
         return EXIT_FAILURE;
     }
 
-    yyparse();
-
-    if (flags.getPrintSyntaxTree() && root != nullptr && !SyntaxError::getHasError())
+    if (flags.getPrintTokens() || flags.getPrintScanSpeed())
     {
-        root->printTree(false, false);
+        scan(compilation, flags.getPrintTokens());
+        return EXIT_SUCCESS;
     }
 
-    SymTable symTable = SymTable();
-    symTable.debug(flags.getSymTableDebug());
+    compilation.parse();
 
-    Semantics analyzer = Semantics(&symTable, true);
-    if (!SyntaxError::getHasError())
+    Node *root = compilation.getRoot();
+    if (flags.getPrintSyntaxTree() && root != nullptr && !compilation.getHasSyntaxError())
     {
-        analyzer.analyze(root);
+        root->printTree(false, false);
     }
 
-    if (flags.getPrintSyntaxTreeWithTypes() && root != nullptr && !Emit::getErrorCount() && !SyntaxError::getHasError())
+    compilation.analyze();
+
+    if (flags.getPrintSyntaxTreeWithTypes() && root != nullptr && compilation.getSucceeded())
     {
         root->printTree(true, false);
     }
 
-    if (flags.getPrintSyntaxTreeWithMem() && root != nullptr && !Emit::getErrorCount() && !SyntaxError::getHasError())
+    if (flags.getPrintSyntaxTreeWithMem() && root != nullptr && compilation.getSucceeded())
     {
         root->printTree(true, true);
-        Semantics::printGoffset();
+        compilation.getSemantics().printGoffset();
     }
 
     Emit::count();
 
-    if (!Emit::getErrorCount() && !SyntaxError::getHasError())
+    if (compilation.getSucceeded())
     {
         // Use flags.getTmFilepath() for submission, flags.getTmFilename() for local
-        CodeGen *generator = new CodeGen(root, flags.getTmFilename());
-        generator->generate();
+        compilation.generate(flags.getTmFilename());
+        if (flags.getOptimize() && flags.getPrintOptimizerReport())
+        {
+            compilation.printReport();
+        }
     }
 
-    delete root;
-    fclose(yyin);
+    if (flags.getPrintArenaStats())
+    {
+        // The main arena and every body arena summed, a body arena's peak is what it held for its largest body
+        size_t allocCount = compilation.getArena().getAllocCount();
+        size_t blockCount = compilation.getArena().getBlockCount();
+        size_t byteCount = compilation.getArena().getByteCount();
+        size_t bodyPeakByteCount = 0;
+        for (const Arena &body : compilation.getBodyArenas())
+        {
+            allocCount += body.getAllocCount();
+            blockCount += body.getBlockCount();
+            byteCount += body.getByteCount();
+            bodyPeakByteCount += body.getPeakByteCount();
+        }
+        std::cout << "Arena allocations: " << allocCount << " in " << blockCount << " blocks (" << byteCount << " bytes)" << std::endl;
+        std::cout << "Body arenas: " << compilation.getBodyArenas().size() << " holding at most " << bodyPeakByteCount << " bytes" << std::endl;
+        NodePool &pool = NodePool::unit();
+        std::cout << "Distinct types: " << Data::getCount() << std::endl;
+        std::cout << "Tree nodes: " << pool.getCount() << " of " << sizeof(Node) << " bytes or more (" << pool.getByteCount() << " bytes in the pool)" << std::endl;
+    }
 
     return EXIT_SUCCESS;
 }
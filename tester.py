@@ -6,7 +6,7 @@ import time
 
 class Tester:
 
-    def __init__(self, dir, sort=False, showdiff=False, notree=False, unit=False, broad=False, difftm=False, nocomments=False):
+    def __init__(self, dir, sort=False, showdiff=False, notree=False, unit=False, broad=False, difftm=False, nocomments=False, scanners=False):
         self.sort = sort
         self.showdiff = showdiff
         self.notree = notree
@@ -14,6 +14,7 @@ class Tester:
         self.broad = broad
         self.difftm = difftm
         self.nocomments = nocomments
+        self.scanners = scanners
         self.src_dir = os.path.join(dir, 'src')
         self.test_dir = os.path.join(dir, 'test')
         if broad:
@@ -42,7 +43,9 @@ class Tester:
         for i, test in enumerate(tests):
             print(f'Running {test} {i + 1}/{len(tests)}...', end='')
             diff_count = 0
-            if self.difftm:
+            if self.scanners:
+                diff_count = self.run_scanners(test, flags=flags)
+            elif self.difftm:
                 diff_count = self.run_tm(test, flags=flags, clean=False)
             else:
                 diff_count = self.run(test, flags=flags, clean=False)
@@ -175,6 +178,35 @@ class Tester:
                 os.system(f'diff {expected} {actual}')
         return diff_count
 
+    def run_scanners(self, test, flags=''):
+        # Differential test: the hand-written scanner must produce flex's tokens and diagnostics
+        src = os.path.join(self.test_dir, test + '.c-')
+        expected = os.path.join(self.tmp_dir, test + '.flex')
+        actual = os.path.join(self.tmp_dir, test + '.hand')
+        compiler = os.path.join(self.src_dir, 'c-')
+
+        if not os.path.exists(compiler):
+            self.execute(self.src_dir, 'make')
+
+        if not os.path.exists(compiler):
+            raise Exception('Compilation failed')
+
+        os.system(f'{compiler} -t {flags} {src} > {expected}')
+        os.system(f'{compiler} -t -s {flags} {src} > {actual}')
+
+        diff = os.path.join(self.tmp_dir, test + '.diff')
+        os.system(f'diff {expected} {actual} > {diff}')
+
+        diff_count = self.count_diff(diff)
+        if not diff_count:
+            os.remove(expected)
+            os.remove(actual)
+            os.remove(diff)
+        else:
+            if self.showdiff:
+                os.system(f'diff {expected} {actual}')
+        return diff_count
+
     def remove_tmp(self):
         if os.path.exists(self.tmp_dir):
             shutil.rmtree(self.tmp_dir)
@@ -245,6 +277,7 @@ def help():
     print('--broad         Run tests in the \'BroadTests/\' directory.')
     print('--difftm        Use \'.tm\' files in diff comparison.')
     print('--nocomments    Remove comments from \'.tm\' files before diffing.')
+    print('--scanners      Diff the hand-written scanner\'s tokens against flex\'s.')
 
     print('\nCompiler Flags:')
     print('-h:    Print compiler usage message')
@@ -253,6 +286,7 @@ def help():
     print('-p:    Print the abstract syntax tree.')
     print('-P:    Print the abstract syntax tree plus type information.')
     print('-M:    Print the abstract syntax tree plus type and memory information.')
+    print('-s:    Scan with the hand-written scanner instead of flex.')
 
     print('\nFor this project:')
     print('$ python3 tester.py hw1/')
@@ -263,10 +297,11 @@ def help():
     print('$ python3 tester.py hw6/ -M --sort')
     print('$ python3 tester.py hw7/ --difftm --nocomments --unit ')
     print('$ python3 tester.py hw7/ --difftm --nocomments --broad')
+    print('$ python3 tester.py hw7/ --scanners --unit')
 
 
 if __name__ == '__main__':
-    test_flags = {'--help': False, '--sort': False, '--showdiff': False, '--notree': False, '--rmtmp': False, '--unit': False, '--broad': False, '--difftm': False, '--nocomments': False}
+    test_flags = {'--help': False, '--sort': False, '--showdiff': False, '--notree': False, '--rmtmp': False, '--unit': False, '--broad': False, '--difftm': False, '--nocomments': False, '--scanners': False}
     compiler_flags = ''
 
     argc = len(sys.argv)
@@ -290,7 +325,7 @@ if __name__ == '__main__':
     if test_flags['--unit'] and test_flags['--broad']:
         raise Exception('Run either unit or broad tests, not both')
 
-    tester = Tester(sys.argv[1], sort=test_flags['--sort'], showdiff=test_flags['--showdiff'], notree=test_flags['--notree'], unit=test_flags['--unit'], broad=test_flags['--broad'], difftm=test_flags['--difftm'], nocomments=test_flags['--nocomments'])
+    tester = Tester(sys.argv[1], sort=test_flags['--sort'], showdiff=test_flags['--showdiff'], notree=test_flags['--notree'], unit=test_flags['--unit'], broad=test_flags['--broad'], difftm=test_flags['--difftm'], nocomments=test_flags['--nocomments'], scanners=test_flags['--scanners'])
 
     passed_tests, failed_tests, diff_count = tester.run_all(compiler_flags)
     with open('test.history', 'a') as history: